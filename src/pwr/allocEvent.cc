@@ -33,6 +33,10 @@ Event* ctx_allocEvent( unsigned int type, SerialBuf& buf )
 		return new CommLogRespEvent( buf );
 	  case CommGetSamplesResp:
 		return new CommGetSamplesRespEvent( buf );
+	  case CommStatResp:
+		return new CommStatRespEvent( buf );
+	  case CommSample:
+		return new CommSampleEvent( buf );
 	}
 	return NULL;
 }
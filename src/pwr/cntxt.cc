@@ -13,6 +13,7 @@
 #include "group.h"
 #include "config.h"
 #include "deviceStat.h"
+#include "statOps.h"
 
 #include <stdlib.h>
 
@@ -165,60 +166,6 @@ void Cntxt::findAllObjType( Object* obj, PWR_ObjType type, Grp* grp )
     }
 }
 
-static double opAvg( std::vector<double>& data, int& pos )
-{
-    pos = -1;
-    double result = 0;
-    for ( unsigned i =0; i < data.size(); i++ ) {
-        DBG("%lf\n",data[i]);
-        result += data[i];
-    }
-    return result / data.size();
-}
-
-static double opMin( std::vector<double>& data, int& pos )
-{
-    double result = data[0];
-	
-    pos = 0;
-    DBG("%d %lf\n",0,data[0]);
-    for ( unsigned i =1; i < data.size(); i++ ) {
-        DBG("%d %lf\n",i,data[i]);
-        if ( data[i] < result ) {
-            pos = i;	
-            result = data[i];
-        }
-    }
-    return result;
-}
-
-static double opMax( std::vector<double>& data, int& pos )
-{
-    double result = data[0];
-	
-    pos = 0;
-    DBG("%d %lf\n",0,data[0]);
-    for ( unsigned i =1; i < data.size(); i++ ) {
-        DBG("%d %lf\n",i,data[i]);
-        if ( data[i] > result ) {
-            pos = i;	
-            result = data[i];
-        }
-    }
-    return result;
-}
-
-static Stat::OpFuncPtr getOp( std::string name ) {
-    if ( ! name.compare( "Avg" ) ) {
-        return opAvg;
-    } else if ( ! name.compare( "Min" ) ) {
-        return opMin;
-    } else if ( ! name.compare( "Max" ) ) {
-        return opMax;
-    }
-    return NULL;
-}
-
 double Cntxt::findHz( Object* obj, PWR_AttrName name )
 {
     std::string tmp = m_config->findAttrHz( obj->name(), name );
@@ -239,7 +186,7 @@ double Cntxt::findHz( Object* obj, PWR_AttrName name )
 Stat* Cntxt::createStat( Object* obj, PWR_AttrName name, PWR_AttrStat attrStat )
 {
     DBGX("\n");
-    Stat::OpFuncPtr op = getOp( attrStatToString( attrStat ) );
+    Stat::OpFuncPtr op = getStatOp( attrStat );
     if ( ! op ) {
         return NULL;
     }
@@ -251,7 +198,7 @@ Stat* Cntxt::createStat( Object* obj, PWR_AttrName name, PWR_AttrStat attrStat )
 
     Stat* stat = NULL;
     try {
-        stat = new DeviceStat( this, obj, name, op, hz );
+        stat = new DeviceStat( this, obj, name, attrStat, op, hz );
     }
     catch(int) {
     }
@@ -263,7 +210,7 @@ Stat* Cntxt::createStat( Object* obj, PWR_AttrName name, PWR_AttrStat attrStat )
 Stat* Cntxt::createStat( Grp* grp, PWR_AttrName name, PWR_AttrStat attrStat )
 {
     DBGX("\n");
-    Stat::OpFuncPtr op = getOp( attrStatToString( attrStat ) );
+    Stat::OpFuncPtr op = getStatOp( attrStat );
     if ( ! op ) {
         return NULL;
     }
@@ -282,7 +229,7 @@ Stat* Cntxt::createStat( Grp* grp, PWR_AttrName name, PWR_AttrStat attrStat )
 
     Stat* stat = NULL;
     try {
-        stat = new DeviceStat( this, grp, name, op, hz );
+        stat = new DeviceStat( this, grp, name, attrStat, op, hz );
     }
     catch(int) {
     }
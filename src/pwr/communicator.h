@@ -25,6 +25,13 @@ class CommReq {
 	  virtual void process( Event* ) = 0;
 };
 
+// what a PWR_Sub is, stopping it waits until nothing more will be pushed
+class Subscription {
+  public:
+	  virtual ~Subscription() {} 
+	  virtual void stop() = 0;
+};
+
 class Communicator {
   public:
 	Communicator() {}
@@ -35,6 +42,13 @@ class Communicator {
 	virtual void stopLog( PWR_AttrName, CommReq* req ) = 0;
 	virtual void getSamples( PWR_AttrName attr, PWR_Time start, double period, 
 				unsigned int count, CommReq* req ) = 0;
+	virtual void getStat( PWR_AttrName attr, PWR_AttrStat, 
+				PWR_AttrStat reduce, PWR_TimePeriod, double period, 
+				CommReq* req ) = 0;
+	// cond is NULL for a push every period
+	virtual void subscribe( int, PWR_AttrName [], PWR_Time period, 
+				const PWR_TriggerCond* cond, CommReq* req ) = 0;
+	virtual void unsubscribe( CommReq* req ) = 0;
 };
 
 }
@@ -58,6 +58,23 @@ class Config {
 	virtual void print( std::ostream& ) {};
 };
 
+// A python config is a module, `dir/module.py`, imported from dir, which
+// the daemon puts on PYTHONPATH before its threads start. False for any
+// other file, a .pyc too.
+inline bool pyConfigModule( const std::string& file, std::string& dir, 
+										std::string& module )
+{
+	size_t len = file.size();
+	if ( len < 3 || 0 != file.compare( len - 3, 3, ".py" ) ) {
+		return false;
+	}
+	size_t slash = file.find_last_of( '/' );
+	dir = std::string::npos == slash ? "" : file.substr( 0, slash );
+	module = file.substr( std::string::npos == slash ? 0 : slash + 1 );
+	module = module.substr( 0, module.size() - 3 );
+	return true;
+}
+
 }
 
 #endif
@@ -17,6 +17,7 @@
 
 #include <vector>
 #include <assert.h>
+#include <pthread.h>
 #include "pwrdev.h"
 #include "debug.h"
 
@@ -42,20 +43,25 @@ class Device {
       :  m_ops( ops )
     {
         DBGX("config=`%s`\n",config.c_str());
+		pthread_mutex_init( &m_lock, NULL );
         m_fd = m_ops->open( ops, config.c_str() );
 		assert( m_fd );
     }
 
     virtual ~Device() {
 		m_ops->close( m_fd );
+		pthread_mutex_destroy( &m_lock );
     }
 
 	virtual int getValues( const std::vector<PWR_AttrName>& names, void* ptr,
                     std::vector<PWR_Time>& ts, std::vector<int>& status ){
         DBGX("\n");
 		if ( m_ops->readv ) {  
-        	return m_ops->readv( m_fd, names.size(), &names[0], ptr,
+			pthread_mutex_lock( &m_lock );
+        	int rc = m_ops->readv( m_fd, names.size(), &names[0], ptr,
                             &ts[0], &status[0] );
+			pthread_mutex_unlock( &m_lock );
+			return rc;
 		} else {
             return PWR_RET_FAILURE;
 		}
@@ -65,8 +71,11 @@ class Device {
                     std::vector<int>& status ){
         DBGX("\n");
 		if ( m_ops->writev ) {  
-        	return m_ops->writev( m_fd, names.size(), &names[0], ptr,
+			pthread_mutex_lock( &m_lock );
+        	int rc = m_ops->writev( m_fd, names.size(), &names[0], ptr,
                                                             &status[0] );
+			pthread_mutex_unlock( &m_lock );
+			return rc;
 		} else {
             return PWR_RET_FAILURE;
 		}
@@ -75,18 +84,27 @@ class Device {
     virtual int getValue( PWR_AttrName name, void* ptr, size_t len,
 														PWR_Time* ts ){
         DBGX("\n");
-        return m_ops->read( m_fd, name, ptr, len, ts );
+		pthread_mutex_lock( &m_lock );
+        int rc = m_ops->read( m_fd, name, ptr, len, ts );
+		pthread_mutex_unlock( &m_lock );
+		return rc;
     }
 
     virtual int setValue( PWR_AttrName name, void* ptr, size_t len ) {
         DBGX("\n");
-        return m_ops->write( m_fd, name, ptr, len );
+		pthread_mutex_lock( &m_lock );
+        int rc = m_ops->write( m_fd, name, ptr, len );
+		pthread_mutex_unlock( &m_lock );
+		return rc;
     }
 
     virtual int startLog( PWR_AttrName name ) {
         DBGX("\n");
         if ( m_ops->log_start ) {
-            return m_ops->log_start( m_fd, name );
+			pthread_mutex_lock( &m_lock );
+            int rc = m_ops->log_start( m_fd, name );
+			pthread_mutex_unlock( &m_lock );
+			return rc;
         } else {
             return PWR_RET_FAILURE;
         }
@@ -95,7 +113,10 @@ class Device {
     virtual int stopLog( PWR_AttrName name ) {
         DBGX("\n");
         if ( m_ops->log_stop ) {
-            return m_ops->log_stop( m_fd, name );
+			pthread_mutex_lock( &m_lock );
+            int rc = m_ops->log_stop( m_fd, name );
+			pthread_mutex_unlock( &m_lock );
+			return rc;
         } else {
             return PWR_RET_FAILURE;
         }
@@ -105,7 +126,10 @@ class Device {
 						double period, unsigned int* nSamples, void* results ) {
         DBGX("\n");
         if ( m_ops->get_samples ) {
-            return m_ops->get_samples( m_fd, name, ts, period, nSamples, results );
+			pthread_mutex_lock( &m_lock );
+            int rc = m_ops->get_samples( m_fd, name, ts, period, nSamples, results );
+			pthread_mutex_unlock( &m_lock );
+			return rc;
         } else {
             return PWR_RET_FAILURE;
         }
@@ -114,6 +138,8 @@ class Device {
   private:
     plugin_devops_t*	m_ops;
     pwr_fd_t        	m_fd;	
+	// plugins aren't required to be thread safe, one call at a time
+	pthread_mutex_t		m_lock;
 };
 
 }
@@ -13,7 +13,10 @@
 #include <inttypes.h>
 
 #include <sys/time.h>
+#include <algorithm>
 #include "deviceStat.h"
+#include "statOps.h"
+#include "status.h"
 
 using namespace PowerAPI;
 
@@ -104,8 +107,7 @@ int DeviceStat::getValue( double* value, PWR_TimePeriod* statTimes ) {
 	return objGetValue( m_obj, value, statTimes );
 }
 
-int DeviceStat::objGetValue( Object* obj, double* value,
-								PWR_TimePeriod* statTimes )
+void DeviceStat::setWindow( PWR_TimePeriod* statTimes )
 {
     if ( PWR_TIME_UNINIT == statTimes->start ) {
         statTimes->start = m_startTime; 
@@ -117,7 +119,21 @@ int DeviceStat::objGetValue( Object* obj, double* value,
             statTimes->stop = m_stopTime; 
         } 
     } 
-	double windowTime = statTimes->stop - statTimes->start;	
+}
+
+int DeviceStat::objGetValue( Object* obj, double* value,
+								PWR_TimePeriod* statTimes )
+{
+	setWindow( statTimes );
+
+	// the server of a remote object reduces the window next to the
+	// samples and sends back only the result
+	if ( obj->getAttrInfo( m_attrName ).comm ) {
+		return obj->attrGetStat( m_attrName, m_attrStat, m_period,
+												value, statTimes );
+	}
+
+	double windowTime = statTimes->stop - statTimes->start;
 	windowTime /= 1000000000;
 
 	DBGX( "start=%lf stop=%lf\n", (double)statTimes->start/1000000000,
@@ -157,6 +173,17 @@ int DeviceStat::objGetValue( Object* obj, double* value,
 int DeviceStat::getValues( double value[], PWR_TimePeriod statTimes[] ) 
 {
 	DBGX("\n");
+
+	// all at once if the members are remote, over the first window
+	Status status;
+	setWindow( &statTimes[0] );
+	int retval = m_grp->attrGetStat( m_attrName, m_attrStat, 
+			PWR_ATTR_STAT_NOT_SPECIFIED, m_period, value, statTimes, 
+			NULL, &status );
+	if ( retval != PWR_RET_NOT_IMPLEMENTED ) {
+		return retval;
+	}
+
 	for ( unsigned i = 0; i < m_grp->size(); i++ ) {
 		int retval  = objGetValue( m_grp->getObj(i), &value[i], &statTimes[i] );
 		if ( retval != PWR_RET_SUCCESS ) {
@@ -166,3 +193,49 @@ int DeviceStat::getValues( double value[], PWR_TimePeriod statTimes[] )
 	return PWR_RET_SUCCESS;
 }
 
+int DeviceStat::getReduce( PWR_AttrStat reduce, int* index, double* value,
+										PWR_TimePeriod* statTimes )
+{
+	DBGX("%s\n", attrStatToString( reduce ) );
+
+	if ( m_obj ) {
+		*index = 0;
+		return getValue( value, statTimes );
+	}
+
+	StatOpFuncPtr op = getStatOp( reduce );
+	if ( ! op ) {
+		return PWR_RET_FAILURE;
+	}
+
+	// the routers reduce the members if they are remote
+	Status status;
+	setWindow( statTimes );
+	int retval = m_grp->attrGetStat( m_attrName, m_attrStat, reduce, 
+						m_period, value, statTimes, index, &status );
+	if ( retval != PWR_RET_NOT_IMPLEMENTED ) {
+		return retval;
+	}
+
+	std::vector<double> values( m_grp->size() );
+	std::vector<PWR_TimePeriod> times( m_grp->size(), *statTimes );
+	retval = getValues( &values[0], &times[0] );
+	if ( retval != PWR_RET_SUCCESS ) {
+		return retval;
+	}
+
+	int pos;
+	*value = op( values, pos );
+	*index = pos;
+	if ( pos > -1 ) {
+		*statTimes = times[pos];
+	} else {
+		*statTimes = times[0];
+		statTimes->instant = PWR_TIME_UNINIT;
+		for ( unsigned i = 1; i < times.size(); i++ ) {
+			statTimes->start = std::min( statTimes->start, times[i].start );
+			statTimes->stop = std::max( statTimes->stop, times[i].stop );
+		}
+	}
+	return PWR_RET_SUCCESS;
+}
@@ -19,11 +19,12 @@ namespace PowerAPI {
 class DeviceStat : public Stat {
   public:
 	DeviceStat( Cntxt* ctx, Object* obj, PWR_AttrName name,
-											OpFuncPtr ptr, double hz ) 
-	  : Stat( ctx, obj, name, ptr, hz ), m_isLogging(false) { }
+						PWR_AttrStat stat, OpFuncPtr ptr, double hz ) 
+	  : Stat( ctx, obj, name, stat, ptr, hz ), m_isLogging(false) { }
 
-	DeviceStat( Cntxt*ctx, Grp* grp, PWR_AttrName name, OpFuncPtr ptr, double hz ) 
-	  : Stat( ctx, grp, name, ptr, hz ), m_isLogging(false) { }
+	DeviceStat( Cntxt*ctx, Grp* grp, PWR_AttrName name, 
+						PWR_AttrStat stat, OpFuncPtr ptr, double hz ) 
+	  : Stat( ctx, grp, name, stat, ptr, hz ), m_isLogging(false) { }
 
 	virtual ~DeviceStat();
 
@@ -32,6 +33,8 @@ class DeviceStat : public Stat {
 	virtual int clear();
 	virtual int getValue( double* value, PWR_TimePeriod* statTimes );
 	virtual int getValues( double value[], PWR_TimePeriod statTimes[] );
+	virtual int getReduce( PWR_AttrStat, int* index, double* value,
+										PWR_TimePeriod* statTimes );
 
   private:
 	int startObj();
@@ -39,6 +42,7 @@ class DeviceStat : public Stat {
 	int stopObj();
 	int stopGrp();
 	int objGetValue( Object*, double* value, PWR_TimePeriod* statTimes );
+	void setWindow( PWR_TimePeriod* statTimes );
 	bool m_isLogging;
 };
 
@@ -53,7 +53,7 @@ static const char* getenv2( std::string prefix, std::string sufix )
 }
 
 DistCntxt::DistCntxt( PWR_CntxtType type, PWR_Role role, const char* name ) :
-	m_name(name)
+	m_name(name), m_deadline(0)
 {
 	DBGX("name=%s\n",name);
 	m_evChan = initEventChannel();	
@@ -66,6 +66,11 @@ DistCntxt::DistCntxt( PWR_CntxtType type, PWR_Role role, const char* name ) :
 		_DbgFlags = atoi(env);
 	}
 
+	env = getenv2( name, "POWERAPI_DEADLINE" );
+	if ( env ) {
+		m_deadline = (PWR_Time) atoi(env) * 1000000;
+	}
+
 	std::string configFile;
 
 	env = getenv2( name, "POWERAPI_CONFIG" );
@@ -78,14 +83,21 @@ DistCntxt::DistCntxt( PWR_CntxtType type, PWR_Role role, const char* name ) :
 	
     DBGX("configFile=`%s`\n",configFile.c_str());
 
+    // a bad config or root fails PWR_CntxtInit, as a missing one does,
+    // rather than exiting a process that may have other contexts
     size_t pos = configFile.find_last_of( "." );
     if ( std::string::npos == pos ) {
-        assert(0);
+		fprintf(stderr,"ERROR: config file name format error `%s`\n",
+									configFile.c_str());
+        throw -1;
     }
+#if HAVE_PYTHON
+    std::string pyDir, pyModule;
+#endif
     if ( 0 == configFile.compare(pos,4,".xml") ) {
         m_config = new XmlConfig( configFile );
 #if HAVE_PYTHON
-    } else if ( 0 == configFile.compare(pos,3,".py") ) {
+    } else if ( pyConfigModule( configFile, pyDir, pyModule ) ) {
         m_config = new PyConfig( configFile );
 #endif
 #if HAVE_HWLOC
@@ -95,7 +107,7 @@ DistCntxt::DistCntxt( PWR_CntxtType type, PWR_Role role, const char* name ) :
     } else {
 		fprintf(stderr,"ERROR: config file name format error `%s`\n",
 									configFile.c_str());
-		exit(-1);
+		throw -1;
 	}
 
 #if 0
@@ -107,20 +119,51 @@ DistCntxt::DistCntxt( PWR_CntxtType type, PWR_Role role, const char* name ) :
     env = getenv2( name, "POWERAPI_ROOT" );
     if( env  ) {
     	DBGX("root=`%s`\n", env );
-		m_rootName = env;
-        m_rootObj = findObject(env);
+		// a comma separated list, the first is the entry point
+		std::string list( env );
+		std::vector<std::string> roots;
+		while ( ! list.empty() ) {
+			size_t pos = list.find_first_of( ',' );
+			std::string root = list.substr( 0, pos );
+			list = std::string::npos == pos ? "" : list.substr( pos + 1 );
+
+			m_rootNames.insert( root );
+			roots.push_back( root );
+		}
+
+		// all of them are ours before their objects are made
+		for ( unsigned i = 0; i < roots.size(); i++ ) {
+			Object* obj = findObject( roots[i] );
+			if ( ! obj ) {
+        		printf("error: `POWERAPI_ROOT=%s` is invalid\n",env);
+        		throw -1;
+			}
+			if ( 0 == i ) {
+				m_rootObj = obj;
+			}
+		}
 		if ( ! m_rootObj ) {
         	printf("error: `POWERAPI_ROOT=%s` is invalid\n",env);
-        	exit(-1);
+        	throw -1;
 		}
     } else {
         printf("error: environment variable `POWERAPI_ROOT` must be set\n");
-        exit(-1);
+        throw -1;
     }
 }
 DistCntxt::~DistCntxt() 
 {
+	// comms tell the router they are going away, so before the channel
+	while ( ! m_commMap.empty() ) {
+		delete m_commMap.begin()->second;
+		m_commMap.erase( m_commMap.begin() );
+	}
+
 	delete m_evChan;
+	while ( ! m_cancelled.empty() ) {
+		delete *m_cancelled.begin();
+		m_cancelled.erase( m_cancelled.begin() );
+	}
 	delete m_config;
 	while ( ! m_objMap.empty() ) { 
 		delete m_objMap.begin()->second;
@@ -147,11 +190,6 @@ DistCntxt::~DistCntxt()
 	while ( ! m_pluginLibMap.empty() ) {
 		m_pluginLibMap.erase( m_pluginLibMap.begin() );
 	}
-	
-	while ( ! m_commMap.empty() ) {
-		delete m_commMap.begin()->second;
-		m_commMap.erase( m_commMap.begin() );
-	}
 }
 
 EventChannel* DistCntxt::initEventChannel()
@@ -285,7 +323,8 @@ void DistCntxt::traverse( std::string objName, PWR_AttrName attrName,
 {
 	DBGX("obj='%s' attr=`%s`\n",objName.c_str(),attrNameToString(attrName));
 
-	if ( m_config->hasServer( objName ) && objName.compare( m_rootName ) ) {
+	if ( m_config->hasServer( objName ) && 
+					m_rootNames.find( objName ) == m_rootNames.end() ) {
 		remote.insert( objName );
 		return;
 	}
@@ -404,9 +443,8 @@ int DistCntxt::makeProgress()
     EventChannel* ec = getEventChannel();
 
 	Event* ev = ec->getEvent();
-    DistCommReq* req = static_cast<DistCommReq*>((CommReq*)ev->id);
-    req->process( ev );
-	if ( req->m_req ) {
+	DistCommReq* req = dispatch( ev );
+	if ( req && req->m_req ) {
 		DBGX("\n");
 		req->m_req->execCallback();
 	}
@@ -414,3 +452,21 @@ int DistCntxt::makeProgress()
 	DBGX("\n");
 	return PWR_RET_SUCCESS;
 }
+
+DistCommReq* DistCntxt::dispatch( Event* ev )
+{
+	DistCommReq* req = static_cast<DistCommReq*>((CommReq*)ev->id);
+	if ( m_cancelled.erase( req ) ) {
+		DBGX("dropped the response for a cancelled request\n");
+		delete req;
+		return NULL;
+	}
+	req->handle( ev );
+	return req;
+}
+
+void DistCntxt::cancel( DistCommReq* req )
+{
+	req->m_req = NULL;
+	m_cancelled.insert( req );
+}
@@ -19,11 +19,13 @@
 #include "pwrdev.h"
 
 class EventChannel;
+struct Event;
 namespace PowerAPI {
 
 class Config;
 class Communicator;
 class Device;
+class DistCommReq;
 
 class DistCntxt : public Cntxt {
 
@@ -32,7 +34,15 @@ class DistCntxt : public Cntxt {
     ~DistCntxt( );
 	EventChannel* getEventChannel() { return m_evChan; }
 
+	// default deadline for new requests, POWERAPI_DEADLINE milliseconds 
+	PWR_Time getDeadline() { return m_deadline; }
+
 	int makeProgress();
+	// hands a response to its request, NULL if the request was 
+	// cancelled, the response is then dropped
+	DistCommReq* dispatch( Event* );
+	// the request is gone, its response may still come
+	void cancel( DistCommReq* );
 	AttrInfo* initAttr( Object*, PWR_AttrName );
 	virtual Object* createObject( std::string, PWR_ObjType, Cntxt* );
 
@@ -57,8 +67,11 @@ class DistCntxt : public Cntxt {
 	std::map< plugin_devops_t*, std::map< std::string, Device* > > m_deviceMap;
 
 	std::map< std::set< std::string>, Communicator* >	m_commMap;
-	std::string m_rootName;	
+	std::set< DistCommReq* >	m_cancelled;
+	// the objects we serve, with a server more than one
+	std::set< std::string > m_rootNames;
 	std::string m_name;
+	PWR_Time	m_deadline;
 };
 
 }
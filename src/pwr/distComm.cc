@@ -9,11 +9,15 @@
  * distribution.
 */
 
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdio.h>
 #include <sys/syscall.h>
 #include "util.h"
 #include "distComm.h"
 #include "distCntxt.h"
 #include "distRequest.h"
+#include "status.h"
 #include "object.h"
 #include "debug.h"
 #include "events.h"
@@ -27,10 +31,15 @@ static inline int gettid() {
 
 uint32_t DistComm::m_currentCommID = 1;
 
+CommID DistComm::newCommID()
+{
+	return ((CommID)gettid() << 32) | m_currentCommID++;
+}
+
 DistComm::DistComm( DistCntxt* cntxt ) :
 	m_ctx( cntxt), m_ec(NULL)
 {
-	m_commID = ((CommID)gettid() << 32) | m_currentCommID++;
+	m_commID = newCommID();
 }
 
 DistComm::DistComm( DistCntxt* cntxt, std::set<std::string>& objects ) :
@@ -41,7 +50,20 @@ DistComm::DistComm( DistCntxt* cntxt, std::set<std::string>& objects ) :
 		m_objects.push_back( *iter );
 	}
 	DBGX("num objects %lu\n", objects.size() );
-	m_commID = ((CommID)gettid() << 32) | m_currentCommID++;
+	m_commID = newCommID();
+	m_members.push_back( m_objects );
+}
+
+DistComm::~DistComm()
+{
+	// let the router and servers free their state, if we ever told 
+	// them about the comm
+	if ( m_ec ) {
+		CommDestroyEvent* ev = new CommDestroyEvent();
+		ev->commID = m_commID;
+		m_ec->sendEvent( ev );
+		delete ev;
+	}
 }
 
 EventChannel& DistComm::getChannel()
@@ -54,13 +76,48 @@ EventChannel& DistComm::getChannel()
 	CommCreateEvent* ev = new CommCreateEvent();
 	ev->commID = m_commID;
 
-	ev->members.push_back( m_objects );
+	ev->members = m_members;
 
 	m_ec->sendEvent( ev );
 	delete ev;
 	return *m_ec;
 }
 
+void DistComm::send( CommReq* _req, CommEvent* ev )
+{
+	DistCommReq* req = static_cast<DistCommReq*>(_req);
+	req->m_comm = this;
+	// a subscription sends its stop before its start is answered 
+	delete req->m_ev;
+	req->m_ev = ev;
+	getChannel().sendEvent( ev );
+}
+
+void DistComm::resend( DistCommReq* req )
+{
+	DBGX("commID=%" PRIx64 "\n", m_commID );
+	// Create it under a new ID, the servers may still have the destroy 
+	// for the evicted one queued behind our create. Other requests that 
+	// were bounced for the same eviction pick up the new ID.
+	if ( req->m_ev->commID == m_commID ) {
+		m_commID = newCommID();
+		m_ec = NULL;
+	}
+	req->m_ev->commID = m_commID;
+	getChannel().sendEvent( req->m_ev );
+}
+
+void DistCommReq::handle( Event* ev )
+{
+	if ( CommEvent::UnknownComm == ev->status && m_comm ) {
+		m_comm->resend( this );
+		return;
+	}
+	delete m_ev;
+	m_ev = NULL;
+	process( ev );
+}
+
 void DistComm::getValues( int count, PWR_AttrName attr[],
 										ValueOp op[], CommReq* req )
 {
@@ -76,8 +133,8 @@ void DistComm::getValues( int count, PWR_AttrName attr[],
 	// should there be a different get and set events?
 	ev->grpIndex = 0;
 	ev->id = (EventId) req;	
-	getChannel().sendEvent( ev );
-	delete ev;
+	ev->deadline = static_cast<DistCommReq*>(req)->m_req->deadline();
+	send( req, ev );
 }
 
 void DistGetCommReq::process( Event* _ev ) {
@@ -93,13 +150,13 @@ void DistComm::setValues( int count, PWR_AttrName attr[],
 	ev->commID = m_commID;
 	ev->op = CommEvent::Set;
 	ev->id = (EventId) req;	
+	ev->deadline = static_cast<DistCommReq*>(req)->m_req->deadline();
 	for ( int i = 0; i < count; i++ ) {
 		DBGX("%s\n",attrNameToString(attr[i]));
 		ev->attrName.push_back( attr[i] ); 
 		ev->setValues.push_back( ((uint64_t*)values)[i] );
 	}
-	getChannel().sendEvent( ev );
-	delete ev;
+	send( req, ev );
 }
 
 void DistSetCommReq::process( Event* _ev ) {
@@ -116,8 +173,7 @@ void DistComm::startLog( PWR_AttrName attr, CommReq* req )
 	ev->op = CommEvent::Start;
 	ev->id = (EventId) req;	
 	ev->attrName = attr; 
-	getChannel().sendEvent( ev );
-	delete ev;
+	send( req, ev );
 }
 
 void DistStartLogCommReq::process( Event* _ev ) {
@@ -144,8 +200,7 @@ void DistComm::stopLog( PWR_AttrName attr, CommReq* req )
 	ev->op = CommEvent::Stop;
 	ev->id = (EventId) req;	
 	ev->attrName = attr; 
-	getChannel().sendEvent( ev );
-	delete ev;
+	send( req, ev );
 }
 
 void DistComm::getSamples( PWR_AttrName attr, PWR_Time start,
@@ -160,6 +215,102 @@ void DistComm::getSamples( PWR_AttrName attr, PWR_Time start,
 	ev->startTime = start;
 	ev->period = period;
 	ev->count = count;
-	getChannel().sendEvent( ev );
-	delete ev;
+	send( req, ev );
+}
+
+void DistStatCommReq::process( Event* _ev ) {
+	DBGX("\n");
+	m_req->getStat( this, static_cast<CommStatRespEvent*>(_ev) );
+}
+
+void DistComm::getStat( PWR_AttrName attr, PWR_AttrStat stat,
+		PWR_AttrStat reduce, PWR_TimePeriod window, double period, 
+		CommReq* req )
+{
+	DBGX("%s %s period=%f\n",attrNameToString(attr), 
+							attrStatToString(stat), period );
+
+	CommStatReqEvent* ev = new CommStatReqEvent;	
+	ev->commID = m_commID;
+	ev->id = (EventId) req;	
+	ev->attrName = attr; 
+	ev->stat = stat;
+	ev->reduce = reduce;
+	ev->startTime = window.start;
+	ev->stopTime = window.stop;
+	ev->period = period;
+	send( req, ev );
+}
+
+void DistComm::subscribe( int count, PWR_AttrName attr[], PWR_Time period,
+							const PWR_TriggerCond* cond, CommReq* req )
+{
+	DBGX("count=%d period=%" PRIu64 "\n", count, period );
+
+	CommSubscribeEvent* ev = new CommSubscribeEvent;	
+	ev->commID = m_commID;
+	ev->op = CommEvent::Start;
+	ev->id = (EventId) req;	
+	ev->period = period;
+	if ( cond ) {
+		ev->trigger = cond->op;
+		ev->threshold = cond->threshold;
+		ev->holdTime = cond->holdTime;
+	}
+	for ( int i = 0; i < count; i++ ) {
+		ev->attrName.push_back( attr[i] ); 
+	}
+	send( req, ev );
+}
+
+void DistComm::unsubscribe( CommReq* req )
+{
+	DBGX("\n");
+
+	CommSubscribeEvent* ev = new CommSubscribeEvent;	
+	ev->commID = m_commID;
+	ev->op = CommEvent::Stop;
+	ev->id = (EventId) req;	
+	send( req, ev );
+}
+
+void DistSubCommReq::process( Event* _ev ) {
+	CommSampleEvent* ev = static_cast<CommSampleEvent*>(_ev);
+	DBGX("op=%d\n", ev->op );
+
+	if ( CommEvent::Stop == ev->op ) {
+		m_req->erase( this );
+		return;
+	}
+	if ( CommEvent::NoSource == ev->status ) {
+		m_callback( m_data, NULL, NULL );
+		return;
+	}
+	if ( ev->status || (int) ev->value.size() != m_numObjs ) {
+		return;
+	}
+
+	std::vector<uint64_t> value( m_numObjs * m_count );
+	std::vector<PWR_Time> ts( m_numObjs * m_count );
+	for ( int i = 0; i < m_numObjs; i++ ) {
+		for ( int j = 0; j < m_count; j++ ) {
+			value[ i * m_count + j ] = ev->value[i][j];
+			ts[ i * m_count + j ] = ev->timeStamp[i][j];
+		}
+	}
+	m_callback( m_data, &value[0], &ts[0] );
+}
+
+// the router acks the stop behind any push it has already sent
+void DistSubCommReq::stop()
+{
+	Status status;
+	DistRequest req( m_ctx, &status );
+	m_req = &req;
+	req.insert( this );
+	m_comm->unsubscribe( this );
+	req.wait();
+	// we are deleted with the subscription, never by the context
+	req.erase( this );
+	m_req = NULL;
 }
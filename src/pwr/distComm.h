@@ -25,10 +25,23 @@ class Object;
 class DistCntxt;
 class DistRequest;
 
+class DistComm;
+
 class DistCommReq : public CommReq {
   public:
-	DistCommReq( DistRequest* req ) : m_req( req ) {}
+	DistCommReq( DistRequest* req ) : m_req( req ), m_comm(NULL), m_ev(NULL) {}
+	~DistCommReq() { delete m_ev; }
+
+	// process the response, unless the router has forgotten our comm
+	// in which case the request is sent again
+	void handle( Event* );
+
 	DistRequest* m_req;
+
+	// where the request went and what was sent, kept until the
+	// response arrives
+	DistComm*	m_comm;
+	CommEvent*	m_ev;
 };
 
 class DistSetCommReq : public DistCommReq {
@@ -63,6 +76,33 @@ class DistGetSamplesCommReq : public DistCommReq {
 	void process( Event* ); 
 };
 
+class DistStatCommReq : public DistCommReq {
+  public:
+	DistStatCommReq( DistRequest* req ) : DistCommReq(req ) {}
+	void process( Event* ); 
+};
+
+// Lives as long as the subscription, the pushes carry it as their id
+class DistSubCommReq : public DistCommReq, public Subscription {
+  public:
+	DistSubCommReq( DistCntxt* ctx, DistComm* comm, int numObjs, int count, 
+							SubCallback callback, void* data ) :
+		DistCommReq( NULL ), m_ctx( ctx ), m_numObjs( numObjs ), 
+		m_count( count ), m_callback( callback ), m_data( data ) 
+	{
+		m_comm = comm;
+	}
+	void process( Event* ); 
+	void stop();
+
+  private:
+	DistCntxt*	m_ctx;
+	int			m_numObjs;
+	int			m_count;
+	SubCallback	m_callback;
+	void*		m_data;
+};
+
 
 class DistComm : public Communicator {
 
@@ -70,7 +110,7 @@ class DistComm : public Communicator {
 
 	DistComm( DistCntxt*, std::set<std::string>& );
 	DistComm( DistCntxt* );
-	~DistComm() {}
+	~DistComm();
 	std::vector<std::string>& getObjects() { return m_objects; }
 	virtual void getValues( int, PWR_AttrName [], ValueOp [], CommReq* req );
 	virtual void setValues( int, PWR_AttrName [], void* values, CommReq* req );
@@ -78,12 +118,26 @@ class DistComm : public Communicator {
 	virtual void stopLog( PWR_AttrName, CommReq* req );
 	virtual void getSamples( PWR_AttrName attr, PWR_Time start,
 						double period, unsigned int count, CommReq* req );
+	virtual void getStat( PWR_AttrName attr, PWR_AttrStat, 
+						PWR_AttrStat reduce, PWR_TimePeriod, double period, 
+						CommReq* req );
+	virtual void subscribe( int, PWR_AttrName [], PWR_Time period, 
+						const PWR_TriggerCond*, CommReq* req );
+	virtual void unsubscribe( CommReq* req );
+
+	// the router evicted the comm, create it again and resend
+	void resend( DistCommReq* );
 
   private:
-	EventChannel& getChannel();
+	void send( CommReq*, CommEvent* );
 	std::vector<std::string> m_objects;
 
   protected:
+	EventChannel& getChannel();
+	// sent to the router in the CommCreateEvent 
+	std::vector< std::vector< std::string > > m_members;
+
+	static CommID newCommID();
 	static uint32_t m_currentCommID;
 
 	DistCntxt*		m_ctx;
@@ -11,6 +11,11 @@
 
 using namespace PowerAPI;
 
+DistGrp::~DistGrp()
+{
+	delete m_comm;
+}
+
 Object* DistGrp::getObj( unsigned i ) {
 
     return static_cast<Object*>( m_allObjs[ i ] );
@@ -133,8 +138,65 @@ int DistGrp::attrGetValues( int num, PWR_AttrName attr[], void* buf,
 		m_comm->getValues( num, attr, &valueOp[0], commReq ); 
 
 		distReq.wait( );
+		distReq.erase( commReq );
 		delete commReq;
 	}
 	
 	return status->empty() ? PWR_RET_SUCCESS : PWR_RET_STATUS;
 }
+
+int DistGrp::attrGetStat( PWR_AttrName attr, PWR_AttrStat stat, 
+			PWR_AttrStat reduce, double period, double value[], 
+			PWR_TimePeriod statTimes[], int* index, Status* status )
+{
+    DBGX("\n");
+
+	// one request only works if every member is remote
+	if ( ! m_list.empty() || m_distObjs.empty() ) {
+		return PWR_RET_NOT_IMPLEMENTED;
+	}
+
+	DistRequest distReq( m_ctx, status );
+	if ( ! m_comm ) {
+		m_comm = new DistGrpComm( 
+				static_cast<DistCntxt*>(m_ctx), m_distObjs );
+	}
+
+	distReq.value[0] = value;
+	distReq.statTimes = statTimes;
+	distReq.statIndex = index;
+
+	DistCommReq* commReq = new DistStatCommReq(&distReq);
+	distReq.insert( commReq );
+
+	m_comm->getStat( attr, stat, reduce, statTimes[0], period, commReq ); 
+
+	distReq.wait( );
+	distReq.erase( commReq );
+	delete commReq;
+
+	return status->empty() ? PWR_RET_SUCCESS : PWR_RET_STATUS;
+}
+
+PWR_Sub DistGrp::attrSubscribe( int count, PWR_AttrName attr[], 
+					PWR_Time period, SubCallback callback, void* data )
+{
+    DBGX("\n");
+
+	// the routers only know about remote members
+	if ( ! m_list.empty() || m_distObjs.empty() || 0 == period ) {
+		return NULL;
+	}
+
+	if ( ! m_comm ) {
+		m_comm = new DistGrpComm( 
+				static_cast<DistCntxt*>(m_ctx), m_distObjs );
+	}
+
+	DistSubCommReq* sub = new DistSubCommReq( 
+				static_cast<DistCntxt*>(m_ctx), m_comm, m_distObjs.size(),
+				count, callback, data );
+	m_comm->subscribe( count, attr, period, NULL, sub );
+
+	return static_cast<Subscription*>(sub);
+}
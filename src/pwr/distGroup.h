@@ -27,6 +27,7 @@ class DistGrp : public Grp {
   public:
     DistGrp( Cntxt* ctx, const std::string name ="" ) :
 			Grp( ctx, name ), m_comm(NULL) { }
+	~DistGrp();
 
 	virtual int add( Object* obj );
 	virtual int remove( Object* obj ) { assert(0); }
@@ -40,6 +41,11 @@ class DistGrp : public Grp {
 							Status* status );
 	virtual int attrGetValues( int num, PWR_AttrName attr[], void* buf,
                                         PWR_Time ts[], Status* status);
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, PWR_AttrStat reduce,
+				double period, double value[], PWR_TimePeriod statTimes[], 
+				int* index, Status* );
+	virtual PWR_Sub attrSubscribe( int count, PWR_AttrName [], PWR_Time period,
+					SubCallback, void* data );
 	
   private:
 	std::vector< DistObject* >  m_distObjs;
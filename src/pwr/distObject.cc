@@ -13,6 +13,7 @@
 #include <inttypes.h>
 
 #include "distObject.h"
+#include "distCntxt.h"
 #include "attrInfo.h"
 #include "distRequest.h"
 #include "distComm.h"
@@ -390,3 +391,90 @@ int DistObject::attrGetSamples( PWR_AttrName attr, PWR_Time* start,
 	return retval;
 }
 
+int DistObject::attrGetStat( PWR_AttrName attr, PWR_AttrStat stat, 
+		double period, double* value, PWR_TimePeriod* statTimes, Request* req )
+{
+	DBGX("%s period=%f\n", attrNameToString(attr), period );
+	DistRequest* distReq = static_cast<DistRequest*>(req);
+
+	AttrInfo* info = m_attrInfo[ attr ];
+	if ( ! info->isValid() || ! info->comm ) {
+		return PWR_RET_FAILURE;
+	}
+
+	req->value[0] = value;
+	req->statTimes = statTimes;
+	req->statIndex = NULL;
+
+	DistCommReq* commReq = new DistStatCommReq( distReq );
+	distReq->insert( commReq );
+	info->comm->getStat( attr, stat, PWR_ATTR_STAT_NOT_SPECIFIED, 
+									*statTimes, period, commReq );
+
+	return PWR_RET_SUCCESS;
+}
+
+int DistObject::attrGetStat( PWR_AttrName attr, PWR_AttrStat stat, 
+		double period, double* value, PWR_TimePeriod* statTimes )
+{
+	int retval;
+	Status status;
+	DistRequest req( getCntxt(), &status );
+
+	DBGX("\n");
+
+	retval = attrGetStat( attr, stat, period, value, statTimes, &req ); 
+	if ( retval != PWR_RET_SUCCESS ) {
+		return retval;
+	}	
+	req.wait();
+    if ( ! status.empty() ) {
+        PWR_AttrAccessError error;
+        status.pop( &error );
+        retval = error.error;
+    }
+
+	return retval;
+}
+
+PWR_Sub DistObject::attrSubscribe( int count, PWR_AttrName attr[], 
+					PWR_Time period, SubCallback callback, void* data )
+{
+	DBGX("count=%d period=%" PRIu64 "\n", count, period );
+
+	if ( ! m_comm || 0 == period ) {
+		return NULL;
+	}
+
+	DistSubCommReq* sub = new DistSubCommReq( 
+				static_cast<DistCntxt*>(getCntxt()), m_comm, 1, count, 
+				callback, data );
+	m_comm->subscribe( count, attr, period, NULL, sub );
+
+	return static_cast<Subscription*>(sub);
+}
+
+PWR_Sub DistObject::attrTrigger( PWR_AttrName attr, PWR_TriggerCond& cond,
+					SubCallback callback, void* data )
+{
+	DBGX("op=%d threshold=%f\n", cond.op, cond.threshold );
+
+	if ( ! m_comm || 0 == cond.checkPeriod || 
+			cond.op <= PWR_TRIGGER_NONE || cond.op >= PWR_NUM_TRIGGERS ) {
+		return NULL;
+	}
+
+	// each source checks the condition on its own value, not on the sum
+	if ( m_comm->getObjects().size() > 1 ) {
+		DBGX("%zu sources, can't trigger on their sum\n", 
+								m_comm->getObjects().size() );
+		return NULL;
+	}
+
+	DistSubCommReq* sub = new DistSubCommReq( 
+				static_cast<DistCntxt*>(getCntxt()), m_comm, 1, 1, 
+				callback, data );
+	m_comm->subscribe( 1, &attr, cond.checkPeriod, &cond, sub );
+
+	return static_cast<Subscription*>(sub);
+}
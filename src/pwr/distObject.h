@@ -54,6 +54,16 @@ class DistObject : public Object {
     virtual int attrGetSamples( PWR_AttrName name, PWR_Time* start,
 					double period, unsigned int* count, void* buf, Request* );
 
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, double period,
+					double* value, PWR_TimePeriod* );
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, double period,
+					double* value, PWR_TimePeriod*, Request* );
+
+	virtual PWR_Sub attrSubscribe( int count, PWR_AttrName [], PWR_Time period,
+					SubCallback, void* data );
+	virtual PWR_Sub attrTrigger( PWR_AttrName, PWR_TriggerCond&,
+					SubCallback, void* data );
+
   private:
 	DistComm* m_comm;
 };
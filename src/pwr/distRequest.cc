@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <unistd.h> //pause()
+#include <time.h>
 
 #include "pwr.h"
 #include "status.h"
@@ -28,22 +29,49 @@
 
 using namespace PowerAPI;
 
+static PWR_Time getTime() {
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (PWR_Time) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+DistRequest::DistRequest( Cntxt* ctx, Status* status,
+			Callback callback, void* data ) :
+	Request( ctx, status, callback, data )
+{
+	m_deadline = static_cast<DistCntxt*>(ctx)->getDeadline();
+}
+
+// a request destroyed before it finished, after a timeout, leaves its 
+// outstanding parts with the context, which drops their responses
 DistRequest::~DistRequest( ) {
+	DistCntxt* ctx = static_cast<DistCntxt*>(m_cntxt);
+	std::set<DistCommReq*>::iterator iter = m_commReqs.begin();
+	for ( ; iter != m_commReqs.end(); ++iter ) {
+		ctx->cancel( *iter );
+	}
 }
 
-int DistRequest::wait( )
+int DistRequest::wait( PWR_Time timeout )
 {
 	DistCntxt* ctx = static_cast<DistCntxt*>(m_cntxt);
 	EventChannel* ec = ctx->getEventChannel();
+	PWR_Time end = timeout < 0 ? -1 : getTime() + timeout;
 
 	while ( ! m_commReqs.empty() ) {	
+		PWR_Time left = -1;
+		if ( end >= 0 ) {
+			left = end - getTime();
+			if ( left <= 0 || ! ec->ready( left ) ) {
+				return PWR_RET_TIMEOUT;
+			}
+		}
+
 		Event* ev = ec->getEvent();
 		if ( ! ev ) {
 			return PWR_RET_IPC;	
 		}
-		assert(ev);
-		CommReq* req = (CommReq*)ev->id;
-		req->process( ev );
+		ctx->dispatch( ev );
 		delete ev;
 	}
 
@@ -72,6 +100,28 @@ void DistRequest::getSamples( DistCommReq* req, CommGetSamplesRespEvent* ev  )
 	m_commReqs.erase( req ); 
 }
 
+void DistRequest::getStat( DistCommReq* req, CommStatRespEvent* ev )
+{
+	DBGX("num values %zu\n",ev->value.size());
+
+	for ( unsigned i = 0; i < ev->value.size(); i++ ) {
+		((double*)value[0])[i] = ev->value[i];
+		statTimes[i].start = ev->startTime[i];
+		statTimes[i].stop = ev->stopTime[i];
+		statTimes[i].instant = ev->instant[i];
+	}
+	if ( statIndex ) {
+		*statIndex = ev->index;
+	}
+
+	for ( unsigned i = 0; i < ev->errValue.size(); i++ ) {
+		PWR_Obj obj;
+		PWR_CntxtGetObjByName( m_cntxt, ev->errObj[i].c_str(), &obj ); 
+		m_status->add( (Object*) obj, ev->errAttr[i], ev->errValue[i] );
+	} 
+	m_commReqs.erase( req ); 
+}
+
 void DistRequest::setRetval( DistCommReq* req, CommLogRespEvent* ev )
 {
 	DBGX("\n");
@@ -19,6 +19,7 @@
 struct CommRespEvent;
 struct CommLogRespEvent;
 struct CommGetSamplesRespEvent;
+struct CommStatRespEvent;
 
 namespace PowerAPI {
 
@@ -29,12 +30,11 @@ class DistRequest : public Request {
 
   public:
 	DistRequest( Cntxt* ctx, Status* status,
-			Callback callback = NULL, void* data = NULL ) :
-		Request( ctx, status, callback, data )
-	{}
+			Callback callback = NULL, void* data = NULL );
 	~DistRequest( );
 
-	int wait( );
+	int wait( ) { return wait( -1 ); }
+	int wait( PWR_Time timeout );
 
 	bool finished() { 
 		return m_commReqs.empty();
@@ -48,12 +48,16 @@ class DistRequest : public Request {
 
 	void setRetval( DistCommReq*, CommLogRespEvent* );
 	void getSamples( DistCommReq*, CommGetSamplesRespEvent* );
+	void getStat( DistCommReq*, CommStatRespEvent* );
 
 	void getValue( DistCommReq*, CommRespEvent* );
 	void setValue( DistCommReq*, CommRespEvent* );
 	void insert( DistCommReq* req ) {
 		m_commReqs.insert( req );
 	}
+	void erase( DistCommReq* req ) {
+		m_commReqs.erase( req );
+	}
 
   protected:
 
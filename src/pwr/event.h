@@ -17,6 +17,15 @@
 
 typedef uint64_t EventId;
 
+// daemons that queue events serve the lower classes first, control 
+// operations such as power cap sets must not wait behind bulk transfers
+enum EventPriority { 
+	PriorityControl, 
+	PriorityInteractive, 
+	PriorityBulk, 
+	NumPriorities
+};
+
 class EventChannel;
 
 class EventGenerator {
@@ -43,6 +52,8 @@ struct Event : public EventBase {
         return *this;
     }
 
+	virtual EventPriority priority() { return PriorityInteractive; }
+
 	//EventType	type;
     uint32_t    type;
     EventId   	id;
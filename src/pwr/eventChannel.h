@@ -13,18 +13,29 @@
 #define _EVENT_CHANNEL_H
 
 #include <assert.h>
+#include <stdint.h>
 #include <string>
 
 struct Event;
 struct SerialBuf;
 
+// traffic through a channel, a daemon points the channels it wants to
+// account for together at the same counters
+struct ChannelStats {
+	ChannelStats() : eventsIn(0), eventsOut(0), bytesIn(0), bytesOut(0) {}
+	uint64_t eventsIn;
+	uint64_t eventsOut;
+	uint64_t bytesIn;
+	uint64_t bytesOut;
+};
+
 class EventChannel {
 
   public:
 	typedef Event* (*AllocFuncPtr)(unsigned int, SerialBuf& );
 
 	EventChannel( AllocFuncPtr func, std::string name = "" ) : 
-			m_allocFunc(func), m_name(name) {}
+			m_allocFunc(func), m_name(name), m_stats(NULL) {}
     virtual ~EventChannel() {}
 
 	virtual EventChannel* accept() { assert(0); }
@@ -32,10 +43,22 @@ class EventChannel {
 
     virtual Event* getEvent( bool blocking = true ) = 0;
     virtual bool sendEvent( Event* ) = 0;
+
+	// wait up to timeout nanoseconds, negative is forever, for an event
+	// to arrive, true if getEvent() won't block 
+	virtual bool ready( int64_t timeout ) { return true; }
 	virtual std::string& getName() { return m_name; }
+
+	// bytes written to the channel that have not yet left the host,
+	// channels that can't tell report zero 
+	virtual size_t sendQueueDepth() { return 0; }
+
+	// channels accepted from a listening channel inherit its counters
+	void setStats( ChannelStats* stats ) { m_stats = stats; }
   protected:
 	AllocFuncPtr m_allocFunc;
 	std::string m_name;
+	ChannelStats* m_stats;
 };
 
 class ChannelSelect {
@@ -47,7 +70,8 @@ class ChannelSelect {
 
     virtual bool addChannel( EventChannel*, Data* ) = 0;
     virtual bool delChannel( EventChannel* ) = 0;
-    virtual Data* wait() = 0;
+	// timeout in nanoseconds, negative is forever, NULL if it expires
+    virtual Data* wait( int64_t timeout = -1 ) = 0;
 };
 
 EventChannel* getEventChannel( const std::string& type, 
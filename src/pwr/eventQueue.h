@@ -0,0 +1,59 @@
+/* 
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work 
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _EVENT_QUEUE_H
+#define _EVENT_QUEUE_H
+
+#include <deque>
+#include "event.h"
+
+// Events a daemon has read but not yet processed, one FIFO per priority
+// class. Order is kept within a class, a higher class goes first.
+// Not thread safe, each daemon loop has its own.
+class EventQueue {
+  public:
+	struct Item {
+		Event*			ev;
+		EventChannel*	chan;
+	};
+
+	void push( Event* ev, EventChannel* chan ) {
+		Item item = { ev, chan };
+		m_queue[ ev->priority() ].push_back( item );
+	}
+
+	bool pop( Item& item ) {
+		for ( int i = 0; i < NumPriorities; i++ ) {
+			if ( ! m_queue[i].empty() ) {
+				item = m_queue[i].front();
+				m_queue[i].pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool empty() {
+		for ( int i = 0; i < NumPriorities; i++ ) {
+			if ( ! m_queue[i].empty() ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t size( EventPriority prio ) { return m_queue[prio].size(); }
+
+  private:
+	std::deque<Item>	m_queue[NumPriorities];
+};
+
+#endif
@@ -24,6 +24,13 @@
     NAME(CommGetSamplesResp) \
     NAME(ServerConnect) \
     NAME(Router2Router) \
+    NAME(RouterStatsReq) \
+    NAME(RouterStatsResp) \
+    NAME(RouteUpdate) \
+    NAME(CommStatReq) \
+    NAME(CommStatResp) \
+    NAME(CommSubscribe) \
+    NAME(CommSample) \
 
 #define GENERATE_ENUM(ENUM) ENUM,
 #define GENERATE_STRING(STRING) #STRING,
@@ -26,19 +26,63 @@ struct ServerConnectEvent : public Event {
 	ServerConnectEvent( SerialBuf& buf ) {
 		serialize_in(buf);
 	}
+	EventPriority priority() { return PriorityControl; }
 
 	ObjID name; 
+	// roots of the subtrees the server answers for
+	std::vector< ObjID > objects;
+
 	virtual void serialize_out( SerialBuf& buf ) {
 		Event::serialize_out(buf);
 		buf << name;
+		buf << objects;
 	}
 
 	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> objects;
 		buf >> name;
 		Event::serialize_in(buf);
 	}
 };
 
+// Flooded between routers when a server comes or goes. Only the server's
+// own router announces it and seq always increases, so a router applies 
+// an update if it is newer than what it has for that server. Sync asks 
+// the router at the other end of the link for everything it knows.
+struct RouteUpdateEvent : public Event {
+	enum { Add, Del, Sync };
+	RouteUpdateEvent() : Event( RouteUpdate ), op( Sync ), origin( 0 ),
+		seq( 0 ), server( 0 ) {} 
+	RouteUpdateEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+	EventPriority priority() { return PriorityControl; }
+
+	uint32_t	op;
+	uint32_t	origin;
+	uint64_t	seq;
+	uint64_t	server;
+	std::vector< ObjID > objects;
+
+	virtual void serialize_out( SerialBuf& buf ) {
+		Event::serialize_out(buf);
+		buf << op;
+		buf << origin;
+		buf << seq;
+		buf << server;
+		buf << objects;
+	}
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> objects;
+		buf >> server;
+		buf >> seq;
+		buf >> origin;
+		buf >> op;
+		Event::serialize_in(buf);
+	}
+};
+
 struct CommEvent : public Event {
 	CommEvent( EventType type ) : Event( type ), op( Noop ) {}
 	CommEvent() { } 
@@ -53,6 +97,17 @@ struct CommEvent : public Event {
 
 	enum OpType { Noop, Get, Set, Start, Stop, Clear } op;
 
+	// responses carry the op of their request so a set is expedited 
+	// in both directions
+	virtual EventPriority priority() { 
+		return Set == op ? PriorityControl : PriorityInteractive; 
+	}
+
+	// response status when the router has no record of the comm, the
+	// client creates it again and resends the request, and a push's 
+	// when a source can't publish or is gone
+	enum { UnknownComm = -1000, NoSource = -1001 };
+
 	virtual void serialize_out( SerialBuf& buf ) {
 		Event::serialize_out(buf);
 		buf << commID;
@@ -74,6 +129,9 @@ struct CommCreateEvent : public CommEvent {
 
 	CommCreateEvent(const CommCreateEvent& x) : members(x.members) {}
 
+	// ahead of the requests that use the comm
+	EventPriority priority() { return PriorityControl; }
+
     std::vector< std::vector<ObjID > > members;
 
 	virtual void serialize_in( SerialBuf& buf ) {
@@ -93,6 +151,9 @@ struct CommDestroyEvent : public CommEvent {
 		serialize_in(buf);
 	}
 
+	// behind the requests that use the comm
+	EventPriority priority() { return PriorityBulk; }
+
 	virtual void serialize_in( SerialBuf& buf ) {
 		CommEvent::serialize_in(buf);
 	} 
@@ -103,17 +164,23 @@ struct CommDestroyEvent : public CommEvent {
 };
 
 struct CommReqEvent : public CommEvent {
-	CommReqEvent( ) : CommEvent( CommReq )  { }
+	CommReqEvent( ) : CommEvent( CommReq ), grpIndex(0), memberIndex(0),
+			deadline(0) { }
 	CommReqEvent( SerialBuf& buf ) {
 		serialize_in(buf);
 	}
 
 	uint64_t grpIndex;	
+	uint64_t memberIndex;	
+	// nanoseconds the requester is willing to wait, 0 is forever
+	PWR_Time deadline;
     std::vector<PWR_AttrName> attrName;
     std::vector< uint64_t >   setValues;
 	std::vector<ValueOp> valueOp;
 
 	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> deadline;
+		buf >> memberIndex;
 		buf >> grpIndex;
 		buf >> valueOp;
 		buf >> attrName;
@@ -126,11 +193,13 @@ struct CommReqEvent : public CommEvent {
 		buf << attrName;
 		buf << valueOp;
 		buf << grpIndex;
+		buf << memberIndex;
+		buf << deadline;
 	} 
 };
 
 struct CommRespEvent : public CommEvent {
-	CommRespEvent( ) : CommEvent( CommResp )  { }
+	CommRespEvent( ) : CommEvent( CommResp ), grpIndex(0), memberIndex(0) { }
 	CommRespEvent( SerialBuf& buf ) {
 		serialize_in(buf);
 	}
@@ -138,6 +207,7 @@ struct CommRespEvent : public CommEvent {
     std::vector< std::vector<PWR_Time> > timeStamp;
     std::vector< std::vector<uint64_t> > value;
 	uint64_t grpIndex; 
+	uint64_t memberIndex; 
 
 	std::vector< ObjID >  		errObj;
 	std::vector< PWR_AttrName > errAttr;
@@ -148,6 +218,7 @@ struct CommRespEvent : public CommEvent {
 		buf >> errAttr;
 		buf >> errValue;
 
+		buf >> memberIndex;
 		buf >> grpIndex;
 		buf >> value;
 		buf >> timeStamp;
@@ -158,6 +229,7 @@ struct CommRespEvent : public CommEvent {
 		buf << timeStamp;
 		buf << value;
 		buf << grpIndex;
+		buf << memberIndex;
 
 		buf << errValue;
 		buf << errAttr;
@@ -218,6 +290,7 @@ struct CommGetSamplesReqEvent : public CommEvent {
 	CommGetSamplesReqEvent( SerialBuf& buf ) {
 		serialize_in(buf);
 	}
+	EventPriority priority() { return PriorityBulk; }
     PWR_AttrName attrName;
 	PWR_Time startTime;
 	double period;
@@ -244,6 +317,7 @@ struct CommGetSamplesRespEvent : public CommEvent {
 	CommGetSamplesRespEvent( SerialBuf& buf ) {
 		serialize_in(buf);
 	}
+	EventPriority priority() { return PriorityBulk; }
 
     CommGetSamplesRespEvent& operator=( const CommGetSamplesRespEvent& other ) {
         errObj = other.errObj;
@@ -285,5 +359,200 @@ struct CommGetSamplesRespEvent : public CommEvent {
 	} 
 };
 
+// A statistic over a window reduced by the server that has the samples,
+// only the result comes back instead of every sample in the window. For 
+// a group the router collects one result per member, or if reduce is set
+// reduces those to the one value and the index of the member it came from.
+struct CommStatReqEvent : public CommEvent {
+	CommStatReqEvent( ) : CommEvent( CommStatReq ), 
+		reduce( PWR_ATTR_STAT_NOT_SPECIFIED ), grpIndex( 0 ) { }
+	CommStatReqEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+	EventPriority priority() { return PriorityBulk; }
+	PWR_AttrName attrName;
+	PWR_AttrStat stat;
+	PWR_AttrStat reduce;
+	PWR_Time startTime;
+	PWR_Time stopTime;
+	double period;
+	uint64_t grpIndex;
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> attrName;
+		buf >> stat;
+		buf >> reduce;
+		buf >> startTime;
+		buf >> stopTime;
+		buf >> period;
+		buf >> grpIndex;
+		CommEvent::serialize_in(buf);
+	} 
+	virtual void serialize_out( SerialBuf& buf ) {
+		CommEvent::serialize_out(buf);
+		buf << grpIndex;
+		buf << period;
+		buf << stopTime;
+		buf << startTime;
+		buf << reduce;
+		buf << stat;
+		buf << attrName;
+	} 
+};
+
+struct CommStatRespEvent : public CommEvent {
+	CommStatRespEvent( ) : CommEvent( CommStatResp ), grpIndex( 0 ), 
+		index( -1 ) { }
+	CommStatRespEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+	EventPriority priority() { return PriorityBulk; }
+
+	// one per member, or just the one if the request was reduced
+	std::vector< double >	value;
+	std::vector< PWR_Time >	startTime;
+	std::vector< PWR_Time >	stopTime;
+	std::vector< PWR_Time >	instant;
+
+	uint64_t	grpIndex;
+	// the member a reduction picked, -1 if it didn't pick one
+	int32_t		index;
+
+	std::vector< ObjID >  		errObj;
+	std::vector< PWR_AttrName > errAttr;
+	std::vector< int32_t >   	errValue;
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> value;
+		buf >> startTime;
+		buf >> stopTime;
+		buf >> instant;
+		buf >> grpIndex;
+		buf >> index;
+		buf >> errValue;
+		buf >> errAttr;
+		buf >> errObj;
+		CommEvent::serialize_in(buf);
+	} 
+	virtual void serialize_out( SerialBuf& buf ) {
+		CommEvent::serialize_out(buf);
+		buf << errObj;
+		buf << errAttr;
+		buf << errValue;
+		buf << index;
+		buf << grpIndex;
+		buf << instant;
+		buf << stopTime;
+		buf << startTime;
+		buf << value;
+	} 
+};
+
+// Start asks for the attributes to be pushed every period until a Stop 
+// with the same id. The servers push to the router, which sums the 
+// sources of each member and forwards one sample for the comm once all
+// of them have pushed.
+struct CommSubscribeEvent : public CommEvent {
+	CommSubscribeEvent( ) : CommEvent( CommSubscribe ), period( 0 ),
+			grpIndex( 0 ), memberIndex( 0 ), trigger( PWR_TRIGGER_NONE ),
+			threshold( 0 ), holdTime( 0 ) { }
+	CommSubscribeEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+	EventPriority priority() { return PriorityControl; }
+
+    std::vector<PWR_AttrName> attrName;
+	// nanoseconds
+	PWR_Time period;
+	uint64_t grpIndex;	
+	uint64_t memberIndex;	
+	// push only when the condition fires, see PWR_TriggerCond 
+	uint32_t trigger;
+	double threshold;
+	PWR_Time holdTime;
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> holdTime;
+		buf >> threshold;
+		buf >> trigger;
+		buf >> memberIndex;
+		buf >> grpIndex;
+		buf >> period;
+		buf >> attrName;
+		CommEvent::serialize_in(buf);
+	} 
+	virtual void serialize_out( SerialBuf& buf ) {
+		CommEvent::serialize_out(buf);
+		buf << attrName;
+		buf << period;
+		buf << grpIndex;
+		buf << memberIndex;
+		buf << trigger;
+		buf << threshold;
+		buf << holdTime;
+	} 
+};
+
+// a push for a subscription, a Stop acknowledges the end of one
+struct CommSampleEvent : public CommEvent {
+	CommSampleEvent( ) : CommEvent( CommSample ), grpIndex( 0 ),
+			memberIndex( 0 ) { op = Start; }
+	CommSampleEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+	EventPriority priority() { return PriorityBulk; }
+
+	// a source pushes one, the router one per member
+    std::vector< std::vector<PWR_Time> > timeStamp;
+    std::vector< std::vector<uint64_t> > value;
+	uint64_t grpIndex; 
+	uint64_t memberIndex; 
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> memberIndex;
+		buf >> grpIndex;
+		buf >> value;
+		buf >> timeStamp;
+		CommEvent::serialize_in(buf);
+	} 
+	virtual void serialize_out( SerialBuf& buf ) {
+		CommEvent::serialize_out(buf);
+		buf << timeStamp;
+		buf << value;
+		buf << grpIndex;
+		buf << memberIndex;
+	} 
+};
+
+struct RouterStatsReqEvent : public Event {
+	RouterStatsReqEvent() : Event( RouterStatsReq ) {} 
+	RouterStatsReqEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+};
+
+// counters as name/value pairs so new ones don't change the wire format 
+struct RouterStatsRespEvent : public Event {
+	RouterStatsRespEvent() : Event( RouterStatsResp ) {} 
+	RouterStatsRespEvent( SerialBuf& buf ) {
+		serialize_in(buf);
+	}
+
+	std::vector< std::string >	name;
+	std::vector< uint64_t >		value;
+
+	virtual void serialize_out( SerialBuf& buf ) {
+		Event::serialize_out(buf);
+		buf << name;
+		buf << value;
+	}
+
+	virtual void serialize_in( SerialBuf& buf ) {
+		buf >> value;
+		buf >> name;
+		Event::serialize_in(buf);
+	}
+};
+
 #endif
 
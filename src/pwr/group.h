@@ -92,6 +92,23 @@ class Grp {
         return !status->empty() ? PWR_RET_FAILURE : PWR_RET_SUCCESS;
     }
 
+	// statistics of the members computed by their servers over the window
+	// in statTimes[0], one per member or if reduce is set the one value
+	// and index of the member it came from 
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, PWR_AttrStat reduce,
+				double period, double value[], PWR_TimePeriod statTimes[], 
+				int* index, Status* ) 
+	{
+		return PWR_RET_NOT_IMPLEMENTED;
+	}
+
+	// the servers push the values of every member each period, laid out
+	// as for attrGetValues
+	virtual PWR_Sub attrSubscribe( int count, PWR_AttrName [], PWR_Time period,
+					SubCallback, void* data ) {
+		return NULL;
+	}
+
     int remove( Object* obj ) {
         std::vector<Object*>::iterator iter = m_list.begin();
         for ( ; iter != m_list.end(); ++iter ) {
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+#include "localEnergy.h"
+#include "debug.h"
+
+using namespace PowerAPI;
+
+#define MSR_RAPL_POWER_UNIT		0x606
+#define MSR_PKG_ENERGY_STATUS	0x611
+
+static LocalEnergy* _local = NULL;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+LocalEnergy* LocalEnergy::get()
+{
+	pthread_once( &_once, create );
+	return _local;
+}
+
+void LocalEnergy::create()
+{
+	LocalEnergy* local = new LocalEnergy;
+	if ( local->initMsr() || local->initPowercap() ) {
+		DBG("%s packages=%d\n", local->m_msr ? "msr" : "powercap", 
+												local->numPkgs() );
+		_local = local;
+	} else {
+		delete local;
+	}
+}
+
+LocalEnergy::LocalEnergy() : m_msr( false ), m_unit( 0 ), m_range( 0 )
+{
+	int numCpus = sysconf( _SC_NPROCESSORS_CONF );
+	for ( int cpu = 0; cpu < numCpus; cpu++ ) {
+		char path[100];
+		snprintf( path, sizeof(path), 
+			"/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu );
+		int id = -1;
+		FILE* fp = fopen( path, "r" );
+		if ( fp ) {
+			if ( 1 != fscanf( fp, "%d", &id ) ) {
+				id = -1;
+			}
+			fclose( fp );
+		}
+		m_cpuPkg.push_back( id );
+		m_cpuFd.push_back( -1 );
+	}
+}
+
+LocalEnergy::~LocalEnergy()
+{
+	for ( unsigned i = 0; i < m_cpuFd.size(); i++ ) {
+		if ( m_cpuFd[i] > -1 ) {
+			close( m_cpuFd[i] );
+		}
+	}
+	for ( unsigned i = 0; ! m_msr && i < m_pkgs.size(); i++ ) {
+		close( m_pkgs[i].fd );
+	}
+}
+
+// every cpu's MSR is opened so a read is on the cpu we are on
+bool LocalEnergy::initMsr()
+{
+	std::map<int,int> index;
+	for ( unsigned cpu = 0; cpu < m_cpuPkg.size(); cpu++ ) {
+		char path[100];
+		snprintf( path, sizeof(path), "/dev/cpu/%d/msr", cpu );
+		int fd = open( path, O_RDONLY );
+		if ( fd < 0 || m_cpuPkg[cpu] < 0 ) {
+			if ( fd > -1 ) {
+				close( fd );
+			}
+			continue;
+		}
+		m_cpuFd[cpu] = fd;
+
+		if ( index.find( m_cpuPkg[cpu] ) == index.end() ) {
+			index[ m_cpuPkg[cpu] ] = m_pkgs.size();
+			Pkg pkg = { fd };
+			m_pkgs.push_back( pkg );
+		}
+		m_cpuPkg[cpu] = index[ m_cpuPkg[cpu] ];
+	}
+	if ( m_pkgs.empty() ) {
+		return false;
+	}
+
+	uint64_t units;
+	if ( sizeof(units) != pread( m_pkgs[0].fd, &units, sizeof(units), 
+										MSR_RAPL_POWER_UNIT ) ) {
+		for ( unsigned i = 0; i < m_cpuFd.size(); i++ ) {
+			if ( m_cpuFd[i] > -1 ) {
+				close( m_cpuFd[i] );
+				m_cpuFd[i] = -1;
+			}
+		}
+		m_pkgs.clear();
+		return false;
+	}
+	m_unit = 1.0 / ( 1 << ( ( units >> 8 ) & 0x1f ) );
+	m_range = (uint64_t) 1 << 32;
+	m_msr = true;
+	return true;
+}
+
+// a file per package, intel-rapl:N named package-P
+bool LocalEnergy::initPowercap()
+{
+	std::map<int,int> index;
+	for ( int n = 0; ; n++ ) {
+		char path[100];
+		snprintf( path, sizeof(path), "/sys/class/powercap/intel-rapl:%d", n );
+		std::string dir( path );
+
+		FILE* fp = fopen( ( dir + "/name" ).c_str(), "r" );
+		if ( ! fp ) {
+			break;
+		}
+		int id = -1;
+		if ( 1 != fscanf( fp, "package-%d", &id ) ) {
+			id = -1;
+		}
+		fclose( fp );
+
+		uint64_t range = 0;
+		fp = fopen( ( dir + "/max_energy_range_uj" ).c_str(), "r" );
+		if ( fp ) {
+			if ( 1 != fscanf( fp, "%lu", &range ) ) {
+				range = 0;
+			}
+			fclose( fp );
+		}
+
+		int fd = open( ( dir + "/energy_uj" ).c_str(), O_RDONLY );
+		if ( id < 0 || 0 == range || fd < 0 ) {
+			if ( fd > -1 ) {
+				close( fd );
+			}
+			continue;
+		}
+		index[ id ] = m_pkgs.size();
+		Pkg pkg = { fd };
+		m_pkgs.push_back( pkg );
+		m_range = range + 1;
+	}
+	if ( m_pkgs.empty() ) {
+		return false;
+	}
+
+	for ( unsigned cpu = 0; cpu < m_cpuPkg.size(); cpu++ ) {
+		std::map<int,int>::iterator iter = index.find( m_cpuPkg[cpu] );
+		m_cpuPkg[cpu] = iter == index.end() ? -1 : iter->second;
+	}
+	m_unit = 1e-6;
+	return true;
+}
+
+bool LocalEnergy::readFd( int fd, uint64_t& value )
+{
+	if ( m_msr ) {
+		if ( sizeof(value) != pread( fd, &value, sizeof(value), 
+										MSR_PKG_ENERGY_STATUS ) ) {
+			return false;
+		}
+		value &= 0xffffffff;
+		return true;
+	}
+
+	char buf[32];
+	ssize_t len = pread( fd, buf, sizeof(buf) - 1, 0 );
+	if ( len <= 0 ) {
+		return false;
+	}
+	buf[len] = 0;
+	value = strtoull( buf, NULL, 10 );
+	return true;
+}
+
+bool LocalEnergy::read( Sample& sample )
+{
+	int cpu = sched_getcpu();
+	if ( cpu < 0 || cpu >= (int) m_cpuPkg.size() || m_cpuPkg[cpu] < 0 ) {
+		return false;
+	}
+	sample.pkg = m_cpuPkg[cpu];
+	int fd = m_msr ? m_cpuFd[cpu] : m_pkgs[ sample.pkg ].fd;
+	return readFd( fd, sample.raw );
+}
+
+bool LocalEnergy::read( int pkg, Sample& sample )
+{
+	if ( pkg < 0 || pkg >= (int) m_pkgs.size() ) {
+		return false;
+	}
+	sample.pkg = pkg;
+	return readFd( m_pkgs[pkg].fd, sample.raw );
+}
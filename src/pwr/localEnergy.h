@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _PWR_LOCAL_ENERGY_H
+#define _PWR_LOCAL_ENERGY_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace PowerAPI {
+
+// Reads the energy counter of the package the calling thread runs on,
+// straight from the RAPL MSR of its own cpu if /dev/cpu/N/msr can be
+// read, else from powercap's energy_uj, with no device, context or
+// daemon in between. A read is a pread on a descriptor opened up front,
+// so it is cheap enough to bracket short regions and single calls.
+class LocalEnergy {
+  public:
+	struct Sample {
+		int			pkg;
+		uint64_t	raw;
+	};
+
+	// NULL if neither is readable
+	static LocalEnergy* get();
+
+	// the package of the calling cpu
+	bool read( Sample& );
+	// a package we may not be on, the MSR is read on one of its cpus
+	bool read( int pkg, Sample& );
+	int numPkgs() { return m_pkgs.size(); }
+
+	// joules between two samples of the same package, the counter wraps
+	double joules( const Sample& start, const Sample& stop ) {
+		uint64_t diff = stop.raw >= start.raw ? stop.raw - start.raw :
+									m_range - start.raw + stop.raw;
+		return diff * m_unit;
+	}
+
+  private:
+	static void create();
+	LocalEnergy();
+	~LocalEnergy();
+	bool initMsr();
+	bool initPowercap();
+	bool readFd( int fd, uint64_t& );
+
+	struct Pkg {
+		int		fd;	// the powercap file or a cpu's MSR
+	};
+
+	bool				m_msr;
+	double				m_unit;
+	uint64_t			m_range;
+	std::vector<Pkg>	m_pkgs;
+	// by cpu, the package and the MSR
+	std::vector<int>	m_cpuPkg;
+	std::vector<int>	m_cpuFd;
+};
+
+}
+
+#endif
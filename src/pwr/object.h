@@ -86,6 +86,27 @@ class Object {
 		assert(0);
 	}
 
+	// a statistic reduced where the samples are, only remote objects can
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, double period,
+					double* value, PWR_TimePeriod* ) {
+		return PWR_RET_NOT_IMPLEMENTED;
+	}
+	virtual int attrGetStat( PWR_AttrName, PWR_AttrStat, double period,
+					double* value, PWR_TimePeriod*, Request* ) {
+		assert(0);
+	}
+
+	// the servers push the values every period, only remote objects can
+	virtual PWR_Sub attrSubscribe( int count, PWR_AttrName [], PWR_Time period,
+					SubCallback, void* data ) {
+		return NULL;
+	}
+	// pushed only when the condition fires, evaluated by the server
+	virtual PWR_Sub attrTrigger( PWR_AttrName, PWR_TriggerCond&,
+					SubCallback, void* data ) {
+		return NULL;
+	}
+
   protected:
 
 	int attrGetValuesDevice( AttrInfo&, PWR_AttrName, void* buf, PWR_Time* );
@@ -23,6 +23,8 @@
 #include "status.h"
 #include "object.h"
 #include "stat.h"
+#include "communicator.h"
+#include "region.h"
 
 using namespace PowerAPI;
 
@@ -358,9 +360,80 @@ int PWR_StatGetValues( PWR_Stat stat, double values[],
 	return STAT(stat)->getValues( values, statTimes );
 }
 
-int PWR_StatGetReduce( PWR_Stat, PWR_AttrStat, int* index, double* val, PWR_TimePeriod* )
+int PWR_StatGetReduce( PWR_Stat stat, PWR_AttrStat reduceOp, int* index, 
+									double* val, PWR_TimePeriod* statTimes )
 {
-	return PWR_RET_NOT_IMPLEMENTED;
+	return STAT(stat)->getReduce( reduceOp, index, val, statTimes );
+}
+
+int PWR_ObjGetStat( PWR_Obj obj, PWR_AttrName name, PWR_AttrStat statOp,
+						PWR_TimePeriod* statTimes, double* val )
+{
+	Stat* stat = OBJECT(obj)->getCntxt()->createStat(OBJECT(obj),name,statOp);
+	if ( ! stat ) {
+		return PWR_RET_FAILURE;
+	}
+	int retval = stat->getValue( val, statTimes );
+	stat->getCtx()->destroyStat( stat );
+	return retval;
+}
+
+int PWR_GrpGetStats( PWR_Grp grp, PWR_AttrName name, PWR_AttrStat statOp,
+		PWR_TimePeriod* window, double vals[], PWR_TimePeriod statTimes[] )
+{
+	Stat* stat = GRP(grp)->getCntxt()->createStat(GRP(grp),name,statOp);
+	if ( ! stat ) {
+		return PWR_RET_FAILURE;
+	}
+	for ( unsigned i = 0; i < GRP(grp)->size(); i++ ) {
+		statTimes[i] = *window;
+	}
+	int retval = stat->getValues( vals, statTimes );
+	stat->getCtx()->destroyStat( stat );
+	return retval;
+}
+
+int PWR_GrpGetReduce( PWR_Grp grp, PWR_AttrName name, PWR_AttrStat statOp,
+		PWR_AttrStat reduceOp, PWR_TimePeriod window, int* index, double* val,
+		PWR_TimePeriod* statTimes )
+{
+	Stat* stat = GRP(grp)->getCntxt()->createStat(GRP(grp),name,statOp);
+	if ( ! stat ) {
+		return PWR_RET_FAILURE;
+	}
+	*statTimes = window;
+	int retval = stat->getReduce( reduceOp, index, val, statTimes );
+	stat->getCtx()->destroyStat( stat );
+	return retval;
+}
+
+PWR_Sub PWR_ObjAttrSubscribe( PWR_Obj obj, int count, PWR_AttrName names[],
+					PWR_Time period, SubCallback callback, void* data )
+{
+	return OBJECT(obj)->attrSubscribe( count, names, period, callback, data );
+}
+
+PWR_Sub PWR_GrpAttrSubscribe( PWR_Grp grp, int count, PWR_AttrName names[],
+					PWR_Time period, SubCallback callback, void* data )
+{
+	return GRP(grp)->attrSubscribe( count, names, period, callback, data );
+}
+
+PWR_Sub PWR_ObjAttrTrigger( PWR_Obj obj, PWR_AttrName name, 
+		PWR_TriggerCond* cond, SubCallback callback, void* data )
+{
+	if ( ! cond ) {
+		return NULL;
+	}
+	return OBJECT(obj)->attrTrigger( name, *cond, callback, data );
+}
+
+int PWR_SubDestroy( PWR_Sub sub )
+{
+	Subscription* ptr = (Subscription*) sub;
+	ptr->stop();
+	delete ptr;
+	return PWR_RET_SUCCESS;
 }
 
 int PWR_GetMajorVersion( )
@@ -388,6 +461,17 @@ int PWR_ReqWait( PWR_Request req )
     return static_cast<Request*>(req)->wait( );
 }
 
+int PWR_ReqWaitTimeout( PWR_Request req, PWR_Time timeout )
+{
+    return static_cast<Request*>(req)->wait( timeout );
+}
+
+int PWR_ReqSetDeadline( PWR_Request req, PWR_Time deadline )
+{
+    static_cast<Request*>(req)->setDeadline( deadline );
+	return PWR_RET_SUCCESS;
+}
+
 PWR_Request PWR_ReqCreate( PWR_Cntxt ctx, PWR_Status status )
 {
     return new DistRequest( static_cast<Cntxt*>(ctx), STATUS(status) );
@@ -463,3 +547,24 @@ int PWR_TimeConvert( PWR_Time in, time_t* out )
    *out = in / 1000000000;
     return PWR_RET_SUCCESS;
 }
+
+int PWR_RegionBegin( const char* name )
+{
+	return Regions::get()->begin( name );
+}
+
+int PWR_RegionEnd( const char* name )
+{
+	return Regions::get()->end( name );
+}
+
+// the report of a region of this process, the context isn't needed
+int PWR_GetReportByID( PWR_Cntxt ctx, const char* id, PWR_ID type,
+		PWR_AttrName name, PWR_AttrStat stat, double* value,
+		PWR_TimePeriod* period )
+{
+	if ( type != PWR_ID_RUN && type != PWR_ID_NOT_SPECIFIED ) {
+		return PWR_RET_NOT_IMPLEMENTED;
+	}
+	return Regions::get()->report( id, name, stat, value, period );
+}
@@ -159,12 +159,31 @@ PWR_Request PWR_ReqCreateCallback( PWR_Cntxt, PWR_Status, Callback callback,
 int PWR_ReqDestroy( PWR_Request );
 
 int PWR_ReqWait( PWR_Request );
+int PWR_ReqWaitTimeout( PWR_Request, PWR_Time timeout );
+int PWR_ReqSetDeadline( PWR_Request, PWR_Time deadline );
 
 int PWR_ObjAttrGetValues_NB( PWR_Obj, int count, PWR_AttrName name[],
 								void* buf, PWR_Time [], PWR_Request );
 
 int PWR_ObjAttrSetValues_NB( PWR_Obj, int count, PWR_AttrName name[],
 								void* buf, PWR_Request );
+
+/* the servers push the attributes every period, in nanoseconds, the
+ * callback is run from PWR_CntxtMakeProgress or while waiting on a request,
+ * with NULL values if the subscription has no server left to push it
+ */
+PWR_Sub PWR_ObjAttrSubscribe( PWR_Obj, int count, PWR_AttrName name[],
+						PWR_Time period, SubCallback, void* data );
+PWR_Sub PWR_GrpAttrSubscribe( PWR_Grp, int count, PWR_AttrName name[],
+						PWR_Time period, SubCallback, void* data );
+
+/* the server evaluates the condition against the attribute and pushes
+ * the value only when it fires, destroyed with PWR_SubDestroy, NULL for
+ * an object whose value is the sum of more than one server's
+ */
+PWR_Sub PWR_ObjAttrTrigger( PWR_Obj, PWR_AttrName, PWR_TriggerCond*,
+						SubCallback, void* data );
+int PWR_SubDestroy( PWR_Sub );
 /*
 *  Utility Functions
 */
@@ -179,6 +198,13 @@ int PWR_ObjAttrStopLog( PWR_Obj, PWR_AttrName name );
 int PWR_ObjAttrGetSamples( PWR_Obj, PWR_AttrName name, PWR_Time* start,
 				double period, unsigned int count, void* buf );
 
+/* a region of the calling thread, regions nest and the one ended must be
+ * the last begun, the energy of the package the thread runs on is read
+ * locally at both ends, query a region by name with PWR_GetReportByID
+ */
+int PWR_RegionBegin( const char* name );
+int PWR_RegionEnd( const char* name );
+
 int PWR_ObjAttrStartLog_NB( PWR_Obj, PWR_AttrName name, PWR_Request );
 int PWR_ObjAttrStopLog_NB( PWR_Obj, PWR_AttrName name, PWR_Request );
 int PWR_ObjAttrGetSamples_NB( PWR_Obj, PWR_AttrName name, PWR_Time* start,
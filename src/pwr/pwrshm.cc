@@ -0,0 +1,150 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pwrshm.h"
+
+// libpwrshm stands alone, a reader needs neither libpwr nor a context
+struct PWR_ShmTable {
+	void*			base;
+	size_t			len;
+	PWR_ShmHeader*	header;
+	PWR_ShmEntry*	entries;
+};
+
+// a reader spins this many times on an entry before it yields, and yields
+// this many times before it gives up on the writer
+#define SPINS	1024
+#define YIELDS	1000
+
+static int writerAlive( PWR_ShmTable* table )
+{
+	return 0 == kill( table->header->pid, 0 ) || EPERM == errno;
+}
+
+PWR_ShmTable* PWR_ShmOpen( const char* name )
+{
+	int fd = shm_open( name, O_RDONLY, 0 );
+	if ( fd < 0 ) {
+		return NULL;
+	}
+	struct stat st;
+	if ( fstat( fd, &st ) || (size_t) st.st_size < sizeof(PWR_ShmHeader) ) {
+		close( fd );
+		return NULL;
+	}
+	void* base = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( MAP_FAILED == base ) {
+		return NULL;
+	}
+
+	PWR_ShmHeader* header = (PWR_ShmHeader*) base;
+	__sync_synchronize();
+	if ( header->magic != PWR_SHM_MAGIC || 
+			header->version != PWR_SHM_VERSION ||
+			header->entrySize != sizeof(PWR_ShmEntry) ||
+			sizeof(PWR_ShmHeader) + (size_t) header->numEntries *
+					sizeof(PWR_ShmEntry) > (size_t) st.st_size ) {
+		munmap( base, st.st_size );
+		return NULL;
+	}
+
+	PWR_ShmTable* table = (PWR_ShmTable*) malloc( sizeof(PWR_ShmTable) );
+	table->base = base;
+	table->len = st.st_size;
+	table->header = header;
+	table->entries = (PWR_ShmEntry*) ( header + 1 );
+	return table;
+}
+
+void PWR_ShmClose( PWR_ShmTable* table )
+{
+	munmap( table->base, table->len );
+	free( table );
+}
+
+int PWR_ShmGetNumEntries( PWR_ShmTable* table )
+{
+	return table->header->numEntries;
+}
+
+int PWR_ShmFind( PWR_ShmTable* table, const char* obj, PWR_AttrName attr )
+{
+	for ( unsigned i = 0; i < table->header->numEntries; i++ ) {
+		PWR_ShmEntry* entry = &table->entries[i];
+		if ( entry->attr == attr && 
+				0 == strncmp( entry->obj, obj, PWR_SHM_NAME_LEN ) ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int PWR_ShmGetEntryInfo( PWR_ShmTable* table, int index, const char** obj,
+												PWR_AttrName* attr )
+{
+	if ( index < 0 || (unsigned) index >= table->header->numEntries ) {
+		return PWR_RET_BAD_INDEX;
+	}
+	*obj = table->entries[index].obj;
+	*attr = (PWR_AttrName) table->entries[index].attr;
+	return PWR_RET_SUCCESS;
+}
+
+int PWR_ShmRead( PWR_ShmTable* table, int index, void* value, PWR_Time* ts )
+{
+	if ( index < 0 || (unsigned) index >= table->header->numEntries ) {
+		return PWR_RET_BAD_INDEX;
+	}
+	PWR_ShmEntry* entry = &table->entries[index];
+
+	uint64_t val;
+	PWR_Time time;
+	uint32_t seq;
+	for ( unsigned spin = 1; ; spin++ ) {
+		seq = entry->seq;
+		if ( ! ( seq & 1 ) ) {
+			__sync_synchronize();
+			val = entry->value;
+			time = entry->ts;
+			__sync_synchronize();
+			if ( seq == entry->seq ) {
+				break;
+			}
+		}
+		// the writer was preempted mid write, or died there
+		if ( 0 == spin % SPINS ) {
+			if ( spin == SPINS * YIELDS || ! writerAlive( table ) ) {
+				return PWR_RET_FAILURE;
+			}
+			sched_yield();
+		}
+	}
+
+	if ( 0 == time ) {
+		return PWR_RET_EMPTY;
+	}
+	memcpy( value, &val, sizeof(val) );
+	if ( ts ) {
+		*ts = time;
+	}
+	return PWR_RET_SUCCESS;
+}
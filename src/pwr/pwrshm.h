@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _PWR_SHM_H
+#define _PWR_SHM_H
+
+#include <stdint.h>
+
+#include "pwrtypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The newest samples of a server, published in a POSIX shared memory
+ * segment, --srvr.shm=<name>, that any process on the node can map read
+ * only. The table is fixed once the server has started, an entry per
+ * object and attribute the server samples. An entry is written under a
+ * sequence count that is odd while it changes, a reader retries until it
+ * sees the same even count before and after its copy, so a read takes no
+ * lock, no system call and no message to the daemon.
+ */
+
+#define PWR_SHM_MAGIC	0x50575253	/* PWRS */
+#define PWR_SHM_VERSION	1
+#define PWR_SHM_NAME_LEN	80
+
+typedef struct {
+	uint32_t	magic;		/* set last, once the entries are filled in */
+	uint32_t	version;
+	uint32_t	numEntries;
+	uint32_t	entrySize;
+	PWR_Time	period;		/* nanoseconds between samples */
+	int32_t		pid;		/* of the server */
+	uint32_t	pad[9];
+} PWR_ShmHeader;
+
+/* a cache line each, so a writer doesn't disturb readers of its neighbors */
+typedef struct {
+	volatile uint32_t	seq;
+	int32_t				attr;	/* PWR_AttrName */
+	uint64_t			value;	/* the attribute's type, a double or uint64_t */
+	PWR_Time			ts;		/* the device's time, 0 until sampled */
+	PWR_Time			taken;	/* the server's clock */
+	char				obj[PWR_SHM_NAME_LEN];
+	uint32_t			pad[4];
+} PWR_ShmEntry;
+
+typedef struct PWR_ShmTable PWR_ShmTable;
+
+/* maps the table of a running server, NULL if there isn't one */
+PWR_ShmTable* PWR_ShmOpen( const char* name );
+void PWR_ShmClose( PWR_ShmTable* );
+
+int PWR_ShmGetNumEntries( PWR_ShmTable* );
+/* the index of an object's attribute, -1 if it isn't published */
+int PWR_ShmFind( PWR_ShmTable*, const char* obj, PWR_AttrName );
+int PWR_ShmGetEntryInfo( PWR_ShmTable*, int index, const char** obj,
+							PWR_AttrName* );
+
+/* the newest value, 8 bytes, and its time, PWR_RET_EMPTY if the entry
+ * hasn't been sampled yet, PWR_RET_FAILURE if it stays half written, its
+ * server died or stalled while writing it
+ */
+int PWR_ShmRead( PWR_ShmTable*, int index, void* value, PWR_Time* ts );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
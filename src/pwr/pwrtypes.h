@@ -251,6 +251,7 @@ typedef enum {
 
 #define PWR_RET_IPC -14
 #define PWR_RET_STATUS -15
+#define PWR_RET_TIMEOUT -16
 
 typedef struct {
     PWR_Time    start;
@@ -264,4 +265,30 @@ typedef int PWR_CntxtState;
 
 typedef void (*Callback)( void* data );
 
+typedef void* PWR_Sub;
+
+/* a push from a subscription, laid out as for PWR_GrpAttrGetValues,
+ * NULL values and times once no server is left to push it
+ */
+typedef void (*SubCallback)( void* data, void* vals, PWR_Time ts[] );
+
+typedef enum {
+    PWR_TRIGGER_NONE = 0,
+    PWR_TRIGGER_ABOVE,          /* value > threshold */
+    PWR_TRIGGER_BELOW,          /* value < threshold */
+    PWR_TRIGGER_RATE_ABOVE,     /* |change per second| > threshold */
+    PWR_TRIGGER_CHANGE,         /* |value - last pushed| > threshold */
+    PWR_NUM_TRIGGERS
+} PWR_TriggerOp;
+
+/* fires once the condition has held for holdTime and again after it
+ * has cleared, checked every checkPeriod, times in nanoseconds
+ */
+typedef struct {
+    PWR_TriggerOp op;
+    double      threshold;
+    PWR_Time    holdTime;
+    PWR_Time    checkPeriod;
+} PWR_TriggerCond;
+
 #endif
@@ -25,17 +25,10 @@ PyConfig::PyConfig( std::string file )
 {
 	DBGX2(DBG_CONFIG,"config file `%s`\n",file.c_str());
 
-	size_t pos = file.find_last_of('/');
-
 	std::string path;
-	std::string module = file;
-	if ( std::string::npos != pos ) { 
- 		path = file.substr( 0, pos );
-		module = file.substr( pos + 1 );
-
-		setenv( "PYTHONPATH", path.c_str(), 1 );
-	}
-	module = module.substr(0, module.find_last_of('.' ) );
+	std::string module;
+	bool rc = pyConfigModule( file, path, module );
+	assert( rc );
 
 	DBGX2( DBG_CONFIG, "path=`%s` module=`%s`\n",
 									path.c_str(), module.c_str() );
@@ -44,6 +37,15 @@ PyConfig::PyConfig( std::string file )
 	if ( NULL == m_pModule ) {
 
 		Py_Initialize();
+
+		// other threads may be reading the environment, so rather than 
+		// PYTHONPATH the interpreter's own path is given the directory
+		if ( ! path.empty() ) {
+			PyObject* sysPath = PySys_GetObject( (char*) "path" );
+			PyObject* dir = PyString_FromString( path.c_str() );
+			PyList_Insert( sysPath, 0, dir );
+			Py_DECREF( dir );
+		}
 	
 		m_pModule = PyImport_ImportModule( module.c_str() );
 		assert( m_pModule );
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <math.h>
+#include <time.h>
+
+#include "region.h"
+#include "debug.h"
+
+using namespace PowerAPI;
+
+static Regions* _regions = NULL;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+// durations are monotonic, only the period reported is the wall clock
+static inline PWR_Time now( clockid_t clock = CLOCK_MONOTONIC )
+{
+	struct timespec ts;
+	clock_gettime( clock, &ts );
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+Regions* Regions::get()
+{
+	pthread_once( &_once, create );
+	return _regions;
+}
+
+void Regions::create()
+{
+	_regions = new Regions;
+}
+
+Regions::Regions() : m_energy( LocalEnergy::get() )
+{
+	pthread_key_create( &m_key, NULL );
+	pthread_mutex_init( &m_mutex, NULL );
+	DBGX("energy %s\n", m_energy ? "yes" : "no" );
+}
+
+// a thread's table outlives it so its regions are still reported
+Regions::Thread* Regions::thread()
+{
+	Thread* t = static_cast<Thread*>( pthread_getspecific( m_key ) );
+	if ( ! t ) {
+		t = new Thread;
+		pthread_mutex_init( &t->mutex, NULL );
+		pthread_setspecific( m_key, t );
+		pthread_mutex_lock( &m_mutex );
+		m_threads.push_back( t );
+		pthread_mutex_unlock( &m_mutex );
+	}
+	return t;
+}
+
+int Regions::begin( const char* name )
+{
+	if ( ! name ) {
+		return PWR_RET_INVALID;
+	}
+	Thread* t = thread();
+	Open open;
+	open.name = name;
+	open.valid = m_energy && m_energy->read( open.sample );
+	open.start = now();
+	t->open.push_back( open );
+	return PWR_RET_SUCCESS;
+}
+
+// regions nest, the one ended must be the last one begun
+int Regions::end( const char* name )
+{
+	PWR_Time stop = now();
+	PWR_Time wall = now( CLOCK_REALTIME );
+	LocalEnergy::Sample sample;
+	bool valid = m_energy && m_energy->read( sample );
+
+	Thread* t = thread();
+	if ( ! name || t->open.empty() || t->open.back().name != name ) {
+		return PWR_RET_INVALID;
+	}
+	Open& open = t->open.back();
+
+	pthread_mutex_lock( &t->mutex );
+	Totals& totals = t->totals[ open.name ];
+	PWR_Time first = wall - ( stop - open.start );
+	if ( 0 == totals.time.count || first < totals.first ) {
+		totals.first = first;
+	}
+	if ( wall > totals.last ) {
+		totals.last = wall;
+	}
+	double secs = ( stop - open.start ) / 1000000000.0;
+	totals.time.add( secs );
+	if ( open.valid && valid && open.sample.pkg == sample.pkg ) {
+		double joules = m_energy->joules( open.sample, sample );
+		totals.energy.add( joules );
+		if ( secs > 0 ) {
+			totals.power.add( joules / secs );
+		}
+	}
+	pthread_mutex_unlock( &t->mutex );
+
+	t->open.pop_back();
+	return PWR_RET_SUCCESS;
+}
+
+int Regions::report( const char* name, PWR_AttrName attr, PWR_AttrStat stat,
+								double* value, PWR_TimePeriod* period )
+{
+	if ( ! name || ! value ) {
+		return PWR_RET_INVALID;
+	}
+	if ( attr != PWR_ATTR_NOT_SPECIFIED && attr != PWR_ATTR_ENERGY &&
+										attr != PWR_ATTR_POWER ) {
+		return PWR_RET_NO_ATTRIB;
+	}
+	if ( attr != PWR_ATTR_NOT_SPECIFIED && ! m_energy ) {
+		return PWR_RET_NO_ATTRIB;
+	}
+
+	Totals all;
+	pthread_mutex_lock( &m_mutex );
+	for ( unsigned i = 0; i < m_threads.size(); i++ ) {
+		Thread* t = m_threads[i];
+		pthread_mutex_lock( &t->mutex );
+		std::map<std::string,Totals>::iterator iter = t->totals.find( name );
+		if ( iter != t->totals.end() ) {
+			Totals& totals = iter->second;
+			if ( 0 == all.time.count || totals.first < all.first ) {
+				all.first = totals.first;
+			}
+			if ( totals.last > all.last ) {
+				all.last = totals.last;
+			}
+			all.time.add( totals.time );
+			all.energy.add( totals.energy );
+			all.power.add( totals.power );
+		}
+		pthread_mutex_unlock( &t->mutex );
+	}
+	pthread_mutex_unlock( &m_mutex );
+
+	if ( 0 == all.time.count ) {
+		return PWR_RET_EMPTY;
+	}
+	if ( period ) {
+		period->start = all.first;
+		period->stop = all.last;
+		period->instant = PWR_TIME_UNKNOWN;
+	}
+
+	switch ( attr ) {
+	  case PWR_ATTR_ENERGY:
+		return all.energy.value( stat, value );
+	  case PWR_ATTR_POWER:
+		return all.power.value( stat, value );
+	  default:
+		return all.time.value( stat, value );
+	}
+}
+
+void Regions::Acc::add( double value )
+{
+	if ( 0 == count || value < min ) {
+		min = value;
+	}
+	if ( 0 == count || value > max ) {
+		max = value;
+	}
+	++count;
+	sum += value;
+	sumSq += value * value;
+}
+
+void Regions::Acc::add( const Acc& other )
+{
+	if ( 0 == other.count ) {
+		return;
+	}
+	if ( 0 == count || other.min < min ) {
+		min = other.min;
+	}
+	if ( 0 == count || other.max > max ) {
+		max = other.max;
+	}
+	count += other.count;
+	sum += other.sum;
+	sumSq += other.sumSq;
+}
+
+int Regions::Acc::value( PWR_AttrStat stat, double* value )
+{
+	if ( 0 == count ) {
+		return PWR_RET_EMPTY;
+	}
+	double avg = sum / count;
+	double var = sumSq / count - avg * avg;
+	double stdev = var > 0 ? sqrt( var ) : 0;
+
+	switch ( stat ) {
+	  case PWR_ATTR_STAT_MIN:	*value = min; break;
+	  case PWR_ATTR_STAT_MAX:	*value = max; break;
+	  case PWR_ATTR_STAT_AVG:	*value = avg; break;
+	  case PWR_ATTR_STAT_SUM:	*value = sum; break;
+	  case PWR_ATTR_STAT_STDEV:	*value = stdev; break;
+	  case PWR_ATTR_STAT_CV:	*value = avg ? stdev / avg : 0; break;
+	  default:
+		return PWR_RET_INVALID;
+	}
+	return PWR_RET_SUCCESS;
+}
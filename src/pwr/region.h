@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _PWR_REGION_H
+#define _PWR_REGION_H
+
+#include <pthread.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pwrtypes.h"
+#include "localEnergy.h"
+
+namespace PowerAPI {
+
+// The regions an application marks with PWR_RegionBegin/End. The energy
+// of the package a thread runs on is read at both ends with LocalEnergy,
+// no context or daemon is involved, and added up per region name in a
+// table of the thread's own. A query adds the tables of all threads.
+// Without the package counters there is no energy, only time.
+class Regions {
+  public:
+	static Regions* get();
+
+	int begin( const char* name );
+	int end( const char* name );
+
+	// the stat of the instances of a region, ENERGY is joules, POWER
+	// watts and NOT_SPECIFIED the seconds an instance took
+	int report( const char* name, PWR_AttrName, PWR_AttrStat,
+									double* value, PWR_TimePeriod* );
+
+  private:
+	struct Acc {
+		Acc() : count( 0 ), sum( 0 ), sumSq( 0 ), min( 0 ), max( 0 ) {}
+		void add( double );
+		void add( const Acc& );
+		int value( PWR_AttrStat, double* );
+
+		uint64_t	count;
+		double		sum;
+		double		sumSq;
+		double		min;
+		double		max;
+	};
+
+	struct Totals {
+		Totals() : first( 0 ), last( 0 ) {}
+		// the wall clock, the first begin and the last end
+		PWR_Time	first;
+		PWR_Time	last;
+		Acc			time;
+		// only the instances that ran on one package have energy
+		Acc			energy;
+		Acc			power;
+	};
+
+	struct Open {
+		std::string			name;
+		PWR_Time			start;	// monotonic
+		bool				valid;
+		LocalEnergy::Sample	sample;
+	};
+
+	// the lock is only contended by a query
+	struct Thread {
+		pthread_mutex_t					mutex;
+		std::vector<Open>				open;
+		std::map<std::string,Totals>	totals;
+	};
+
+	Regions();
+	Thread* thread();
+	static void create();
+
+	LocalEnergy*			m_energy;
+	pthread_key_t			m_key;
+	pthread_mutex_t			m_mutex;
+	std::vector<Thread*>	m_threads;
+};
+
+}
+
+#endif
@@ -31,25 +31,37 @@ class Request {
 		m_cntxt( ctx),
 		m_status( status ),
 		m_callback( callback ),
-		m_data( data ) 
+		m_data( data ),
+		m_deadline( 0 )
 	{}
 	virtual ~Request() {}
 
 	virtual int wait( ) = 0;
+	virtual int wait( PWR_Time timeout ) = 0;
 	virtual bool finished() = 0;
 
+	// how long, in nanoseconds, the servers get to answer, 0 is forever
+	void setDeadline( PWR_Time deadline ) { m_deadline = deadline; }
+	PWR_Time deadline() { return m_deadline; }
+
 	// getAttr
 	std::vector<void*> 		value;
 	std::vector<PWR_Time*> 	timeStamp;
 
 	// where to put the number of samples returned 
 	unsigned int* count;
+
+	// where to put the windows statistics were computed over, and the
+	// member a reduction picked
+	PWR_TimePeriod* statTimes;
+	int*			statIndex;
 	
   protected:
 	Cntxt* 		m_cntxt;
 	Status* 	m_status;
 	Callback 	m_callback;
 	void*  		m_data;
+	PWR_Time	m_deadline;
 };
 
 }
@@ -26,10 +26,10 @@ class Cntxt;
 class Stat {
   public:
 	typedef double (*OpFuncPtr)(std::vector<double>&, int& pos );
-	Stat( Cntxt* ctx, Object* obj, PWR_AttrName name, OpFuncPtr ptr,
-															double hz ) 
+	Stat( Cntxt* ctx, Object* obj, PWR_AttrName name, PWR_AttrStat stat,
+											OpFuncPtr ptr, double hz ) 
 	  : m_ctx( ctx), m_obj(obj), m_grp(NULL), m_attrName( name ), 
-	    opPtr( ptr ), m_period( 1 / hz ),
+	    m_attrStat( stat ), opPtr( ptr ), m_period( 1 / hz ),
 		m_startTime(PWR_TIME_UNINIT), m_stopTime(PWR_TIME_UNINIT) 
     { 
         // for now limit stat to a leaf object with only 1 device
@@ -47,9 +47,10 @@ class Stat {
         }
     }
 
-	Stat( Cntxt* ctx, Grp* grp, PWR_AttrName name, OpFuncPtr ptr, double hz ) 
+	Stat( Cntxt* ctx, Grp* grp, PWR_AttrName name, PWR_AttrStat stat,
+											OpFuncPtr ptr, double hz ) 
 	  : m_ctx( ctx), m_obj(NULL), m_grp(grp), m_attrName( name ),
-	    opPtr( ptr ), m_period( 1/ hz), 
+	    m_attrStat( stat ), opPtr( ptr ), m_period( 1/ hz), 
 		m_startTime(PWR_TIME_UNINIT), m_stopTime(PWR_TIME_UNINIT)
     { 
         for ( unsigned i=0; i < grp->size(); i++ ) {
@@ -58,7 +59,9 @@ class Stat {
                 throw int ();
             }
             AttrInfo& info = grp->getObj(i)->getAttrInfo( name );
-            if ( 1 != info.devices.size() ) {
+            if ( ( 0 == info.devices.size() && ! info.comm ) || 
+               ( 0 < info.devices.size() && info.comm ) ||
+               ( 1 < info.devices.size() ) ) {
                 throw int ();
             }
         }
@@ -70,6 +73,8 @@ class Stat {
 	virtual int clear() = 0;
 	virtual int getValue( double* value, PWR_TimePeriod* statTimes ) = 0;
 	virtual int getValues( double value[], PWR_TimePeriod statTimes[] ) = 0;
+	virtual int getReduce( PWR_AttrStat, int* index, double* value,
+										PWR_TimePeriod* statTimes ) = 0;
 
 	Cntxt* getCtx() {
 		return m_ctx;
@@ -81,6 +86,7 @@ class Stat {
 	Object*			m_obj;
 	Grp*			m_grp;
 	PWR_AttrName	m_attrName;
+	PWR_AttrStat	m_attrStat;
 	OpFuncPtr		opPtr;
     double 			m_period;
     PWR_Time 		m_startTime;
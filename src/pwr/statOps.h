@@ -0,0 +1,78 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _PWR_STAT_OPS_H
+#define _PWR_STAT_OPS_H
+
+#include <vector>
+#include "pwrtypes.h"
+#include "debug.h"
+
+// Reductions over a window of samples, shared by the library and the
+// servers that compute statistics next to their data. pos is the index
+// of the sample that gave the result, -1 if no single one did.
+
+typedef double (*StatOpFuncPtr)( std::vector<double>&, int& pos );
+
+static inline double opAvg( std::vector<double>& data, int& pos )
+{
+    pos = -1;
+    double result = 0;
+    for ( unsigned i =0; i < data.size(); i++ ) {
+        DBG("%lf\n",data[i]);
+        result += data[i];
+    }
+    return result / data.size();
+}
+
+static inline double opMin( std::vector<double>& data, int& pos )
+{
+    double result = data[0];
+
+    pos = 0;
+    DBG("%d %lf\n",0,data[0]);
+    for ( unsigned i =1; i < data.size(); i++ ) {
+        DBG("%d %lf\n",i,data[i]);
+        if ( data[i] < result ) {
+            pos = i;
+            result = data[i];
+        }
+    }
+    return result;
+}
+
+static inline double opMax( std::vector<double>& data, int& pos )
+{
+    double result = data[0];
+
+    pos = 0;
+    DBG("%d %lf\n",0,data[0]);
+    for ( unsigned i =1; i < data.size(); i++ ) {
+        DBG("%d %lf\n",i,data[i]);
+        if ( data[i] > result ) {
+            pos = i;
+            result = data[i];
+        }
+    }
+    return result;
+}
+
+static inline StatOpFuncPtr getStatOp( PWR_AttrStat stat )
+{
+	switch ( stat ) {
+	  case PWR_ATTR_STAT_AVG: return opAvg;
+	  case PWR_ATTR_STAT_MIN: return opMin;
+	  case PWR_ATTR_STAT_MAX: return opMax;
+	  default: return NULL;
+	}
+}
+
+#endif
@@ -11,6 +11,9 @@
 
 #include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <time.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -34,6 +37,8 @@ TcpEventChannel::TcpEventChannel( AllocFuncPtr func, std::string config, std::st
 {
     std::map<std::string,std::string> foo;
 
+	pthread_mutex_init( &m_sendLock, NULL );
+
     split( config, foo );
 
 	DBGX2(DBG_EC,"%s\n",getName().c_str());
@@ -60,6 +65,7 @@ int TcpEventChannel::xx()
 TcpEventChannel::TcpEventChannel( AllocFuncPtr func, int fd, std::string name ) : 
 	EventChannel( func, name ), m_fd( fd )
 {
+	pthread_mutex_init( &m_sendLock, NULL );
 	DBGX2(DBG_EC,"%s fd=%d\n",getName().c_str(),m_fd);
 }
 
@@ -67,6 +73,7 @@ TcpEventChannel::~TcpEventChannel( )
 {
 	DBGX2(DBG_EC,"%s fd=%d\n",getName().c_str(),m_fd);
 	if ( m_fd > -1 ) ::close( m_fd );
+	pthread_mutex_destroy( &m_sendLock );
 }
 int TcpEventChannel::initClient( std::string hostname, std::string portStr )
 {
@@ -153,7 +160,10 @@ EventChannel* TcpEventChannel::accept( )
     int rc = setsockopt( cliFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag) );
     assert( rc == 0 );
 	
-	return new TcpEventChannel( m_allocFunc, cliFd, getName() + "-recv" );
+	EventChannel* chan = 
+			new TcpEventChannel( m_allocFunc, cliFd, getName() + "-recv" );
+	chan->setStats( m_stats );
+	return chan;
 }
 #if 1 
 #define print(x,y)
@@ -202,6 +212,12 @@ Event* TcpEventChannel::getEvent( bool blocking )
 	print( (unsigned char*) buf.addr(), nbytes );
 
 
+	if ( m_stats ) {
+		__sync_fetch_and_add( &m_stats->eventsIn, 1 );
+		__sync_fetch_and_add( &m_stats->bytesIn, 
+						sizeof(type) + sizeof(length) + length );
+	}
+
 	Event* ev =m_allocFunc( type, buf );
 
 	DBGX2(DBG_EC2,"%s event type %d, length=%lu \n",getName().c_str(), 
@@ -212,14 +228,18 @@ Event* TcpEventChannel::getEvent( bool blocking )
 
 bool TcpEventChannel::sendEvent( Event* event )
 {
+	SerialBuf buf;
+	event->serialize_out(buf);
+
+	// the header and body must go out back to back when more than
+	// one thread sends on this channel
+	pthread_mutex_lock( &m_sendLock );
+
 //	printf("%s() waiting\n",__func__); getchar();
 	if ( -1 == m_fd ) {
 		m_fd = xx();
 	}
 
-	SerialBuf buf;
-	event->serialize_out(buf);
-
 	size_t nbytes = write( m_fd, &event->type, sizeof(event->type) ); 
 	assert( nbytes == sizeof(event->type) );
 	print( (unsigned char*) &event->type, nbytes );
@@ -233,24 +253,71 @@ bool TcpEventChannel::sendEvent( Event* event )
 	assert( nbytes == buf.length() );
 	print( (unsigned char*) buf.addr(), nbytes );
 
+	pthread_mutex_unlock( &m_sendLock );
+
+	if ( m_stats ) {
+		__sync_fetch_and_add( &m_stats->eventsOut, 1 );
+		__sync_fetch_and_add( &m_stats->bytesOut, 
+						sizeof(event->type) + sizeof(length) + length );
+	}
+
 	DBGX2(DBG_EC2,"%s event type %d, length=%lu \n",getName().c_str(), 
 						event->type, length);
 
     return true;
 }
 
+bool TcpEventChannel::ready( int64_t timeout )
+{
+	if ( -1 == m_fd ) {
+		m_fd = xx();
+	}
+
+	struct pollfd pfd;
+	pfd.fd = m_fd;
+	pfd.events = POLLIN;
+
+	// round up so we don't spin on a sub millisecond remainder
+	int msecs = timeout < 0 ? -1 : ( timeout + 999999 ) / 1000000;
+	int rc;
+	do {
+		rc = poll( &pfd, 1, msecs );
+	} while ( rc < 0 && EINTR == errno );
+
+	// a closed socket is ready, getEvent() will report it 
+	return rc != 0;
+}
+
+size_t TcpEventChannel::sendQueueDepth()
+{
+	int queued = 0;
+	if ( -1 == m_fd || ioctl( m_fd, TIOCOUTQ, &queued ) < 0 ) {
+		return 0;
+	}
+	return queued;
+}
+
 /************************************************************************/
 
-TcpChannelSelect::TcpChannelSelect()
+TcpChannelSelect::TcpChannelSelect() : m_nextFd(0)
 {
+	pthread_mutex_init( &m_lock, NULL );
+	int rc = pipe( m_wakeFd );
+	assert( 0 == rc );
 }
 
 bool TcpChannelSelect::addChannel( EventChannel* chan, Data* ptr )
 {
 	DBGX2(DBG_EC,"name='%s'\n",chan->getName().c_str() );
+	pthread_mutex_lock( &m_lock );
     assert( m_chanMap.find( chan ) == m_chanMap.end() );
 
     m_chanMap[chan] = ptr;
+	pthread_mutex_unlock( &m_lock );
+
+	char c = 0;
+	ssize_t rc = write( m_wakeFd[1], &c, sizeof(c) );
+	assert( rc == sizeof(c) );
 
     return false;
 }
@@ -258,9 +325,11 @@ bool TcpChannelSelect::addChannel( EventChannel* chan, Data* ptr )
 bool TcpChannelSelect::delChannel( EventChannel* chan )
 {
 	DBGX2(DBG_EC,"\n");
+	pthread_mutex_lock( &m_lock );
     assert( m_chanMap.find( chan ) != m_chanMap.end() );
 
     m_chanMap.erase(chan);
+	pthread_mutex_unlock( &m_lock );
 
     return false;
 }
@@ -292,18 +361,28 @@ int TcpChannelSelect::select(int nfds, fd_set* readfds, fd_set* writefds,
 	} 
 }
 
-ChannelSelect::Data* TcpChannelSelect::wait()
+ChannelSelect::Data* TcpChannelSelect::wait( int64_t timeout )
 {
     int     fdmax = 0;;
     fd_set  read_fds;
     fd_set  write_fds;
 	EventChannel* chan;
+	Data* data;
+	struct timespec end;
+
+	if ( timeout > 0 ) {
+		clock_gettime( CLOCK_MONOTONIC, &end );
+		end.tv_sec += ( end.tv_nsec + timeout ) / 1000000000;
+		end.tv_nsec = ( end.tv_nsec + timeout ) % 1000000000;
+	}
 
 	std::map< int, EventChannel* > fdMap;
 	do {
+		chan = NULL;
     	FD_ZERO( &read_fds );
     	FD_ZERO( &write_fds );
 
+		pthread_mutex_lock( &m_lock );
 		std::map<EventChannel*,Data*>::iterator iter = m_chanMap.begin();
 
 		while ( iter != m_chanMap.end() ) {
@@ -319,22 +398,63 @@ ChannelSelect::Data* TcpChannelSelect::wait()
 			}
 			++iter;
 		}
+		pthread_mutex_unlock( &m_lock );
+
+		FD_SET( m_wakeFd[0], &read_fds );
+		fdmax = m_wakeFd[0] > fdmax ? m_wakeFd[0] : fdmax;
+
+		struct timeval tv;
+		struct timeval* tvp = NULL;
+		if ( timeout == 0 ) {
+			tv.tv_sec = 0;
+			tv.tv_usec = 0;
+			tvp = &tv;
+		} else if ( timeout > 0 ) {
+			struct timespec now;
+			clock_gettime( CLOCK_MONOTONIC, &now );
+			int64_t left = ( end.tv_sec - now.tv_sec ) * 1000000000LL + 
+										( end.tv_nsec - now.tv_nsec );
+			if ( left < 0 ) {
+				left = 0;
+			}
+			tv.tv_sec = left / 1000000000;
+			tv.tv_usec = ( left % 1000000000 + 999 ) / 1000;
+			tvp = &tv;
+		}
 
 		DBGX2(DBG_EC,"calling select\n");
 
-    	int ret = ::select( fdmax+1, &read_fds, NULL, NULL, NULL );
-    	assert( ret > 0 );
+    	int ret = ::select( fdmax+1, &read_fds, NULL, NULL, tvp );
+		if ( ret < 0 && EINTR == errno ) {
+			continue;
+		}
+    	assert( ret >= 0 );
+		if ( 0 == ret ) {
+			return NULL;
+		}
+
+		if ( FD_ISSET( m_wakeFd[0], &read_fds ) ) {
+			char buf[64];
+			ssize_t rc = read( m_wakeFd[0], buf, sizeof(buf) );
+			assert( rc > 0 );
+			continue;
+		}
 
-    	for ( int i = 0; i <= fdmax; i++ ) {
+    	for ( int n = 0; n <= fdmax; n++ ) {
+			int i = ( m_nextFd + n ) % ( fdmax + 1 );
         	if ( FD_ISSET( i, &read_fds ) ) {
 				DBGX2(DBG_EC,"selected %d\n",i);
 				chan = fdMap[i];
+				m_nextFd = i + 1;
 				break;
         	}
     	} 
 	} while ( ! chan );
 
-    return m_chanMap[chan];
+	pthread_mutex_lock( &m_lock );
+	data = m_chanMap[chan];
+	pthread_mutex_unlock( &m_lock );
+    return data;
 }
 
 /************************************************************************/
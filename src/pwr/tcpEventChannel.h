@@ -13,6 +13,7 @@
 #define _TCP_EVENT_CHANNEL_H
 
 #include <sys/select.h> 
+#include <pthread.h>
 #include <string>
 #include <map>
 #include <set>
@@ -26,6 +27,8 @@ class TcpEventChannel : public EventChannel {
 
     virtual Event* getEvent( bool blocking = true );
     virtual bool sendEvent( Event* );
+	virtual bool ready( int64_t timeout );
+	virtual size_t sendQueueDepth();
 	EventChannel *accept(  );
 
     int getFd( ) { return m_fd; } 
@@ -36,6 +39,7 @@ class TcpEventChannel : public EventChannel {
     int setupRecv( int port );
 	int xx();
     int         m_fd;
+	pthread_mutex_t m_sendLock;
 	std::string m_clientServer;
 	std::string m_clientServerPort;
 };
@@ -45,12 +49,21 @@ class TcpChannelSelect : public ChannelSelect {
     TcpChannelSelect(); 
     virtual bool addChannel( EventChannel*, Data* );
     virtual bool delChannel( EventChannel* );
-    virtual Data* wait();
+    virtual Data* wait( int64_t timeout = -1 );
 
   private:
 	int select(int nfds, fd_set* readfds, fd_set* writefds,
 					fd_set* errorfds,struct timeval * timeout);
     std::map<EventChannel*,Data*> m_chanMap;
+
+	// channels may be added from another thread while we are sitting 
+	// in select(), a byte written to this pipe kicks us out
+	int				m_wakeFd[2];
+	pthread_mutex_t m_lock;
+
+	// where the search for a ready channel starts, so a busy channel
+	// can't hide the others
+	int				m_nextFd;
 };
 
 #endif
@@ -0,0 +1,388 @@
+/* 
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work 
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tsFile.h"
+#include "debug.h"
+
+using namespace PowerAPI;
+
+static const char FILE_MAGIC[8] = { 'P','W','R','T','S', 0, 0, 1 };
+static const uint32_t BLOCK_MAGIC = 0x42535450;
+static const size_t BLOCK_HEADER = 4 + 4 + 8 + 8 + 8 + 8; 
+
+class BitWriter {
+  public:
+	BitWriter( std::vector<uint8_t>& buf ) : m_buf( buf ), m_bit( 0 ) {}
+
+	// the low n bits of value, most significant first
+	void put( uint64_t value, int n ) {
+		while ( n > 0 ) {
+			if ( 0 == m_bit ) {
+				m_buf.push_back( 0 );
+			}
+			int room = 8 - m_bit;
+			int take = n < room ? n : room;
+			uint8_t bits = ( value >> ( n - take ) ) & ( ( 1 << take ) - 1 );
+			m_buf.back() |= bits << ( room - take );
+			m_bit = ( m_bit + take ) & 7;
+			n -= take;
+		}
+	}
+  private:
+	std::vector<uint8_t>&	m_buf;
+	int						m_bit;
+};
+
+class BitReader {
+  public:
+	BitReader( const uint8_t* buf ) : m_buf( buf ), m_pos( 0 ) {}
+
+	uint64_t get( int n ) {
+		uint64_t value = 0;
+		while ( n > 0 ) {
+			int bit = m_pos & 7;
+			int room = 8 - bit;
+			int take = n < room ? n : room;
+			uint8_t bits = ( m_buf[ m_pos >> 3 ] >> ( room - take ) ) & 
+												( ( 1 << take ) - 1 );
+			value = ( value << take ) | bits;
+			m_pos += take;
+			n -= take;
+		}
+		return value;
+	}
+  private:
+	const uint8_t*	m_buf;
+	size_t			m_pos;
+};
+
+static inline int64_t signExtend( uint64_t value, int n )
+{
+	uint64_t sign = (uint64_t) 1 << ( n - 1 );
+	return (int64_t) ( ( value ^ sign ) - sign );
+}
+
+static inline bool fits( int64_t value, int n )
+{
+	int64_t max = ( (int64_t) 1 << ( n - 1 ) ) - 1;
+	return value >= -max - 1 && value <= max;
+}
+
+// the first time whole, then the first delta, then how much each delta 
+// differs from the one before in the smallest of a few widths
+static void encodeTimes( const std::vector<PWR_Time>& time, 
+									std::vector<uint8_t>& buf )
+{
+	BitWriter out( buf );
+	out.put( time[0], 64 );
+	if ( time.size() < 2 ) {
+		return;
+	}
+	int64_t delta = time[1] - time[0];
+	out.put( delta, 64 );
+
+	for ( size_t i = 2; i < time.size(); i++ ) {
+		int64_t next = time[i] - time[i-1];
+		int64_t dod = next - delta;
+		delta = next;
+
+		if ( 0 == dod ) {
+			out.put( 0, 1 );
+		} else if ( fits( dod, 16 ) ) {
+			out.put( 2, 2 );
+			out.put( dod, 16 );
+		} else if ( fits( dod, 24 ) ) {
+			out.put( 6, 3 );
+			out.put( dod, 24 );
+		} else if ( fits( dod, 32 ) ) {
+			out.put( 14, 4 );
+			out.put( dod, 32 );
+		} else {
+			out.put( 15, 4 );
+			out.put( dod, 64 );
+		}
+	}
+}
+
+static void decodeTimes( const uint8_t* buf, size_t count, 
+									std::vector<PWR_Time>& time )
+{
+	BitReader in( buf );
+	time.resize( count );
+	time[0] = in.get( 64 );
+	if ( count < 2 ) {
+		return;
+	}
+	int64_t delta = in.get( 64 );
+	time[1] = time[0] + delta;
+
+	for ( size_t i = 2; i < count; i++ ) {
+		int64_t dod = 0;
+		if ( in.get( 1 ) ) {
+			if ( ! in.get( 1 ) ) {
+				dod = signExtend( in.get( 16 ), 16 );
+			} else if ( ! in.get( 1 ) ) {
+				dod = signExtend( in.get( 24 ), 24 );
+			} else if ( ! in.get( 1 ) ) {
+				dod = signExtend( in.get( 32 ), 32 );
+			} else {
+				dod = in.get( 64 );
+			}
+		}
+		delta += dod;
+		time[i] = time[i-1] + delta;
+	}
+}
+
+// each value XORed with the one before, an unchanged value is one bit 
+// and the changed bits reuse the last window if they fit in it
+static void encodeValues( const std::vector<double>& value, 
+									std::vector<uint8_t>& buf )
+{
+	BitWriter out( buf );
+	uint64_t prev;
+	memcpy( &prev, &value[0], sizeof(prev) );
+	out.put( prev, 64 );
+
+	int lead = -1, trail = 0;
+	for ( size_t i = 1; i < value.size(); i++ ) {
+		uint64_t bits;
+		memcpy( &bits, &value[i], sizeof(bits) );
+		uint64_t x = bits ^ prev;
+		prev = bits;
+
+		if ( 0 == x ) {
+			out.put( 0, 1 );
+			continue;
+		}
+		out.put( 1, 1 );
+
+		int l = __builtin_clzll( x );
+		int t = __builtin_ctzll( x );
+		if ( l > 31 ) {
+			l = 31;
+		}
+		if ( lead >= 0 && l >= lead && t >= trail ) {
+			out.put( 0, 1 );
+			out.put( x >> trail, 64 - lead - trail );
+		} else {
+			lead = l;
+			trail = t;
+			int len = 64 - lead - trail;
+			out.put( 1, 1 );
+			out.put( lead, 5 );
+			out.put( len - 1, 6 );
+			out.put( x >> trail, len );
+		}
+	}
+}
+
+static void decodeValues( const uint8_t* buf, size_t count, 
+									std::vector<double>& value )
+{
+	BitReader in( buf );
+	value.resize( count );
+	uint64_t prev = in.get( 64 );
+	memcpy( &value[0], &prev, sizeof(prev) );
+
+	int lead = 0, trail = 0;
+	for ( size_t i = 1; i < count; i++ ) {
+		if ( in.get( 1 ) ) {
+			if ( in.get( 1 ) ) {
+				lead = in.get( 5 );
+				int len = in.get( 6 ) + 1;
+				trail = 64 - lead - len;
+			}
+			prev ^= in.get( 64 - lead - trail ) << trail;
+		}
+		memcpy( &value[i], &prev, sizeof(prev) );
+	}
+}
+
+template< typename T > 
+static void append( std::vector<uint8_t>& buf, T value )
+{
+	const uint8_t* ptr = (const uint8_t*) &value;
+	buf.insert( buf.end(), ptr, ptr + sizeof(value) );
+}
+
+template< typename T > 
+static T extract( const uint8_t*& ptr )
+{
+	T value;
+	memcpy( &value, ptr, sizeof(value) );
+	ptr += sizeof(value);
+	return value;
+}
+
+TsWriter::TsWriter( FILE* fp, unsigned maxPoints, PWR_Time maxSpan ) :
+	m_fp( fp ), m_maxPoints( maxPoints ), m_maxSpan( maxSpan ),
+	m_points( 0 ), m_first( 0 ), m_last( 0 )
+{
+	fwrite( FILE_MAGIC, sizeof(FILE_MAGIC), 1, m_fp );
+}
+
+TsWriter::~TsWriter()
+{
+	flush();
+}
+
+void TsWriter::add( const std::string& object, PWR_AttrName attr, 
+									PWR_Time time, double value )
+{
+	if ( 0 == m_points || time < m_first ) {
+		m_first = time;
+	}
+	if ( 0 == m_points || time > m_last ) {
+		m_last = time;
+	}
+	Series& series = m_series[ Key( object, attr ) ];
+	series.time.push_back( time );
+	series.value.push_back( value );
+
+	if ( ++m_points >= m_maxPoints || m_last - m_first >= m_maxSpan ) {
+		flush();
+	}
+}
+
+void TsWriter::flush()
+{
+	if ( 0 == m_points ) {
+		return;
+	}
+
+	std::vector<uint8_t> index;
+	std::vector<uint8_t> data;
+	std::map< Key, Series >::iterator iter = m_series.begin();
+	for ( ; iter != m_series.end(); ++iter ) {
+		Series& series = iter->second;
+		uint64_t offset = data.size();
+		encodeTimes( series.time, data );
+		uint32_t timeBytes = data.size() - offset;
+		encodeValues( series.value, data );
+		uint32_t valueBytes = data.size() - offset - timeBytes;
+
+		append<uint32_t>( index, iter->first.second );
+		append<uint32_t>( index, series.time.size() );
+		append<uint64_t>( index, offset );
+		append<uint32_t>( index, timeBytes );
+		append<uint32_t>( index, valueBytes );
+		append<uint16_t>( index, iter->first.first.size() );
+		index.insert( index.end(), iter->first.first.begin(), 
+									iter->first.first.end() );
+	}
+
+	std::vector<uint8_t> header;
+	append<uint32_t>( header, BLOCK_MAGIC );
+	append<uint32_t>( header, m_series.size() );
+	append<int64_t>( header, m_first );
+	append<int64_t>( header, m_last );
+	append<uint64_t>( header, index.size() );
+	append<uint64_t>( header, data.size() );
+
+	DBGX("series=%zu points=%u bytes=%zu\n", m_series.size(), m_points,
+				header.size() + index.size() + data.size() );
+
+	fwrite( &header[0], header.size(), 1, m_fp );
+	fwrite( &index[0], index.size(), 1, m_fp );
+	fwrite( &data[0], data.size(), 1, m_fp );
+	fflush( m_fp );
+
+	m_series.clear();
+	m_points = 0;
+}
+
+TsReader::TsReader() : m_base( NULL ), m_size( 0 ), m_next( 0 ), 
+	m_data( NULL ), m_firstTime( 0 ), m_lastTime( 0 )
+{
+}
+
+TsReader::~TsReader()
+{
+	if ( m_base ) {
+		munmap( (void*) m_base, m_size );
+	}
+}
+
+bool TsReader::open( const char* path )
+{
+	int fd = ::open( path, O_RDONLY );
+	if ( fd < 0 ) {
+		return false;
+	}
+	struct stat st;
+	if ( fstat( fd, &st ) || (size_t) st.st_size < sizeof(FILE_MAGIC) ) {
+		close( fd );
+		return false;
+	}
+	void* ptr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( MAP_FAILED == ptr ) {
+		return false;
+	}
+	m_base = (const uint8_t*) ptr;
+	m_size = st.st_size;
+	m_next = sizeof(FILE_MAGIC);
+	return 0 == memcmp( m_base, FILE_MAGIC, sizeof(FILE_MAGIC) );
+}
+
+bool TsReader::nextBlock()
+{
+	m_index.clear();
+	if ( m_next + BLOCK_HEADER > m_size ) {
+		return false;
+	}
+
+	const uint8_t* ptr = m_base + m_next;
+	if ( BLOCK_MAGIC != extract<uint32_t>( ptr ) ) {
+		return false;
+	}
+	uint32_t numSeries = extract<uint32_t>( ptr );
+	m_firstTime = extract<int64_t>( ptr );
+	m_lastTime = extract<int64_t>( ptr );
+	uint64_t indexBytes = extract<uint64_t>( ptr );
+	uint64_t dataBytes = extract<uint64_t>( ptr );
+
+	// a block that was being written when the file was copied
+	if ( m_next + BLOCK_HEADER + indexBytes + dataBytes > m_size ) {
+		return false;
+	}
+
+	m_index.resize( numSeries );
+	for ( uint32_t i = 0; i < numSeries; i++ ) {
+		Entry& entry = m_index[i];
+		entry.attr = (PWR_AttrName) extract<uint32_t>( ptr );
+		entry.count = extract<uint32_t>( ptr );
+		entry.offset = extract<uint64_t>( ptr );
+		entry.timeBytes = extract<uint32_t>( ptr );
+		entry.valueBytes = extract<uint32_t>( ptr );
+		uint16_t len = extract<uint16_t>( ptr );
+		entry.object.assign( (const char*) ptr, len );
+		ptr += len;
+	}
+	m_data = ptr;
+	m_next += BLOCK_HEADER + indexBytes + dataBytes;
+	return true;
+}
+
+void TsReader::read( size_t i, std::vector<PWR_Time>& time, 
+										std::vector<double>& value )
+{
+	Entry& entry = m_index[i];
+	decodeTimes( m_data + entry.offset, entry.count, time );
+	decodeValues( m_data + entry.offset + entry.timeBytes, entry.count, value );
+}
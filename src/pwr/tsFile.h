@@ -0,0 +1,105 @@
+/* 
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work 
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _PWR_TS_FILE_H
+#define _PWR_TS_FILE_H
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "pwrtypes.h"
+
+// A compact file of attribute samples. The file is an 8 byte magic
+// followed by blocks, each
+//
+//   header   magic, number of series, first and last time, the sizes 
+//            of the index and data
+//   index    per series its object, attribute, count and where its
+//            columns are in the data
+//   data     per series a column of times, delta of delta encoded, 
+//            and a column of values, XOR encoded against the previous 
+//            one, both bit packed
+//
+// so a reader can skip a block by its time range and a series by its 
+// index entry without decoding anything. Integers are in host order. A
+// NaN value marks a gap, a time the value couldn't be read.
+
+namespace PowerAPI {
+
+class TsWriter {
+  public:
+	// a block is written when it has maxPoints samples or spans 
+	// maxSpan nanoseconds
+	TsWriter( FILE*, unsigned maxPoints = 65536, 
+						PWR_Time maxSpan = 60 * 1000000000LL );
+	~TsWriter();
+
+	void add( const std::string& object, PWR_AttrName, PWR_Time, double );
+	// write what we have as a block
+	void flush();
+
+  private:
+	struct Series {
+		std::vector<PWR_Time>	time;
+		std::vector<double>		value;
+	};
+	typedef std::pair< std::string, PWR_AttrName > Key;
+
+	FILE*					m_fp;
+	unsigned				m_maxPoints;
+	PWR_Time				m_maxSpan;
+	unsigned				m_points;
+	PWR_Time				m_first;
+	PWR_Time				m_last;
+	std::map< Key, Series >	m_series;
+};
+
+class TsReader {
+  public:
+	TsReader();
+	~TsReader();
+
+	// maps the file, false if it isn't one of ours
+	bool open( const char* path );
+	// on to the next block, the first call goes to the first one
+	bool nextBlock();
+
+	PWR_Time firstTime() { return m_firstTime; }
+	PWR_Time lastTime() { return m_lastTime; }
+	size_t numSeries() { return m_index.size(); }
+	const std::string& object( size_t i ) { return m_index[i].object; }
+	PWR_AttrName attr( size_t i ) { return m_index[i].attr; }
+	size_t count( size_t i ) { return m_index[i].count; }
+	void read( size_t i, std::vector<PWR_Time>&, std::vector<double>& );
+
+  private:
+	struct Entry {
+		std::string		object;
+		PWR_AttrName	attr;
+		uint32_t		count;
+		uint64_t		offset;
+		uint32_t		timeBytes;
+		uint32_t		valueBytes;
+	};
+
+	const uint8_t*		m_base;
+	size_t				m_size;
+	size_t				m_next;
+	const uint8_t*		m_data;
+	PWR_Time			m_firstTime;
+	PWR_Time			m_lastTime;
+	std::vector<Entry>	m_index;
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "behavior.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+typedef int (*test_t)( void );
+
+/* the extensions the specification doesn't cover, checked by what they
+ * do rather than only by their return codes
+ */
+int check( char *desc, test_t test )
+{
+    int rc;
+
+    printf( "Instantiating behavior check for %s\n", desc );
+    rc = test( );
+    printf( "Results from behavior check for %s: %s\n", desc, RESULT( rc ) );
+
+    return (rc != PWR_RET_SUCCESS);
+}
+
+int main( int argc, char* argv[] )
+{
+    int test = PWR_RET_SUCCESS;
+
+    test |= check( "time series file", ts_file_test );
+    test |= check( "stat reduce", stat_reduce_test );
+    test |= check( "regions", region_test );
+    test |= check( "shared memory table", shm_table_test );
+    test |= check( "sample cache rollups", rollup_test );
+    test |= check( "late responses", late_response_test );
+
+    return test;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef BEHAVIOR_H
+#define BEHAVIOR_H
+
+#include "section.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int ts_file_test( void );
+int stat_reduce_test( void );
+int region_test( void );
+int shm_table_test( void );
+int rollup_test( void );
+int late_response_test( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
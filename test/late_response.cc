@@ -0,0 +1,202 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "events.h"
+#include "tcpEventChannel.h"
+#include "behavior.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+// stands in for the router, holds the requests until told to answer them
+struct Router {
+    int listenFd;
+    EventChannel* chan;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    std::vector<EventId> held;
+    bool answer;
+};
+
+static uint64_t bits( double value )
+{
+    uint64_t tmp;
+    memcpy( &tmp, &value, sizeof(tmp) );
+    return tmp;
+}
+
+static Event* allocEvent( unsigned int type, SerialBuf& buf )
+{
+    switch( type ) {
+      case CommCreate:
+        return new CommCreateEvent( buf );
+      case CommReq:
+        return new CommReqEvent( buf );
+      case CommDestroy:
+        return new CommDestroyEvent( buf );
+    }
+    return NULL;
+}
+
+static void respond( EventChannel* chan, EventId id )
+{
+    CommRespEvent ev;
+    ev.id = id;
+    ev.status = PWR_RET_SUCCESS;
+    ev.op = CommEvent::Get;
+    ev.value.resize( 1, std::vector<uint64_t>( 1, bits( 7.0 ) ) );
+    ev.timeStamp.resize( 1, std::vector<PWR_Time>( 1, 1 ) );
+    chan->sendEvent( &ev );
+}
+
+static void* router( void* arg )
+{
+    Router* rtr = (Router*) arg;
+    int fd = accept( rtr->listenFd, NULL, NULL );
+    if ( fd < 0 ) {
+        return NULL;
+    }
+    rtr->chan = new TcpEventChannel( allocEvent, fd, "router" );
+
+    Event* ev;
+    while ( ( ev = rtr->chan->getEvent() ) ) {
+        if ( CommReq == ev->type ) {
+            pthread_mutex_lock( &rtr->lock );
+            if ( rtr->answer ) {
+                respond( rtr->chan, ev->id );
+            } else {
+                rtr->held.push_back( ev->id );
+                pthread_cond_signal( &rtr->cond );
+            }
+            pthread_mutex_unlock( &rtr->lock );
+        }
+        delete ev;
+    }
+    return NULL;
+}
+
+// a request that timed out and was destroyed gets its response after,
+// the context has to drop it rather than write through the request
+int late_response_test( void )
+{
+    int rc, result = PWR_RET_SUCCESS;
+    PWR_Cntxt cntxt;
+    PWR_Obj self;
+    PWR_Request req;
+    PWR_AttrName name = PWR_ATTR_ENERGY;
+    PWR_Time ts;
+    double late, before, value = 0;
+    Router rtr;
+    pthread_t thread;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    char port[16];
+
+    // the servers' config, the entry point is served remotely
+    std::string config( getenv( "POWERAPI_CONFIG" ) );
+    config = config.substr( 0, config.rfind( '/' ) + 1 ) + "dummySystem.xml";
+
+    rtr.chan = NULL;
+    rtr.answer = false;
+    pthread_mutex_init( &rtr.lock, NULL );
+    pthread_cond_init( &rtr.cond, NULL );
+
+    rtr.listenFd = socket( AF_INET, SOCK_STREAM, 0 );
+    memset( &addr, 0, sizeof(addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if ( bind( rtr.listenFd, (struct sockaddr*) &addr, sizeof(addr) ) ||
+            listen( rtr.listenFd, 1 ) ||
+            getsockname( rtr.listenFd, (struct sockaddr*) &addr, &len ) ) {
+        printf( "\t\tError: no socket for the router\n" );
+        close( rtr.listenFd );
+        return PWR_RET_FAILURE;
+    }
+    snprintf( port, sizeof(port), "%d", ntohs( addr.sin_port ) );
+
+    setenv( "LatePOWERAPI_CONFIG", config.c_str(), 1 );
+    setenv( "LatePOWERAPI_ROOT", "plat.cab0.board0", 1 );
+    setenv( "LatePOWERAPI_SERVER", "localhost", 1 );
+    setenv( "LatePOWERAPI_SERVER_PORT", port, 1 );
+    pthread_create( &thread, NULL, router, &rtr );
+
+    rc = PWR_CntxtInit( PWR_CNTXT_DEFAULT, PWR_ROLE_APP, "Late", &cntxt );
+    printf( "\tPWR_CntxtInit - context of a remote entry point: %s\n",
+                                                            RESULT( rc ) );
+    if( rc < PWR_RET_SUCCESS ) {
+        close( rtr.listenFd );
+        return rc;
+    }
+    PWR_CntxtGetEntryPoint( cntxt, &self );
+
+    req = PWR_ReqCreate( cntxt, NULL );
+    rc = PWR_ObjAttrGetValues_NB( self, 1, &name, &late, &ts, req );
+    if( rc < PWR_RET_SUCCESS ) {
+        printf( "\t\tError: the get wasn't sent\n" );
+        return rc;
+    }
+    before = late;
+
+    pthread_mutex_lock( &rtr.lock );
+    while ( rtr.held.empty() ) {
+        pthread_cond_wait( &rtr.cond, &rtr.lock );
+    }
+    pthread_mutex_unlock( &rtr.lock );
+
+    rc = PWR_ReqWaitTimeout( req, 1000000 );
+    printf( "\tPWR_ReqWaitTimeout - an unanswered get times out: %s\n",
+                        rc == PWR_RET_TIMEOUT ? "SUCCESS" : "FAILURE" );
+    if ( rc != PWR_RET_TIMEOUT ) {
+        result = PWR_RET_FAILURE;
+    }
+    PWR_ReqDestroy( req );
+
+    // the late answer is ahead of the next request's
+    pthread_mutex_lock( &rtr.lock );
+    respond( rtr.chan, rtr.held[0] );
+    rtr.answer = true;
+    pthread_mutex_unlock( &rtr.lock );
+
+    rc = PWR_ObjAttrGetValue( self, PWR_ATTR_ENERGY, &value, &ts );
+    rc = rc == PWR_RET_SUCCESS && value == 7.0;
+    printf( "\tPWR_ObjAttrGetValue - answered after the late response: %s\n",
+                                        rc ? "SUCCESS" : "FAILURE" );
+    if ( ! rc ) {
+        result = PWR_RET_FAILURE;
+    }
+    printf( "\tthe destroyed request's value is left alone: %s\n",
+                                late == before ? "SUCCESS" : "FAILURE" );
+    if ( late != before ) {
+        result = PWR_RET_FAILURE;
+    }
+
+    rc = PWR_CntxtDestroy( cntxt );
+    printf( "\tPWR_CntxtDestroy - context of a remote entry point: %s\n",
+                                                            RESULT( rc ) );
+
+    // the context's channel closing ends the router
+    pthread_join( thread, NULL );
+    delete rtr.chan;
+    close( rtr.listenFd );
+    pthread_mutex_destroy( &rtr.lock );
+    pthread_cond_destroy( &rtr.cond );
+
+    return result ? PWR_RET_FAILURE : rc;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "behavior.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define INNER   "behavior.inner"
+#define OUTER   "behavior.outer"
+
+static int expect( const char* what, int rc, int want )
+{
+    printf( "\t%s: %s\n", what, rc == want ? "SUCCESS" : "FAILURE" );
+    if ( rc != want ) {
+        printf( "\t\tError: returned %d not %d\n", rc, want );
+        return PWR_RET_FAILURE;
+    }
+    return PWR_RET_SUCCESS;
+}
+
+static int report( const char* name, PWR_AttrStat stat, double* value,
+                                                    PWR_TimePeriod* tp )
+{
+    return PWR_GetReportByID( NULL, name, PWR_ID_RUN, PWR_ATTR_NOT_SPECIFIED,
+                                                    stat, value, tp );
+}
+
+int region_test( void )
+{
+    int rc, i;
+    double min, max, avg, sum, outer, joules;
+    PWR_TimePeriod tp, otp;
+
+    rc = PWR_RegionEnd( INNER );
+    if ( expect( "PWR_RegionEnd - nothing begun", rc, PWR_RET_INVALID ) ) {
+        return PWR_RET_FAILURE;
+    }
+
+    rc = PWR_RegionBegin( OUTER );
+    if ( expect( "PWR_RegionBegin - outer", rc, PWR_RET_SUCCESS ) ) {
+        return PWR_RET_FAILURE;
+    }
+
+    /* regions nest, only the innermost can end */
+    for ( i = 0; i < 3; i++ ) {
+        PWR_RegionBegin( INNER );
+        usleep( 10000 * ( i + 1 ) );
+        if ( 0 == i ) {
+            rc = PWR_RegionEnd( OUTER );
+            if ( expect( "PWR_RegionEnd - outer with inner open", rc,
+                                                    PWR_RET_INVALID ) ) {
+                return PWR_RET_FAILURE;
+            }
+        }
+        rc = PWR_RegionEnd( INNER );
+        if ( expect( "PWR_RegionEnd - inner", rc, PWR_RET_SUCCESS ) ) {
+            return PWR_RET_FAILURE;
+        }
+    }
+
+    rc = PWR_RegionEnd( OUTER );
+    if ( expect( "PWR_RegionEnd - outer", rc, PWR_RET_SUCCESS ) ) {
+        return PWR_RET_FAILURE;
+    }
+
+    rc = report( "behavior.none", PWR_ATTR_STAT_AVG, &avg, &tp );
+    if ( expect( "PWR_GetReportByID - a region never run", rc,
+                                                    PWR_RET_EMPTY ) ) {
+        return PWR_RET_FAILURE;
+    }
+
+    /* the inner instances took about 10, 20 and 30 milliseconds */
+    rc = report( INNER, PWR_ATTR_STAT_MIN, &min, &tp );
+    rc |= report( INNER, PWR_ATTR_STAT_MAX, &max, &tp );
+    rc |= report( INNER, PWR_ATTR_STAT_AVG, &avg, &tp );
+    rc |= report( INNER, PWR_ATTR_STAT_SUM, &sum, &tp );
+    printf( "\tPWR_GetReportByID - inner seconds: %s\n", RESULT( rc ) );
+    if ( rc != PWR_RET_SUCCESS ) {
+        return PWR_RET_FAILURE;
+    }
+    if ( min < 0.01 || max < 0.03 || min > avg || avg > max ||
+                    sum < 0.06 || sum < 3 * avg - 1e-9 || sum > 3 * avg + 1e-9 ) {
+        printf( "\t\tError: min=%f max=%f avg=%f sum=%f\n", min, max, avg, sum );
+        return PWR_RET_FAILURE;
+    }
+
+    /* the outer instance holds the inner ones, in time and in its period */
+    rc = report( OUTER, PWR_ATTR_STAT_SUM, &outer, &otp );
+    printf( "\tPWR_GetReportByID - outer seconds: %s\n", RESULT( rc ) );
+    if ( rc != PWR_RET_SUCCESS ) {
+        return PWR_RET_FAILURE;
+    }
+    if ( outer < sum || otp.start > tp.start || otp.stop < tp.stop ||
+                                                    tp.start > tp.stop ) {
+        printf( "\t\tError: outer %f seconds doesn't hold inner %f\n",
+                                                            outer, sum );
+        return PWR_RET_FAILURE;
+    }
+
+    /* without the package counters there is only time */
+    rc = PWR_GetReportByID( NULL, INNER, PWR_ID_RUN, PWR_ATTR_ENERGY,
+                                    PWR_ATTR_STAT_SUM, &joules, &tp );
+    printf( "\tPWR_GetReportByID - inner energy: %s\n",
+            rc == PWR_RET_SUCCESS ? "SUCCESS" :
+            rc == PWR_RET_NO_ATTRIB ? "NOT AVAILABLE" : "FAILURE" );
+    if ( rc != PWR_RET_SUCCESS && rc != PWR_RET_NO_ATTRIB &&
+                                                rc != PWR_RET_EMPTY ) {
+        return PWR_RET_FAILURE;
+    }
+    if ( rc == PWR_RET_SUCCESS && joules < 0 ) {
+        printf( "\t\tError: %f joules\n", joules );
+        return PWR_RET_FAILURE;
+    }
+
+    return PWR_RET_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "sampleCache.h"
+#include "behavior.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace PWR_Server;
+
+#define SEC 1000000000LL
+
+static uint64_t bits( double value )
+{
+    uint64_t tmp;
+    memcpy( &tmp, &value, sizeof(tmp) );
+    return tmp;
+}
+
+static double number( uint64_t value )
+{
+    double tmp;
+    memcpy( &tmp, &value, sizeof(tmp) );
+    return tmp;
+}
+
+static int checkStat( const char* what, bool rc, double value, double want )
+{
+    bool ok = rc && value == want;
+    printf( "\t%s: %s\n", what, ok ? "SUCCESS" : "FAILURE" );
+    if ( ! ok ) {
+        printf( "\t\tError: %s %f, wanted %f\n", rc ? "got" : "no answer,",
+                                                        value, want );
+        return PWR_RET_FAILURE;
+    }
+    return PWR_RET_SUCCESS;
+}
+
+// samples are given to the cache with times we choose, 100ms apart with
+// 20 kept, so the rollups of a second, a minute and an hour are all kept
+int rollup_test( void )
+{
+    int rc, result = PWR_RET_SUCCESS;
+    PWR_Cntxt cntxt;
+    PWR_Obj obj;
+    std::vector<PWR_Obj> roots;
+    std::vector<PWR_AttrName> attrs( 1, PWR_ATTR_POWER );
+    PWR_Time start, instant;
+    double value;
+    uint64_t buf[3600];
+
+    rc = PWR_CntxtInit( PWR_CNTXT_DEFAULT, PWR_ROLE_APP, "Application", &cntxt );
+    printf( "\tPWR_CntxtInit - application context: %s\n", RESULT( rc ) );
+    if( rc < PWR_RET_SUCCESS ) {
+        return rc;
+    }
+    rc = PWR_CntxtGetObjByName( cntxt, "plat.cab0.node0.core0", &obj );
+    if( rc < PWR_RET_SUCCESS ) {
+        printf( "\t\tError: no core to sample\n" );
+        return rc;
+    }
+    roots.push_back( obj );
+
+    {
+        // three seconds of samples valued 0 to 29, the first of each
+        // second on its boundary, only the last two seconds are kept raw
+        SampleCache cache( cntxt, roots, attrs, SEC / 10, 20, "", false );
+        const PWR_Time t0 = 1000 * SEC;
+        for ( int k = 0; k < 30; k++ ) {
+            cache.add( obj, PWR_ATTR_POWER, t0 + k * SEC / 10, 0, bits( k ) );
+        }
+
+        rc = cache.getSamples( obj, PWR_ATTR_POWER, &start, 1.0, 3, buf );
+        rc = rc && start == t0 + 9 * SEC / 10 && number( buf[0] ) == 4.5 &&
+                number( buf[1] ) == 14.5 && number( buf[2] ) == 24.5;
+        printf( "\tgetSamples - the second buckets' averages: %s\n",
+                                        rc ? "SUCCESS" : "FAILURE" );
+        if ( ! rc ) {
+            result = PWR_RET_FAILURE;
+        }
+
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MIN, 1.0, 3,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - min over the seconds", rc, value, 0 );
+        if ( rc && instant != start ) {
+            printf( "\t\tError: the min is before the window\n" );
+            result = PWR_RET_FAILURE;
+        }
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MAX, 1.0, 3,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - max over the seconds", rc, value, 29 );
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_AVG, 1.0, 3,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - avg over the seconds", rc, value,
+                                                                14.5 );
+
+        // finer than any bucket and longer than the raw history
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MAX, 0.1, 25,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - a window longer than the samples",
+                                                        rc, value, 29 );
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MIN, 0.1, 25,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - its min from the oldest second",
+                                                        rc, value, 0 );
+        rc = cache.getSamples( obj, PWR_ATTR_POWER, &start, 0.1, 25, buf );
+        printf( "\tgetSamples - the same window isn't made up: %s\n",
+                                        rc ? "FAILURE" : "SUCCESS" );
+        if ( rc ) {
+            result = PWR_RET_FAILURE;
+        }
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MAX, 0.1, 15,
+                                            &start, &value, &instant );
+        printf( "\tgetStat - the samples answer what they cover: %s\n",
+                                        rc ? "FAILURE" : "SUCCESS" );
+        if ( rc ) {
+            result = PWR_RET_FAILURE;
+        }
+    }
+
+    {
+        // a sample a second for longer than the ring of seconds holds,
+        // the oldest 100 seconds only the minutes remember
+        SampleCache cache( cntxt, roots, attrs, SEC / 10, 20, "", false );
+        const PWR_Time t1 = 7200 * SEC;
+        for ( int s = 0; s < 3700; s++ ) {
+            cache.add( obj, PWR_ATTR_POWER, t1 + s * SEC, 0, bits( s ) );
+        }
+
+        rc = cache.getSamples( obj, PWR_ATTR_POWER, &start, 1.0, 3600, buf );
+        rc = rc && number( buf[0] ) == 100 && number( buf[3599] ) == 3699;
+        printf( "\tgetSamples - the seconds after the ring wraps: %s\n",
+                                        rc ? "SUCCESS" : "FAILURE" );
+        if ( ! rc ) {
+            result = PWR_RET_FAILURE;
+        }
+        rc = cache.getSamples( obj, PWR_ATTR_POWER, &start, 1.0, 3601, buf );
+        printf( "\tgetSamples - a second more than the ring: %s\n",
+                                        rc ? "FAILURE" : "SUCCESS" );
+        if ( rc ) {
+            result = PWR_RET_FAILURE;
+        }
+
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MIN, 1.0, 3600,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - min of the seconds kept", rc, value,
+                                                                100 );
+        rc = cache.getStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MIN, 1.0, 3601,
+                                            &start, &value, &instant );
+        result |= checkStat( "getStat - min of the minutes past them", rc,
+                                                        value, 60 );
+    }
+
+    rc = PWR_CntxtDestroy( cntxt );
+    printf( "\tPWR_CntxtDestroy - application context: %s\n", RESULT( rc ) );
+
+    return result ? PWR_RET_FAILURE : rc;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "pwrshm.h"
+#include "shmTable.h"
+#include "behavior.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+using namespace PWR_Server;
+
+#define WRITES 200000
+
+// every write is a value and a time that go together, a reader that
+// sees one without the other has read half a write, both sides yield
+// now and then so they interleave on one cpu too
+static void* writer( void* arg )
+{
+    ShmTable* table = (ShmTable*) arg;
+    for ( uint64_t i = 1; i <= WRITES; i++ ) {
+        table->write( 1, i, i * 1000, i * 1000 + 1 );
+        if ( 0 == i % 64 ) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int shm_table_test( void )
+{
+    char name[64];
+    std::vector<ShmTable::Info> info( 2 );
+    PWR_ShmTable* reader;
+    ShmTable* table;
+    const char* obj;
+    PWR_AttrName attr;
+    uint64_t value, prev = 0;
+    PWR_Time ts;
+    pthread_t thread;
+    pid_t pid;
+    int rc, torn = 0, reads = 0;
+
+    snprintf( name, sizeof(name), "/pwrapi.behavior.%d", getpid() );
+    info[0].obj = "plat.node0";
+    info[0].attr = PWR_ATTR_ENERGY;
+    info[1].obj = "plat.node0";
+    info[1].attr = PWR_ATTR_POWER;
+
+    table = ShmTable::create( name, 100000000, info );
+    printf( "\tShmTable::create: %s\n", table ? "SUCCESS" : "FAILURE" );
+    if ( ! table ) {
+        return PWR_RET_FAILURE;
+    }
+
+    // we are running, a second server can't take the name
+    ShmTable* other = ShmTable::create( name, 100000000, info );
+    printf( "\tShmTable::create - a name in use is refused: %s\n",
+                                other ? "FAILURE" : "SUCCESS" );
+    if ( other ) {
+        return PWR_RET_FAILURE;
+    }
+
+    reader = PWR_ShmOpen( name );
+    printf( "\tPWR_ShmOpen: %s\n", reader ? "SUCCESS" : "FAILURE" );
+    if ( ! reader ) {
+        delete table;
+        return PWR_RET_FAILURE;
+    }
+
+    rc = PWR_ShmGetNumEntries( reader ) == 2 &&
+        1 == PWR_ShmFind( reader, "plat.node0", PWR_ATTR_POWER ) &&
+        -1 == PWR_ShmFind( reader, "plat.node1", PWR_ATTR_POWER ) &&
+        PWR_RET_SUCCESS == PWR_ShmGetEntryInfo( reader, 0, &obj, &attr ) &&
+        0 == strcmp( obj, "plat.node0" ) && PWR_ATTR_ENERGY == attr &&
+        PWR_RET_BAD_INDEX == PWR_ShmGetEntryInfo( reader, 2, &obj, &attr );
+    printf( "\tPWR_ShmFind - the entries: %s\n", rc ? "SUCCESS" : "FAILURE" );
+    if ( ! rc ) {
+        goto fail;
+    }
+
+    rc = PWR_ShmRead( reader, 0, &value, &ts );
+    printf( "\tPWR_ShmRead - not sampled yet: %s\n",
+                    PWR_RET_EMPTY == rc ? "SUCCESS" : "FAILURE" );
+    if ( PWR_RET_EMPTY != rc ) {
+        goto fail;
+    }
+
+    // reads while the entry is written are whole and in order
+    pthread_create( &thread, NULL, writer, table );
+    while ( prev < WRITES ) {
+        rc = PWR_ShmRead( reader, 1, &value, &ts );
+        if ( PWR_RET_EMPTY == rc ) {
+            continue;
+        }
+        ++reads;
+        if ( PWR_RET_SUCCESS != rc || ts != (PWR_Time)( value * 1000 ) ||
+                                                        value < prev ) {
+            ++torn;
+            break;
+        }
+        prev = value;
+        if ( 0 == reads % 64 ) {
+            sched_yield();
+        }
+    }
+    pthread_join( thread, NULL );
+    printf( "\tPWR_ShmRead - %d reads during %d writes: %s\n", reads, WRITES,
+                                        torn ? "FAILURE" : "SUCCESS" );
+    if ( torn ) {
+        printf( "\t\tError: read %lu at %lu\n", (unsigned long) value,
+                                                    (unsigned long) ts );
+        goto fail;
+    }
+
+    PWR_ShmClose( reader );
+    delete table;
+
+    // the table goes with its server
+    reader = PWR_ShmOpen( name );
+    printf( "\tPWR_ShmOpen - after the server is gone: %s\n",
+                                reader ? "FAILURE" : "SUCCESS" );
+    if ( reader ) {
+        PWR_ShmClose( reader );
+        return PWR_RET_FAILURE;
+    }
+
+    // one left by a server that died is taken over
+    pid = fork();
+    if ( 0 == pid ) {
+        _exit( ShmTable::create( name, 100000000, info ) ? 0 : 1 );
+    }
+    waitpid( pid, &rc, 0 );
+    table = ShmTable::create( name, 100000000, info );
+    printf( "	ShmTable::create - a dead server's name is taken over: %s\n",
+                                table ? "SUCCESS" : "FAILURE" );
+    if ( ! table ) {
+        shm_unlink( name );
+        return PWR_RET_FAILURE;
+    }
+    reader = PWR_ShmOpen( name );
+    rc = reader && PWR_RET_EMPTY == PWR_ShmRead( reader, 0, &value, &ts );
+    printf( "	PWR_ShmRead - of a taken over table, not sampled yet: %s\n",
+                                rc ? "SUCCESS" : "FAILURE" );
+    if ( reader ) {
+        PWR_ShmClose( reader );
+    }
+    delete table;
+    return rc ? PWR_RET_SUCCESS : PWR_RET_FAILURE;
+
+  fail:
+    PWR_ShmClose( reader );
+    delete table;
+    return PWR_RET_FAILURE;
+}
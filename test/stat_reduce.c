@@ -0,0 +1,167 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "behavior.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+static PWR_Time getTime( void )
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000;
+}
+
+static void uninit( PWR_TimePeriod* tp )
+{
+    tp->start = tp->stop = tp->instant = PWR_TIME_UNINIT;
+}
+
+/* a MIN or MAX is one member's value and says which, an AVG is of them
+ * all and doesn't, the samples change from call to call so the values
+ * themselves can't be compared between calls
+ */
+static int checkReduce( const char* what, int rc, PWR_AttrStat op, int index,
+                    int numObjs, PWR_TimePeriod* tp )
+{
+    printf( "\t%s: %s\n", what, RESULT( rc ) );
+    if ( rc != PWR_RET_SUCCESS ) {
+        return rc;
+    }
+    if ( op == PWR_ATTR_STAT_AVG ) {
+        if ( -1 != index ) {
+            printf( "\t\tError: an average has index %d\n", index );
+            return PWR_RET_FAILURE;
+        }
+    } else if ( index < 0 || index >= numObjs ) {
+        printf( "\t\tError: index %d isn't a member\n", index );
+        return PWR_RET_FAILURE;
+    }
+    if ( tp->start > tp->stop ) {
+        printf( "\t\tError: the period ends before it starts\n" );
+        return PWR_RET_FAILURE;
+    }
+    return PWR_RET_SUCCESS;
+}
+
+int stat_reduce_test( void )
+{
+    int rc, i, n, index;
+    PWR_Cntxt cntxt;
+    PWR_Obj self, obj;
+    PWR_Grp grp;
+    PWR_Stat stat;
+    double val;
+    PWR_TimePeriod tp, window;
+    PWR_AttrStat ops[] = { PWR_ATTR_STAT_MIN, PWR_ATTR_STAT_MAX,
+                                                    PWR_ATTR_STAT_AVG };
+
+    rc = PWR_CntxtInit( PWR_CNTXT_DEFAULT, PWR_ROLE_APP, "Application", &cntxt );
+    printf( "\tPWR_CntxtInit - application context: %s\n", RESULT( rc ) );
+    if( rc < PWR_RET_SUCCESS ) {
+        printf( "\t\tError: initialization of PowerAPI context failed\n" );
+        return rc;
+    }
+
+    rc = PWR_CntxtGetEntryPoint( cntxt, &self );
+    if( rc < PWR_RET_SUCCESS ) {
+        printf( "\t\tError: getting self from PowerAPI context failed\n" );
+        return rc;
+    }
+
+    rc = PWR_ObjGetChildren( self, &grp );
+    n = PWR_GrpGetNumObjs( grp );
+    printf( "\tPWR_ObjGetChildren - %d children: %s\n", n, RESULT( rc ) );
+    if( rc < PWR_RET_SUCCESS || n < 2 ) {
+        printf( "\t\tError: the entry point needs children to reduce\n" );
+        return PWR_RET_FAILURE;
+    }
+
+    rc = PWR_GrpCreateStat( grp, PWR_ATTR_POWER, PWR_ATTR_STAT_AVG, &stat );
+    printf( "\tPWR_GrpCreateStat - PWR_ATTR_STAT_AVG of PWR_ATTR_POWER: %s\n",
+                                                            RESULT( rc ) );
+    if( rc < PWR_RET_SUCCESS ) {
+        return rc;
+    }
+    PWR_StatStart( stat );
+    sleep( 1 );
+    PWR_StatStop( stat );
+
+    for ( i = 0; i < 3; i++ ) {
+        char what[80];
+        uninit( &tp );
+        rc = PWR_StatGetReduce( stat, ops[i], &index, &val, &tp );
+        snprintf( what, sizeof(what), "PWR_StatGetReduce - %s",
+                    ops[i] == PWR_ATTR_STAT_MIN ? "PWR_ATTR_STAT_MIN" :
+                    ops[i] == PWR_ATTR_STAT_MAX ? "PWR_ATTR_STAT_MAX" :
+                    "PWR_ATTR_STAT_AVG" );
+        rc = checkReduce( what, rc, ops[i], index, n, &tp );
+        if ( rc != PWR_RET_SUCCESS ) {
+            return rc;
+        }
+    }
+
+    /* no reduction for the rest */
+    uninit( &tp );
+    rc = PWR_StatGetReduce( stat, PWR_ATTR_STAT_STDEV, &index, &val, &tp );
+    printf( "\tPWR_StatGetReduce - PWR_ATTR_STAT_STDEV is refused: %s\n",
+                        rc == PWR_RET_FAILURE ? "SUCCESS" : "FAILURE" );
+    if ( rc != PWR_RET_FAILURE ) {
+        return PWR_RET_FAILURE;
+    }
+
+    PWR_StatDestroy( stat );
+
+    window.stop = getTime();
+    window.start = window.stop - 500000000;
+    window.instant = PWR_TIME_UNINIT;
+    for ( i = 0; i < 3; i++ ) {
+        char what[80];
+        rc = PWR_GrpGetReduce( grp, PWR_ATTR_POWER, PWR_ATTR_STAT_AVG,
+                                    ops[i], window, &index, &val, &tp );
+        snprintf( what, sizeof(what), "PWR_GrpGetReduce - %s",
+                    ops[i] == PWR_ATTR_STAT_MIN ? "PWR_ATTR_STAT_MIN" :
+                    ops[i] == PWR_ATTR_STAT_MAX ? "PWR_ATTR_STAT_MAX" :
+                    "PWR_ATTR_STAT_AVG" );
+        rc = checkReduce( what, rc, ops[i], index, n, &tp );
+        if ( rc != PWR_RET_SUCCESS ) {
+            return rc;
+        }
+    }
+
+    /* an object's stat is its own reduction */
+    PWR_GrpGetObjByIndx( grp, 0, &obj );
+    rc = PWR_ObjCreateStat( obj, PWR_ATTR_POWER, PWR_ATTR_STAT_MAX, &stat );
+    if ( rc < PWR_RET_SUCCESS ) {
+        return rc;
+    }
+    PWR_StatStart( stat );
+    usleep( 300000 );
+    PWR_StatStop( stat );
+    uninit( &tp );
+    rc = PWR_StatGetReduce( stat, PWR_ATTR_STAT_MAX, &index, &val, &tp );
+    rc = checkReduce( "PWR_StatGetReduce - of an object", rc,
+                                        PWR_ATTR_STAT_MAX, index, 1, &tp );
+    PWR_StatDestroy( stat );
+    if ( rc != PWR_RET_SUCCESS ) {
+        return rc;
+    }
+
+    rc = PWR_CntxtDestroy( cntxt );
+    printf( "\tPWR_CntxtDestroy - application context: %s\n", RESULT( rc ) );
+
+    return rc;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include "pwr.h"
+#include "tsFile.h"
+#include "behavior.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace PowerAPI;
+
+struct Series {
+    std::vector<PWR_Time> time;
+    std::vector<double> value;
+};
+
+typedef std::map< std::pair<std::string,PWR_AttrName>, Series > Samples;
+
+// the bits, a NaN has to come back as one and -0.0 as -0.0
+static bool same( double a, double b )
+{
+    return 0 == memcmp( &a, &b, sizeof(a) );
+}
+
+// what is written, irregular times, repeated and negative values and a
+// gap, over enough points for several blocks
+static void fill( Samples& samples )
+{
+    PWR_Time time = 1500000000000000000LL;
+    double energy = 1000.0;
+
+    srand( 1 );
+    for ( int i = 0; i < 1000; i++ ) {
+        time += 100000000 + rand() % 1000;
+        energy += 10.0 + (double) rand() / RAND_MAX;
+
+        Series& e = samples[ std::make_pair( std::string( "plat.node0" ),
+                                            PWR_ATTR_ENERGY ) ];
+        e.time.push_back( time );
+        e.value.push_back( energy );
+
+        Series& p = samples[ std::make_pair( std::string( "plat.node1" ),
+                                            PWR_ATTR_POWER ) ];
+        p.time.push_back( time + 7 );
+        if ( 500 == i ) {
+            p.value.push_back( NAN );
+        } else if ( i % 10 < 5 ) {
+            p.value.push_back( 100.0 );
+        } else if ( 999 == i ) {
+            p.value.push_back( -0.0 );
+        } else {
+            p.value.push_back( -1.0 * rand() / 3.0 );
+        }
+    }
+}
+
+int ts_file_test( void )
+{
+    char path[] = "/tmp/pwrtsXXXXXX";
+    Samples written, read;
+    int fd, blocks = 0;
+    FILE* fp;
+
+    fd = mkstemp( path );
+    if ( fd < 0 || ! ( fp = fdopen( fd, "w" ) ) ) {
+        printf( "\t\tError: can't create `%s`\n", path );
+        return PWR_RET_FAILURE;
+    }
+
+    fill( written );
+    {
+        TsWriter writer( fp, 300 );
+        Samples::iterator iter;
+        for ( unsigned i = 0; i < 1000; i++ ) {
+            for ( iter = written.begin(); iter != written.end(); ++iter ) {
+                writer.add( iter->first.first, iter->first.second,
+                        iter->second.time[i], iter->second.value[i] );
+            }
+        }
+    }
+    fclose( fp );
+
+    TsReader reader;
+    if ( ! reader.open( path ) ) {
+        printf( "\tTsReader::open: FAILURE\n" );
+        unlink( path );
+        return PWR_RET_FAILURE;
+    }
+    printf( "\tTsReader::open: SUCCESS\n" );
+
+    PWR_Time last = 0;
+    while ( reader.nextBlock() ) {
+        ++blocks;
+        if ( reader.firstTime() > reader.lastTime() ||
+                                    reader.firstTime() < last ) {
+            printf( "\t\tError: block %d time range is out of order\n",
+                                                                blocks );
+            unlink( path );
+            return PWR_RET_FAILURE;
+        }
+        last = reader.lastTime();
+
+        for ( size_t i = 0; i < reader.numSeries(); i++ ) {
+            std::vector<PWR_Time> time;
+            std::vector<double> value;
+            reader.read( i, time, value );
+            if ( time.size() != reader.count( i ) ||
+                                    value.size() != reader.count( i ) ) {
+                printf( "\t\tError: `%s` count doesn't match its index\n",
+                                            reader.object( i ).c_str() );
+                unlink( path );
+                return PWR_RET_FAILURE;
+            }
+            Series& s = read[ std::make_pair( reader.object( i ),
+                                                    reader.attr( i ) ) ];
+            for ( size_t j = 0; j < time.size(); j++ ) {
+                if ( time[j] < reader.firstTime() ||
+                                        time[j] > reader.lastTime() ) {
+                    printf( "\t\tError: a time is outside its block\n" );
+                    unlink( path );
+                    return PWR_RET_FAILURE;
+                }
+            }
+            s.time.insert( s.time.end(), time.begin(), time.end() );
+            s.value.insert( s.value.end(), value.begin(), value.end() );
+        }
+    }
+    unlink( path );
+
+    printf( "\tTsWriter - %d blocks of at most 300 points: %s\n", blocks,
+                        blocks > 1 ? "SUCCESS" : "FAILURE" );
+    if ( blocks < 2 ) {
+        return PWR_RET_FAILURE;
+    }
+
+    if ( read.size() != written.size() ) {
+        printf( "\t\tError: %zu series written, %zu read\n",
+                                    written.size(), read.size() );
+        return PWR_RET_FAILURE;
+    }
+
+    Samples::iterator iter;
+    for ( iter = written.begin(); iter != written.end(); ++iter ) {
+        Series& w = iter->second;
+        Series& r = read[ iter->first ];
+        if ( w.time != r.time ) {
+            printf( "\t\tError: `%s` times differ\n",
+                                        iter->first.first.c_str() );
+            return PWR_RET_FAILURE;
+        }
+        for ( size_t j = 0; j < w.value.size(); j++ ) {
+            if ( ! same( w.value[j], r.value[j] ) ) {
+                printf( "\t\tError: `%s` value %zu is %.17g not %.17g\n",
+                    iter->first.first.c_str(), j, r.value[j], w.value[j] );
+                return PWR_RET_FAILURE;
+            }
+        }
+    }
+    printf( "\tTsReader::read - times and values round trip: SUCCESS\n" );
+
+    return PWR_RET_SUCCESS;
+}
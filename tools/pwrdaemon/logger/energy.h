@@ -8,13 +8,35 @@
 namespace PWR_Logger {
 class Energy : public Work {
   public:
-    Energy( PWR_Cntxt ctx, std::string name ) {
+    Energy( PWR_Cntxt ctx, std::string name ) : 
+		m_ctx( ctx ), m_last( 0 ), m_ended( false ) {
         PWR_CntxtGetObjByName( ctx, name.c_str(), &m_obj );
         assert( PWR_NULL != m_obj );
     }
     int work( FILE* );
   private:
+	static void pushed( void* data, void* vals, PWR_Time ts[] ) {
+		Energy* self = static_cast<Energy*>(data);
+		if ( NULL == vals ) {
+			fprintf(self->m_fp,"ERROR: the subscription has no source left\n");
+			fflush(self->m_fp);
+			self->m_ended = true;
+			return;
+		}
+		double value = *(double*)vals;
+		if ( 0 != self->m_last ) {
+        	fprintf(self->m_fp,"Logger: %.2f Joules, time %lf seconds\n",
+						value - self->m_last, (double)ts[0]/1000000000.0);
+        	fflush(self->m_fp);
+		}
+		self->m_last = value;
+	}
+
+	PWR_Cntxt	m_ctx;
 	PWR_Obj 	m_obj;
+	FILE*		m_fp;
+	double		m_last;
+	bool		m_ended;
 };
 
 int Energy::work( FILE* fp )
@@ -25,6 +47,15 @@ int Energy::work( FILE* fp )
 
     fprintf(fp,"Logger: objName=\'%s\' attr=%s\n", objName, attrName );
 
+	// a remote object is pushed to us instead of being polled
+	m_fp = fp;
+	PWR_AttrName attr = PWR_ATTR_ENERGY;
+	if ( PWR_ObjAttrSubscribe( m_obj, 1, &attr, 1000000000, pushed, this ) ) {
+		while ( ! m_ended && 
+				PWR_RET_SUCCESS == PWR_CntxtMakeProgress( m_ctx ) );
+		return -1;
+	}
+
 	double startValue = 0;
     while( 1 ) {
         double value = 0;
@@ -0,0 +1,424 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <util.h>
+#include "engine.h"
+#include "debug.h"
+
+using namespace PWR_Logger;
+
+// SIGTERM or SIGINT stops the scheduler, which hands it to the writer
+// to finish the file, then the signal is raised again
+static volatile sig_atomic_t _stop = 0;
+static pthread_t _scheduler;
+
+static void sighandler( int sig )
+{
+	if ( ! _stop ) {
+		_stop = sig;
+	}
+	// wake the scheduler from its sleep
+	if ( ! pthread_equal( pthread_self(), _scheduler ) ) {
+		pthread_kill( _scheduler, sig );
+	}
+}
+
+static PWR_Time now( clockid_t clock )
+{
+	struct timespec ts;
+	clock_gettime( clock, &ts );
+	return (PWR_Time) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+Engine::Queue::Queue() : m_head( 0 ), m_tail( 0 )
+{
+	sem_init( &m_sem, 0, 0 );
+}
+
+bool Engine::Queue::push( Record* rec )
+{
+	unsigned tail = m_tail;
+	if ( tail - m_head == SIZE ) {
+		return false;
+	}
+	m_ring[ tail % SIZE ] = rec;
+	// the record is visible before the consumer sees the new tail
+	__sync_synchronize();
+	m_tail = tail + 1;
+	sem_post( &m_sem );
+	return true;
+}
+
+Engine::Record* Engine::Queue::pop()
+{
+	while ( 0 != sem_wait( &m_sem ) ) {
+		assert( EINTR == errno );
+	}
+	unsigned head = m_head;
+	assert( head != m_tail );
+	Record* rec = m_ring[ head % SIZE ];
+	__sync_synchronize();
+	m_head = head + 1;
+	return rec;
+}
+
+Engine::Engine( PWR_Cntxt ctx, std::string config, bool binary ) :
+	m_ctx( ctx ), m_fp( NULL ), m_binary( binary ), m_ts( NULL ), 
+	m_missed( 0 ), m_dropped( 0 )
+{
+	std::ifstream file( config.c_str() );
+	if ( ! file.is_open() ) {
+		printf("ERROR: could not open %s\n", config.c_str() );
+		exit(-1);
+	}
+
+	std::string line;
+	while ( std::getline( file, line ) ) {
+		size_t pos = line.find( '#' );
+		if ( std::string::npos != pos ) {
+			line.erase( pos );
+		}
+		std::istringstream in( line );
+		std::string object, attrs;
+		unsigned period;
+		if ( ! ( in >> object ) ) {
+			continue;
+		}
+		if ( ! ( in >> attrs >> period ) || 0 == period ) {
+			printf("ERROR: bad target `%s`\n", line.c_str() );
+			exit(-1);
+		}
+		double tolerance = 0;
+		unsigned maxPeriod = 0;
+		if ( in >> tolerance ) {
+			if ( ! ( in >> maxPeriod ) ) {
+				maxPeriod = period * 32;
+			}
+			if ( tolerance <= 0 || maxPeriod < period ) {
+				printf("ERROR: bad target `%s`\n", line.c_str() );
+				exit(-1);
+			}
+		}
+		addTarget( object, attrs, (PWR_Time) period * 1000000, tolerance,
+						(PWR_Time) maxPeriod * 1000000 );
+	}
+	assert( ! m_batches.empty() );
+}
+
+void Engine::addTarget( std::string object, std::string list, PWR_Time period,
+						double tolerance, PWR_Time maxPeriod )
+{
+	std::vector<PWR_AttrName> attrs;
+	while ( ! list.empty() ) {
+		size_t pos = list.find_first_of( ',' );
+		std::string name = list.substr( 0, pos );
+		list = std::string::npos == pos ? "" : list.substr( pos + 1 );
+
+		int attr;
+		for ( attr = 0; attr < PWR_NUM_ATTR_NAMES; attr++ ) {
+			if ( 0 == strcasecmp( name.c_str(), 
+					PWR_AttrGetTypeString( (PWR_AttrName) attr ) ) ) {
+				break;
+			}
+		}
+		if ( PWR_NUM_ATTR_NAMES == attr ) {
+			printf("ERROR: unknown attribute `%s`\n", name.c_str() );
+			exit(-1);
+		}
+		attrs.push_back( (PWR_AttrName) attr );
+	}
+
+	std::vector<PWR_Obj> objs;
+	if ( 0 == object.compare( 0, 5, "TYPE:" ) ) {
+		PWR_Grp grp;
+		PWR_ObjType type = objStringToType( object.substr(5).c_str() );
+		if ( PWR_RET_SUCCESS != PWR_CntxtGetGrpByType( m_ctx, type, &grp ) ) {
+			printf("ERROR: no objects of `%s`\n", object.c_str() );
+			exit(-1);
+		}
+		for ( int i = 0; i < PWR_GrpGetNumObjs( grp ); i++ ) {
+			PWR_Obj obj;
+			PWR_GrpGetObjByIndx( grp, i, &obj );
+			objs.push_back( obj );
+		}
+	} else {
+		PWR_Obj obj;
+		PWR_CntxtGetObjByName( m_ctx, object.c_str(), &obj );
+		if ( PWR_NULL == obj ) {
+			printf("ERROR: unknown object `%s`\n", object.c_str() );
+			exit(-1);
+		}
+		objs.push_back( obj );
+	}
+
+	Batch* batch = findBatch( attrs, period, tolerance, maxPeriod );
+	for ( size_t i = 0; i < objs.size(); i++ ) {
+		char name[100];
+		PWR_ObjGetName( objs[i], name, 100 );
+		PWR_GrpAddObj( batch->grp, objs[i] );
+		batch->names.push_back( name );
+	}
+	DBGX("`%s` period=%" PRIu64 " batch objects=%zu\n", object.c_str(), 
+									period, batch->names.size() );
+}
+
+// every target of the same attributes and period is read together
+Engine::Batch* Engine::findBatch( std::vector<PWR_AttrName>& attrs, 
+				PWR_Time period, double tolerance, PWR_Time maxPeriod )
+{
+	for ( size_t i = 0; i < m_batches.size(); i++ ) {
+		Batch* batch = m_batches[i];
+		if ( batch->period == period && batch->attrs == attrs &&
+				batch->tolerance == tolerance &&
+				batch->maxPeriod == maxPeriod ) {
+			return batch;
+		}
+	}
+
+	Batch* batch = new Batch;
+	batch->period = period;
+	batch->next = 0;
+	batch->tolerance = tolerance;
+	batch->maxPeriod = maxPeriod;
+	batch->interval = period;
+	batch->attrs = attrs;
+	PWR_GrpCreate( m_ctx, &batch->grp );
+	m_batches.push_back( batch );
+	return batch;
+}
+
+int Engine::work( FILE* fp )
+{
+	m_fp = fp;
+	if ( m_binary ) {
+		// blocks of 10 seconds so the file can be read while we log
+		m_ts = new PowerAPI::TsWriter( fp, 65536, 10 * 1000000000LL );
+	}
+	int rc = pthread_create( &m_writer, NULL, writer, this );
+	assert( 0 == rc );
+
+	_scheduler = pthread_self();
+	struct sigaction act;
+	memset( &act, 0, sizeof(act) );
+	act.sa_handler = sighandler;
+	sigaction( SIGTERM, &act, NULL );
+	sigaction( SIGINT, &act, NULL );
+
+	// the batches with the same period are read together 
+	PWR_Time start = now( CLOCK_MONOTONIC );
+	for ( size_t i = 0; i < m_batches.size(); i++ ) {
+		m_batches[i]->next = start;
+	}
+
+	while ( ! _stop ) {
+		Batch* batch = m_batches[0];
+		for ( size_t i = 1; i < m_batches.size(); i++ ) {
+			if ( m_batches[i]->next < batch->next ) {
+				batch = m_batches[i];
+			}
+		}
+
+		struct timespec deadline;
+		deadline.tv_sec = batch->next / 1000000000;
+		deadline.tv_nsec = batch->next % 1000000000;
+		while ( EINTR == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME,
+									&deadline, NULL ) && ! _stop );
+		if ( _stop ) {
+			break;
+		}
+
+		sample( *batch );
+
+		batch->next += batch->interval;
+		PWR_Time time = now( CLOCK_MONOTONIC );
+		if ( batch->next <= time ) {
+			PWR_Time behind = ( time - batch->next ) / batch->interval + 1;
+			batch->next += behind * batch->interval;
+			m_missed += behind;
+		}
+	}
+
+	// the writer stops at the NULL, behind everything already queued
+	while ( ! m_queue.push( NULL ) ) {
+		usleep( 1000 );
+	}
+	pthread_join( m_writer, NULL );
+
+	signal( _stop, SIG_DFL );
+	raise( _stop );
+	return 0;
+}
+
+void Engine::sample( Batch& batch )
+{
+	Record* rec = new Record;
+	rec->time = now( CLOCK_REALTIME );
+	rec->batch = &batch;
+	rec->missed = m_missed;
+	rec->dropped = m_dropped;
+	rec->value.resize( batch.names.size() * batch.attrs.size() );
+	std::vector<PWR_Time> ts( rec->value.size() );
+
+	PWR_Status status;
+	PWR_StatusCreate( m_ctx, &status );
+	rec->retval = PWR_GrpAttrGetValues( batch.grp, batch.attrs.size(),
+				&batch.attrs[0], &rec->value[0], &ts[0], status );
+	PWR_StatusDestroy( status );
+
+	if ( batch.tolerance > 0 && ! adapt( batch, rec ) ) {
+		delete rec;
+		return;
+	}
+
+	if ( ! m_queue.push( rec ) ) {
+		++m_dropped;
+		delete rec;
+	}
+}
+
+// false if none of the values need writing
+bool Engine::adapt( Batch& batch, Record* rec )
+{
+	if ( PWR_RET_SUCCESS != rec->retval ) {
+		batch.interval = batch.period;
+		return true;
+	}
+
+	if ( batch.last.empty() ) {
+		batch.last.resize( rec->value.size() );
+		batch.lastTime.resize( rec->value.size(), 0 );
+	}
+	rec->changed.resize( rec->value.size() );
+
+	bool changed = false;
+	for ( size_t i = 0; i < rec->value.size(); i++ ) {
+		double diff = rec->value[i] - batch.last[i];
+		rec->changed[i] = 0 == batch.lastTime[i] || 
+				diff > batch.tolerance || -diff > batch.tolerance;
+		changed |= rec->changed[i];
+	}
+
+	// back off while it is quiet, catch up as soon as it isn't
+	if ( changed ) {
+		batch.interval = batch.period;
+	} else if ( batch.interval < batch.maxPeriod ) {
+		batch.interval = std::min( batch.interval * 2, batch.maxPeriod );
+	}
+	DBGX("changed=%d interval=%" PRIu64 "\n", changed, batch.interval );
+
+	// and a value that would go longer than the longest period by the 
+	// next read is written now
+	bool write = false;
+	for ( size_t i = 0; i < rec->value.size(); i++ ) {
+		if ( rec->time + batch.interval - batch.lastTime[i] > 
+													batch.maxPeriod ) {
+			rec->changed[i] = true;
+		}
+		if ( rec->changed[i] ) {
+			batch.last[i] = rec->value[i];
+			batch.lastTime[i] = rec->time;
+			write = true;
+		}
+	}
+
+	return write;
+}
+
+void* Engine::writer( void* obj )
+{
+	static_cast<Engine*>(obj)->write();
+	return NULL;
+}
+
+void Engine::write()
+{
+	unsigned missed = 0;
+	unsigned dropped = 0;
+
+	while ( 1 ) {
+		Record* rec = m_queue.pop();
+		if ( NULL == rec ) {
+			break;
+		}
+		Batch& batch = *rec->batch;
+		double time = (double) rec->time / 1000000000.0;
+
+		// a read that failed is a gap, a NaN for each of its values
+		if ( m_ts ) {
+			bool ok = PWR_RET_SUCCESS == rec->retval;
+			for ( size_t i = 0; i < batch.names.size(); i++ ) {
+				for ( size_t j = 0; j < batch.attrs.size(); j++ ) {
+					size_t k = i * batch.attrs.size() + j;
+					if ( ok && ! rec->changed.empty() && ! rec->changed[k] ) {
+						continue;
+					}
+					m_ts->add( batch.names[i], batch.attrs[j], rec->time,
+										ok ? rec->value[k] : NAN );
+				}
+			}
+			delete rec;
+			continue;
+		}
+
+		if ( PWR_RET_SUCCESS != rec->retval ) {
+			fprintf( m_fp, "Logger: %lf ERROR: get failed, retval=%d\n",
+											time, rec->retval );
+		} else {
+			for ( size_t i = 0; i < batch.names.size(); i++ ) {
+				for ( size_t j = 0; j < batch.attrs.size(); j++ ) {
+					size_t k = i * batch.attrs.size() + j;
+					if ( rec->changed.empty() ) {
+						fprintf( m_fp, "Logger: %lf '%s' %s %f\n", time, 
+							batch.names[i].c_str(), 
+							PWR_AttrGetTypeString( batch.attrs[j] ),
+							rec->value[k] );
+					} else if ( rec->changed[k] ) {
+						fprintf( m_fp, "Logger: %lf '%s' %s %f +-%g\n", 
+							time, batch.names[i].c_str(), 
+							PWR_AttrGetTypeString( batch.attrs[j] ),
+							rec->value[k], batch.tolerance );
+					}
+				}
+			}
+		}
+		if ( rec->missed != missed || rec->dropped != dropped ) {
+			missed = rec->missed;
+			dropped = rec->dropped;
+			fprintf( m_fp, "Logger: %lf missed %u deadlines, dropped %u "
+								"records\n", time, missed, dropped );
+		}
+		delete rec;
+
+		// only when we have caught up
+		if ( m_queue.empty() ) {
+			fflush( m_fp );
+		}
+	}
+
+	if ( m_ts ) {
+		m_ts->flush();
+	}
+	fflush( m_fp );
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _ENGINE_H
+#define _ENGINE_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <string>
+#include <vector>
+#include <tsFile.h>
+#include "work.h"
+
+namespace PWR_Logger {
+
+// Logs the targets of a config file, one per line
+//
+//   # object or TYPE:type, attributes, period in milliseconds and
+//   # optionally a tolerance and the longest period in milliseconds
+//   plat.cab0.board0.node0  power,energy  100
+//   TYPE:Node               power         1000
+//   TYPE:Node               power         100   0.5  3200
+//
+// A target with a tolerance is sampled adaptively. A value is written 
+// only when it is more than the tolerance from the last one written 
+// for it, or the longest period has passed since, and the line ends 
+// with +-tolerance; holding each value until the next one gives every
+// value read to within the tolerance. The period doubles, up to the 
+// longest, while a read writes nothing and goes back to the shortest 
+// when one writes something.
+//
+// Targets with the same attributes and period are read with one group
+// get, all of their attributes at once. The reads are made on absolute
+// deadlines so the period doesn't drift, a read that overruns skips the
+// deadlines it missed. The lines are written by a thread of their own, 
+// as text or, if binary, in the compressed format of tsFile.h with a 
+// failed read as NaN values. On SIGTERM or SIGINT what is queued is 
+// written out, the last block too, before the signal is let through.
+class Engine : public Work {
+  public:
+	Engine( PWR_Cntxt, std::string config, bool binary = false );
+	int work( FILE* );
+
+  private:
+	struct Batch {
+		PWR_Time					period;
+		PWR_Time					next;
+		// adaptive if there is a tolerance
+		double						tolerance;
+		PWR_Time					maxPeriod;
+		PWR_Time					interval;
+		std::vector<double>			last;
+		std::vector<PWR_Time>		lastTime;
+		std::vector<PWR_AttrName>	attrs;
+		PWR_Grp						grp;
+		std::vector<std::string>	names;
+	};
+
+	struct Record {
+		PWR_Time				time;
+		Batch*					batch;
+		int						retval;
+		// so far, reported by the writer
+		unsigned				missed;
+		unsigned				dropped;
+		std::vector<double>		value;
+		// which values to write if adaptive
+		std::vector<bool>		changed;
+	};
+
+	// one producer, the scheduler, and one consumer, the writer 
+	class Queue {
+	  public:
+		Queue();
+		// false if it is full
+		bool push( Record* );
+		// waits for one
+		Record* pop();
+		bool empty() { return m_head == m_tail; }
+	  private:
+		enum { SIZE = 4096 };
+		Record*				m_ring[SIZE];
+		volatile unsigned	m_head;
+		volatile unsigned	m_tail;
+		sem_t				m_sem;
+	};
+
+	void addTarget( std::string object, std::string attrs, PWR_Time period,
+					double tolerance, PWR_Time maxPeriod );
+	Batch* findBatch( std::vector<PWR_AttrName>&, PWR_Time period, 
+									double tolerance, PWR_Time maxPeriod );
+	void sample( Batch& );
+	bool adapt( Batch&, Record* );
+	static void* writer( void* );
+	void write();
+
+	PWR_Cntxt				m_ctx;
+	std::vector<Batch*>		m_batches;
+	Queue					m_queue;
+	FILE*					m_fp;
+	bool					m_binary;
+	PowerAPI::TsWriter*		m_ts;
+	pthread_t				m_writer;
+	unsigned				m_missed;
+	unsigned				m_dropped;
+};
+
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "mult.h"
 #include "setMult.h"
 #include "stat.h"
+#include "engine.h"
 
 using namespace PWR_Logger;
 
@@ -66,7 +67,10 @@ Logger::Logger( int argc, char* argv[] ) :
         }
     }
 
-	if ( 0 == m_args.attr.compare(0,5,"STAT:") ) {
+	if ( ! m_args.config.empty() ) {
+		m_work = new Engine( m_ctx, m_args.config, 
+								0 == m_args.format.compare("ts") );
+	} else if ( 0 == m_args.attr.compare(0,5,"STAT:") ) {
 		m_work = new Stat( m_ctx, m_args.objectName, m_args.attr.substr(5) );
 	} else if ( 0 == m_args.attr.compare(0,8,"SETMULT:") ) {
 		m_work = new SetMult( m_ctx, m_args.objectName, m_args.attr.substr(8) );
@@ -117,7 +121,7 @@ static void initArgs( int argc, char* argv[], Args* args )
     enum { RTR_PORT, RTR_HOST,
             PWRAPI_CONFIG, PWRAPI_ROOT,
             PWRAPI_SERVER, PWRAPI_SERVER_PORT, NAME,
-			OBJECT, ATTR, LOGFILE, COUNT, DELAY  };
+			OBJECT, ATTR, LOGFILE, COUNT, DELAY, CONFIG, FORMAT  };
     static struct option long_options[] = {
         {"object"           , required_argument, NULL, OBJECT },
         {"attr"             , required_argument, NULL, ATTR },
@@ -125,6 +129,8 @@ static void initArgs( int argc, char* argv[], Args* args )
         {"name"             , required_argument, NULL, NAME },
         {"count"            , required_argument, NULL, COUNT },
         {"delay"            , required_argument, NULL, DELAY },
+        {"config"           , required_argument, NULL, CONFIG },
+        {"format"           , required_argument, NULL, FORMAT },
         {"pwrApiConfig"     , required_argument, NULL, PWRAPI_CONFIG },
         {"pwrApiRoot"       , required_argument, NULL, PWRAPI_ROOT },
         {"pwrApiServer"     , required_argument, NULL, PWRAPI_SERVER },
@@ -154,6 +160,14 @@ static void initArgs( int argc, char* argv[], Args* args )
           case DELAY:
             args->delay = optarg;
             break;
+          case CONFIG:
+            // a list of targets, see engine.h
+            args->config = optarg;
+            break;
+          case FORMAT:
+            // text or ts, only for a config
+            args->format = optarg;
+            break;
           case PWRAPI_CONFIG:
             args->pwrApiConfig = optarg;
             break;
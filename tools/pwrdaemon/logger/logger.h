@@ -32,6 +32,8 @@ struct Args {
     std::string count;
     std::string delay;
     std::string attr;
+    std::string config;
+    std::string format;
 };
 
 class Work;
@@ -8,14 +8,30 @@
 namespace PWR_Logger {
 class Power : public Work {
   public:
-	Power( PWR_Cntxt ctx, std::string name ) {
+	Power( PWR_Cntxt ctx, std::string name ) : m_ctx( ctx ), m_ended( false ) {
     	PWR_CntxtGetObjByName( ctx, name.c_str(), &m_obj );
     	assert( PWR_NULL != m_obj );
 	}
     int work( FILE* );
 
   private:
+	static void pushed( void* data, void* vals, PWR_Time ts[] ) {
+		Power* self = static_cast<Power*>(data);
+		if ( NULL == vals ) {
+			fprintf(self->m_fp,"ERROR: the subscription has no source left\n");
+			fflush(self->m_fp);
+			self->m_ended = true;
+			return;
+		}
+        fprintf(self->m_fp,"Logger: %.2f Watts, time %lf seconds\n", 
+						*(double*)vals, (double)ts[0]/1000000000.0);
+        fflush(self->m_fp);
+	}
+
+	PWR_Cntxt	m_ctx;
 	PWR_Obj 	m_obj;
+	FILE*		m_fp;
+	bool		m_ended;
 };
 
 int Power::work( FILE* fp )
@@ -26,6 +42,15 @@ int Power::work( FILE* fp )
 
     fprintf(fp,"Logger: objName=\'%s\' attr=%s\n", objName, attrName );
 
+	// a remote object is pushed to us instead of being polled
+	m_fp = fp;
+	PWR_AttrName attr = PWR_ATTR_POWER;
+	if ( PWR_ObjAttrSubscribe( m_obj, 1, &attr, 1000000000, pushed, this ) ) {
+		while ( ! m_ended && 
+				PWR_RET_SUCCESS == PWR_CntxtMakeProgress( m_ctx ) );
+		return -1;
+	}
+
     while( 1 ) {
         double value = 0;
         PWR_Time ts;
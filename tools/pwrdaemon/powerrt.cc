@@ -1,45 +1,48 @@
-#include <Python.h>
 #include <sys/wait.h>
 #include <assert.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <signal.h>
+#include <unistd.h>
 #include <sys/utsname.h>
 
 #include <string>
 #include <vector>
 #include <sstream>
-#include <iomanip>
 #include <set>
+#include <algorithm>
 
 #include <mpi.h>
 
+#include "powerrtProfile.h"
+
 static int _debug = 0;
 
 struct Data 
 {
-	Data() : client(-1), daemon(-1) {} 
-	pid_t client;	
+	Data() : daemon(-1) {} 
 	pid_t daemon;	
-	std::string routeFile;
 };
 
 Data* __data = NULL;
 
+static volatile sig_atomic_t _ready = 0;
+
 static void sighandler( int sig )
 {
-	if ( _debug ) {
-		printf("PWRRT: got signale=%d\n",sig);
+	if ( SIGUSR1 == sig ) {
+		_ready = 1;
 	}
 }
 
-static std::string createNidList( int& numNodes, int& myNid ); 
+static std::vector<std::string> createNidMap( int& myNid ); 
 static Data* runtimeInit( int *argc, char ***argv, 
-				const std::string& nidList, int numNodes, int myNid );
+				const std::vector<std::string>& nidMap, int myNid );
 
 int MPI_Init( int *argc, char ***argv )
 {
-	int numNodes; 
 	int myNid;
 
 	if ( getenv( "POWERRT_DEBUG" ) ) {
@@ -50,28 +53,166 @@ int MPI_Init( int *argc, char ***argv )
 		return mpi_retval;
 	}
 
-	std::string nidList = createNidList( numNodes, myNid );
+	std::vector<std::string> nidMap = createNidMap( myNid );
 
 	if ( _debug ) {
-		printf("PWRRT: numNodes=%d myNid=%d nidlist `%s`\n",
-						numNodes,myNid,nidList.c_str());
+		printf("PWRRT: numNodes=%zu myNid=%d\n", nidMap.size(), myNid );
 	}
 
-	if ( ! nidList.empty() ) {
-		__data = runtimeInit( argc, argv, nidList, numNodes, myNid );
+	// a profile can be taken without the daemons
+	bool profile = profileInit();
+	if ( ! nidMap.empty() && ( ! profile || getenv("POWERRT_DAEMON") ) ) {
+		__data = runtimeInit( argc, argv, nidMap, myNid );
 	}
 
 	return mpi_retval;
 }
 
+// The daemons are laid out as examples/config/daemon.py lays them out, 
+// a board's nodes each have a server for the node, the first node of a 
+// board a server for the board and a router for the board's servers, and 
+// the last node of the first board the router at the root of the tree.
+struct Layout {
+	int nodesPerBoard;
+	int boardsPerCab;
+	int numNodes;
+	int rootRtr;
+};
+
+static std::string boardRoot( const Layout& l, int node )
+{
+	std::ostringstream ret;
+	ret << "plat.cab" << node / ( l.nodesPerBoard * l.boardsPerCab ) <<
+			".board" << ( node / l.nodesPerBoard ) % l.boardsPerCab;
+	return ret.str();
+}
+
+static std::string nodeRoot( const Layout& l, int node )
+{
+	std::ostringstream ret;
+	ret << boardRoot( l, node ) << ".node" << node % l.nodesPerBoard;
+	return ret.str();
+}
+
+// every router reads the whole table, an object and the router and 
+// server it is on
+static std::string createRouteTable( const Layout& l )
+{
+	std::ostringstream ret;
+	for ( int node = 0; node < l.numNodes; node += l.nodesPerBoard ) {
+		int board = node / l.nodesPerBoard;
+		ret << boardRoot( l, node ) << ":" << board << ":0\n";
+		for ( int j = 0; j < l.nodesPerBoard && node + j < l.numNodes; j++ ) {
+			ret << nodeRoot( l, node + j ) << ":" << board << ":" 
+											<< j + 1 << "\n";
+		}
+	}
+	return ret.str();
+}
+
+static void addArg( std::vector<std::string>& args, const std::string& name,
+											const std::string& value )
+{
+	args.push_back( "--" + name + "=" + value );
+}
+
+template < class T >
+static std::string str( T value )
+{
+	std::ostringstream ret;
+	ret << value;
+	return ret.str();
+}
+
+static std::vector<std::string> createDaemonArgs( const Layout& l, 
+		const std::vector<std::string>& nidMap, int myNode, 
+		const std::string& config, const std::string& routeTable )
+{
+	std::vector<std::string> args;
+	const std::string& boardHost = 
+				nidMap[ myNode / l.nodesPerBoard * l.nodesPerBoard ];
+
+	if ( myNode == l.rootRtr || 0 == myNode % l.nodesPerBoard ) {
+		addArg( args, "rtr.routerType", "tree" );
+		addArg( args, "rtr.clientPort", "15000" );
+		addArg( args, "rtr.serverPort", "15001" );
+
+		if ( myNode == l.rootRtr ) {
+			int numLinks = ( l.numNodes + l.nodesPerBoard - 1 ) / 
+												l.nodesPerBoard;
+			int rtrID = l.numNodes / l.nodesPerBoard;
+			if ( l.numNodes > 1 && l.numNodes % l.nodesPerBoard ) {
+				++rtrID;
+			}
+			addArg( args, "rtr.routerId", str( rtrID ) );
+			for ( int i = 0; l.numNodes > 1 && i < numLinks; i++ ) {
+				addArg( args, "rtr.routerInfo", str( i ) + ":" + 
+						str( 16000 + i ) + ":" + nidMap[ i * l.nodesPerBoard ]
+						+ ":16000:" + str( i ) + ":" + str( i ) );
+			}
+		} else {
+			int rtrID = myNode / l.nodesPerBoard;
+			addArg( args, "rtr.routerId", str( rtrID ) );
+			addArg( args, "rtr.routerInfo", "0:16000:" + 
+						nidMap[ l.rootRtr ] + ":" + str( 16000 + rtrID ) );
+		}
+		addArg( args, "rtr.routeTable", routeTable );
+	}
+
+	addArg( args, "srvr.name", "srvr" );
+	addArg( args, "srvr.rtrHost", boardHost );
+	addArg( args, "srvr.rtrPort", "15001" );
+	addArg( args, "srvr.pwrApiConfig", config );
+	addArg( args, "srvr.pwrApiRoot", nodeRoot( l, myNode ) );
+
+	if ( 0 == myNode % l.nodesPerBoard ) {
+		addArg( args, "srvr0.name", "srv0" );
+		addArg( args, "srvr0.rtrHost", boardHost );
+		addArg( args, "srvr0.rtrPort", "15001" );
+		addArg( args, "srvr0.pwrApiConfig", config );
+		addArg( args, "srvr0.pwrApiRoot", boardRoot( l, myNode ) );
+		addArg( args, "srvr0.pwrApiServer", boardHost );
+		addArg( args, "srvr0.pwrApiServerPort", "15000" );
+	}
+
+	// the logger is at the root
+	if ( myNode == l.rootRtr ) {
+		const char* object = getenv("POWERRT_OBJECT");
+		const char* attr = getenv("POWERRT_ATTR");
+		const char* logFile = getenv("POWERRT_LOGFILE");
+
+		addArg( args, "lgr.name", "lgr" );
+		addArg( args, "lgr.pwrApiServer", nidMap[ myNode ] );
+		addArg( args, "lgr.pwrApiServerPort", "15000" );
+		addArg( args, "lgr.pwrApiConfig", config );
+		addArg( args, "lgr.pwrApiRoot", "plat" );
+		addArg( args, "lgr.object", object ? object : "plat" );
+		addArg( args, "lgr.count", "0" );
+		addArg( args, "lgr.delay", "0" );
+		if ( attr && *attr ) {
+			addArg( args, "lgr.attr", attr );
+		}
+		if ( logFile && *logFile ) {
+			addArg( args, "lgr.logfile", logFile );
+		}
+	}
+	return args;
+}
+
+static int envInt( const char* name, int value )
+{
+	const char* env = getenv( name );
+	return env ? atoi( env ) : value;
+}
+
 Data* runtimeInit( int *argc, char ***argv, 
-			const std::string& nidList, int numNodes, int myNid )
+			const std::vector<std::string>& nidMap, int myNid )
 {
     int my_rank;
-	int numRanks;
 	int rc;
 
 	struct sigaction act;
+	memset( &act, 0, sizeof(act) );
 	act.sa_handler = sighandler;
 	rc = sigaction( SIGUSR1, &act, NULL );
 	assert( 0 == rc );
@@ -81,212 +222,136 @@ Data* runtimeInit( int *argc, char ***argv,
     rc =  MPI_Comm_rank( MPI_COMM_WORLD,&my_rank);
 	assert( MPI_SUCCESS == rc );
 
-    rc =  MPI_Comm_size( MPI_COMM_WORLD,&numRanks);
-	assert( MPI_SUCCESS == rc );
-
-	std::stringstream ret;
-	ret << numNodes;
-	setenv( "POWERRT_NUMNODES", &ret.str().c_str()[0], 1 );
-
- 	assert( ! __data );
-	Data* data = new Data;
-
-	char* tmp = getenv("POWERRT_SCRIPT");
-	if ( ! tmp ) {
-		printf("ERROR: POWER_SCRIPT is not set\n");
+	Layout layout;
+	layout.numNodes = nidMap.size();
+	layout.nodesPerBoard = envInt( "POWERRT_NODES_PER_BOARD", 1 );
+	layout.boardsPerCab = envInt( "POWERRT_BOARDS_PER_CAB", 1 );
+	if ( layout.nodesPerBoard < 1 || layout.boardsPerCab < 1 ) {
+		printf("ERROR: bad POWERRT_NODES_PER_BOARD or POWERRT_BOARDS_PER_CAB\n");
 		exit(-1);
 	}
-	assert(tmp);
-	std::string file(tmp);
-
-    size_t pos = file.find_last_of('/');
-
-    std::string path;
-    std::string moduleName = file;
-    if ( std::string::npos != pos ) {
-        path = file.substr( 0, pos );
-        moduleName = file.substr( pos + 1 );
-
-        setenv( "PYTHONPATH", path.c_str(), 1 );
-    }
-
-    moduleName = moduleName.substr(0, moduleName.find_last_of('.' ) );
-
-	if ( _debug && 0 == my_rank ) {
-    	printf( "PWRRT: path=`%s` module=`%s`\n", path.c_str(),
-											moduleName.c_str() );
-	}
-
-	Py_Initialize();
-
-	PyObject* module = PyImport_ImportModule( moduleName.c_str() ) ;
-	if ( ! module ) {
-		fprintf(stderr, "ERROR: PyImport_ImportModule( `%s` ) failed\n",
-											moduleName.c_str());
-		exit(1);
-	}
+	layout.rootRtr = std::min( layout.nodesPerBoard, layout.numNodes ) - 1;
 
-    PyObject* pFunc = PyObject_GetAttrString( module, "GetApps" );
-    assert(pFunc);
+	// the python config the daemons read still wants these
+	setenv( "POWERRT_NUMNODES", str( layout.numNodes ).c_str(), 1 );
+	setenv( "POWERRT_NODES_PER_BOARD", str( layout.nodesPerBoard ).c_str(), 1 );
+	setenv( "POWERRT_BOARDS_PER_CAB", str( layout.boardsPerCab ).c_str(), 1 );
+	setenv( "POWERRT_SIGNAL", "yes", 1 );
 
-    PyObject* pArgs = PyTuple_New( 9 );
-    assert(pArgs);
-
-	std::stringstream routeFile;
-	// create a unique name for the route file
-	routeFile << "routeTable." << getpid() << "." << myNid;
+ 	assert( ! __data );
+	Data* data = new Data;
 
 	char* config = getenv("POWERAPI_CONFIG"); 
 	if ( ! config ) {
 		printf("ERROR: POWERAPI_CONFIG is not set\n");
 		exit(-1);
 	} 
-	data->routeFile = routeFile.str();
-    PyTuple_SetItem( pArgs, 0, PyInt_FromLong( myNid ) );
-    PyTuple_SetItem( pArgs, 1, PyString_FromString( config ) );
-    PyTuple_SetItem( pArgs, 2, PyString_FromString( nidList.c_str() ) );
-    PyTuple_SetItem( pArgs, 3, PyString_FromString( routeFile.str().c_str() ) );
-
-	std::string object = "plat";
-	if ( getenv("POWERRT_OBJECT") ) { 
-		object = getenv("POWERRT_OBJECT");
-	}
-
-	std::string attr = "";
-	if ( getenv("POWERRT_ATTR") ) { 
-		attr = getenv("POWERRT_ATTR");
-	}
-
-	std::string logFile = "";
-	if ( getenv("POWERRT_LOGFILE") ) { 
-		logFile = getenv("POWERRT_LOGFILE");
-	}
 
 	if ( ! getenv("POWERRT_DAEMON") ) { 
 		printf("ERROR: POWERRT_DAEMON is not set\n");
 		exit(-1);
 	}
-
 	std::string daemon = getenv("POWERRT_DAEMON");
 
-	std::string client = "";
 	if ( getenv("POWERRT_CLIENT") ) { 
-		client = getenv("POWERRT_CLIENT");
+		printf("WARNING: POWERRT_CLIENT is not supported, ignored\n");
 	}
 
-    PyTuple_SetItem( pArgs, 4, PyString_FromString( object.c_str() ) );
-    PyTuple_SetItem( pArgs, 5, PyString_FromString( attr.c_str() ) );
-    PyTuple_SetItem( pArgs, 6, PyString_FromString( logFile.c_str() ) );
-    PyTuple_SetItem( pArgs, 7, PyString_FromString( daemon.c_str() ) );
-    PyTuple_SetItem( pArgs, 8, PyString_FromString( client.c_str() ) );
-
-    PyObject* pRetval = PyObject_CallObject( pFunc, pArgs );
-    assert(pRetval);
-
-    for ( int i=0; i < PyList_Size( pRetval); i++ ) {
-
-        PyObject* pyTmp = PyList_GetItem(pRetval,i);
-        PyObject* pyArgs = PyList_GetItem(pyTmp,0);
-        PyObject* pyEnv = PyList_GetItem(pyTmp,1);
-
-		if ( _debug ) {
-			printf("PWRRT: %d ",i); 
-			PyObject_Print( pyArgs, stdout, Py_PRINT_RAW ); 
-			printf("\n");
-			if ( pyEnv ) {
-				printf("PWRRT: %d ",i); 
-				PyObject_Print( pyEnv, stdout, Py_PRINT_RAW );
-				printf("\n");
-			}
-		}
-
-		std::vector<char*> argv;
-		std::vector<std::string> args;
-		for ( int j=0; j < PyList_Size( pyArgs ); j++ ) {
-			std::string str =PyString_AsString( PyList_GetItem( pyArgs, j ) );
-        	args.push_back( str );
-		}
+	// the router reads its table from a pipe rather than a file
+	int fds[2] = { -1, -1 };
+	std::string routeTable;
+	bool isRtr = myNid == layout.rootRtr || 0 == myNid % layout.nodesPerBoard;
+	if ( isRtr ) {
+		rc = pipe( fds );
+		assert( 0 == rc );
+		routeTable = createRouteTable( layout );
+	}
 
-		for ( unsigned int j=0; j < args.size(); j++ ) {
-        	argv.push_back( &args[j][0] );
-		}
-       	argv.push_back( 0 );
+	std::vector<std::string> args = createDaemonArgs( layout, nidMap, myNid,
+						config, "/dev/fd/" + str( fds[0] ) );
+	args.insert( args.begin(), daemon );
 
-		std::vector<char*> envp;
-		std::vector<std::string> envs;
+	std::vector<char*> argv2;
+	for ( unsigned int j=0; j < args.size(); j++ ) {
+       	argv2.push_back( &args[j][0] );
+	}
+   	argv2.push_back( 0 );
 
-		if ( pyEnv ) {
-			for ( int j=0; j < PyList_Size( pyEnv ); j++ ) {
-				std::string str =PyString_AsString( PyList_GetItem( pyEnv, j ) );
-        		envs.push_back( str );
-			}
+	if ( _debug ) {
+		printf("PWRRT: rank=%d launch\n",my_rank);
+		for ( unsigned j = 0; j < args.size(); j++ ) {
+			printf("PWRRT:    %s\n",argv2[j] );
 		}
+	}
 
-		for ( unsigned int j=0; j < envs.size(); j++ ) {
-        	envp.push_back( &envs[j][0] );
+	int child;
+	if ( ( child = fork() ) ) {
+		data->daemon = child;
+	} else if ( 0 == child )  {
+		if ( isRtr ) {
+			close( fds[1] );
 		}
-       	envp.push_back( 0 );
-
-		if ( _debug ) {
-			printf("PWRRT: rank=%d launch\n",my_rank);
-			for ( unsigned j = 0; j < argv.size(); j++ ) {
-				printf("PWRRT:    %s\n",argv[j] );
-			}
+		int rc = execv( argv2[0], &argv2[0] );
+		if ( -1 == rc ) {
+			fprintf(stderr,"execv '%s' failed %s\n",
+								argv2[0],strerror(errno));
+			exit(-1);
 		}
+	} else {
+		assert(0);
+	}
 
-		int child;
-		if ( ( child = fork() ) ) {
-			if ( i == 0 ) {
-				data->daemon = child;
-			} else if ( i == 1 ) {
-				data->client = child;
-			} else {
-				assert(0);
+	// a daemon that died before reading its table would have SIGPIPE kill
+	// the rank, we find out it is gone below instead
+	if ( isRtr ) {
+		close( fds[0] );
+		struct sigaction ign, old;
+		memset( &ign, 0, sizeof(ign) );
+		ign.sa_handler = SIG_IGN;
+		sigaction( SIGPIPE, &ign, &old );
+		size_t pos = 0;
+		while ( pos < routeTable.size() ) {
+			ssize_t n = write( fds[1], routeTable.c_str() + pos, 
+											routeTable.size() - pos );
+			if ( n < 0 && EINTR == errno ) {
+				continue;
 			}
-		} else if ( 0 == child )  {
-			int rc = execve( argv[0], &argv[0], &envp[0] );
-			if ( -1 == rc ) {
-				fprintf(stderr,"execve '%s' failed %s\n",
-									argv[0],strerror(errno));
-				exit(-1);
+			if ( n <= 0 ) {
+				fprintf(stderr,"ERROR: route table to daemon `%s` %s\n",
+						daemon.c_str(), n < 0 ? strerror(errno) : "failed" );
+				break;
 			}
-		} else {
-			assert(0);
+			pos += n;
 		}
-		if (_debug ) printf("PWRRT: wait for child\n");
-		pause();
-		if (_debug ) printf("PWRRT: child is ready\n");
-
-#if 0
-		// this is causing a failure for some reason
-		// it's a small memory leak
-        Py_DECREF( pyTmp );
-        Py_DECREF( pyArgs );
-        Py_DECREF( pyEnv );
-#endif
-    }
-    Py_DECREF(pArgs);
-    Py_DECREF(pFunc);
-    Py_DECREF(pRetval);
+		close( fds[1] );
+		sigaction( SIGPIPE, &old, NULL );
+	}
+
+	// the signal can come before we would pause for it, or to another 
+	// of our threads, so we look for it
+	if (_debug ) printf("PWRRT: wait for child\n");
+	while ( ! _ready ) {
+		if ( waitpid( child, NULL, WNOHANG ) == child ) {
+			fprintf(stderr,"ERROR: daemon `%s` exited\n", daemon.c_str() );
+			data->daemon = -1;
+			break;
+		}
+		usleep( 1000 );
+	}
+	if (_debug ) printf("PWRRT: child is ready\n");
+
 	return data; 
 }
 
 int MPI_Finalize()
 {
+	profileFini();
+
+	// every rank is through with the daemons once this returns
+	int retval = PMPI_Finalize();
+
 	Data* data = __data;
-	
 	if ( data ) {
-
-		unlink( data->routeFile.c_str() );
-	
-		if ( data->client > -1 ) {
-			if ( _debug ) {
-				printf("PWRRT: kill client %d\n", data->client);
-			}
-			kill( data->client, SIGKILL );
-			waitpid( data->client,NULL, 0  );
-		}
-		MPI_Barrier( MPI_COMM_WORLD );
 		if ( data->daemon > -1 ) {
 			if ( _debug ) {
 				printf("PWRRT: kill daemon %d\n", data->daemon);
@@ -295,14 +360,15 @@ int MPI_Finalize()
 			waitpid( data->daemon,NULL, 0  );
 		}
 		delete data;
-	} else {
-		MPI_Barrier( MPI_COMM_WORLD );
+		__data = NULL;
 	}
 
-	return PMPI_Finalize();
+	return retval;
 }
 
-static std::string createNidList(  int& numNodes, int& myNid )
+// The host names of the nodes in the order their first rank has, empty 
+// if we aren't the first rank on our node, the one that starts its daemon
+static std::vector<std::string> createNidMap( int& myNid )
 {
 	int rc;
 	int my_rank;
@@ -314,92 +380,60 @@ static std::string createNidList(  int& numNodes, int& myNid )
     rc =  MPI_Comm_size( MPI_COMM_WORLD,&numRanks);
 	assert( MPI_SUCCESS == rc );
 
-	struct utsname buf;
-	rc = uname( &buf );
-	assert( 0 == rc );
-	
 	std::string procName;
 	procName.resize(MPI_MAX_PROCESSOR_NAME);
 	int len;
 	MPI_Get_processor_name( &procName[0], &len );
 	procName.resize(len);
 
-	int pos = 0;
-	while ( ! isdigit( procName[pos] ) ) { ++pos; }
-
-	int nodeid = atoi( &procName[pos] );
 	if ( _debug ) {
-		printf("PWRRT: my_rank=%d procName=%s nodeid=%d\n",
-						my_rank, procName.c_str(), nodeid );
+		printf("PWRRT: my_rank=%d procName=%s\n", my_rank, procName.c_str() );
 	}
-	
-	std::vector<int> rbuf( numRanks );
 
-	rc = MPI_Allgather( &nodeid, 1, MPI_INT, &rbuf[0], 1, 
+	std::vector<int> lens( numRanks );
+	rc = PMPI_Allgather( &len, 1, MPI_INT, &lens[0], 1, 
 											MPI_INT, MPI_COMM_WORLD );
 	assert( MPI_SUCCESS == rc ); 
 
-	std::vector<int> rbuf2( numRanks );
-	int nameLen = procName.size();
-	rc = MPI_Allgather( &nameLen, 1, MPI_INT, &rbuf2[0], 1, 
-											MPI_INT, MPI_COMM_WORLD );
+	std::vector<int> displs( numRanks );
+	int total = 0;
+	for ( int i = 0; i < numRanks; i++ ) {
+		displs[i] = total;
+		total += lens[i];
+	}
+
+	std::vector<char> names( total + 1 );
+	rc = PMPI_Allgatherv( &procName[0], len, MPI_CHAR, &names[0], &lens[0],
+								&displs[0], MPI_CHAR, MPI_COMM_WORLD );
 	assert( MPI_SUCCESS == rc ); 
 
+	std::vector<std::string> nidMap;
+	std::set<std::string> nodes;
 	int launcherRank = -1; 
+	myNid = -1;
 	for ( int i = 0; i < numRanks; i++ ) {
-		if ( rbuf[i] == nodeid && launcherRank == -1 ) {
+		std::string name( &names[ displs[i] ], lens[i] );
+		if ( nodes.find( name ) != nodes.end() ) {
+			continue;
+		}
+		nodes.insert( name );
+		if ( name == procName ) {
 			launcherRank = i;
-			break;
+			myNid = nidMap.size();
 		}
-		if ( nameLen == procName.size() && rbuf2[i] != nameLen ) {
-			nameLen = rbuf2[i];
+		if ( _debug && 0 == my_rank ) {
+			printf("PWRRT: rank %d -> node %zu `%s`\n",i,nidMap.size(),
+												name.c_str());
 		}
+		nidMap.push_back( name );
 	}
 
-	std::stringstream ret;
-
 	if ( my_rank != launcherRank ) {
-		return ret.str();
+		return std::vector<std::string>();
 	} 
 
 	if ( _debug ) {
 		printf( "Rank %d is a launcher\n", my_rank );
 	}
-
-	std::string prefix=procName.substr(0,pos);
-
-	ret << std::setw(1) << prefix;
-	ret << std::setw(1) << "[";
-	
-	std::set< int > nodes;
-
-	numNodes = 0;
-	for ( unsigned i = 0; i < rbuf.size(); i++ ) {
-		if ( nodes.find( rbuf[i] ) == nodes.end() ) {
-			nodes.insert( rbuf[i] );
-
-			if ( rbuf[i] == nodeid ) {
-				myNid = numNodes; 
-			} 
-			++numNodes;
-			if ( _debug && 0 == my_rank ) {
-				printf("PWRRT: rank %d -> node %d\n",i,rbuf[i]);
-			}
-
-			if ( i > 0 ) {
-				ret << std::setw(1) << ","; 		
-			}
-
-			if ( nameLen == procName.size() ) {
-				ret << std::setw( procName.size() - pos) << 
-									std::setfill('0') << rbuf[i];
-			} else {
-				ret << rbuf[i];
-			}
-		}
-	}
-
-	ret << std::setw(1) << "]";
-
-	return ret.str();
+	return nidMap;
 }
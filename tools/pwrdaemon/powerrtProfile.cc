@@ -0,0 +1,612 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "localEnergy.h"
+#include "powerrtProfile.h"
+
+using namespace PowerAPI;
+
+enum Category { COMPUTE, P2P, COLLECTIVE, NUM_CATEGORIES };
+
+static const char* _categoryNames[] = { "compute", "p2p", "collective" };
+
+enum Fn {
+	SEND, RECV, SENDRECV, ISEND, IRECV, WAIT, WAITALL, WAITANY,
+	BARRIER, BCAST, REDUCE, ALLREDUCE, GATHER, GATHERV, SCATTER,
+	ALLGATHER, ALLGATHERV, ALLTOALL, ALLTOALLV, NUM_FNS
+};
+
+static const struct {
+	const char* name;
+	Category	category;
+} _fns[] = {
+	{ "MPI_Send", P2P },
+	{ "MPI_Recv", P2P },
+	{ "MPI_Sendrecv", P2P },
+	{ "MPI_Isend", P2P },
+	{ "MPI_Irecv", P2P },
+	{ "MPI_Wait", P2P },
+	{ "MPI_Waitall", P2P },
+	{ "MPI_Waitany", P2P },
+	{ "MPI_Barrier", COLLECTIVE },
+	{ "MPI_Bcast", COLLECTIVE },
+	{ "MPI_Reduce", COLLECTIVE },
+	{ "MPI_Allreduce", COLLECTIVE },
+	{ "MPI_Gather", COLLECTIVE },
+	{ "MPI_Gatherv", COLLECTIVE },
+	{ "MPI_Scatter", COLLECTIVE },
+	{ "MPI_Allgather", COLLECTIVE },
+	{ "MPI_Allgatherv", COLLECTIVE },
+	{ "MPI_Alltoall", COLLECTIVE },
+	{ "MPI_Alltoallv", COLLECTIVE },
+};
+
+// a call site, the return address of the wrapper and the function
+struct Site {
+	const void*	addr;
+	int			fn;
+	uint64_t	calls;
+	uint64_t	ns;
+	double		joules;
+	// the time in the current epoch, see Table
+	uint64_t	epochNs;
+};
+
+// Each thread adds to its own table, under a lock only the report
+// contends. Sites are found by open addressing in a fixed table, one that
+// can't be placed in a few probes goes to its function's "other" entry.
+//
+// A call only takes the time at both ends. The energy is read once an 
+// epoch, or once the sites of an epoch fill touched, and split among the
+// sites that ran in the epoch by their time.
+#define TABLE_SIZE 1024
+#define MAX_PROBES 8
+#define EPOCH_NS 1000000
+#define MAX_TOUCHED 64
+
+struct Table {
+	pthread_mutex_t	mutex;
+	Site		sites[TABLE_SIZE];
+	Site		other[NUM_FNS];
+	// the time between the calls
+	Site		compute;
+
+	bool		last;
+	uint64_t	lastNs;
+
+	uint64_t				epochStart;
+	bool					epochValid;
+	LocalEnergy::Sample		epochSample;
+	int						numTouched;
+	Site*					touched[MAX_TOUCHED];
+};
+
+static bool _profile = false;
+static LocalEnergy* _energy = NULL;
+static __thread Table* _table = NULL;
+static std::vector<Table*> _tables;
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline uint64_t now()
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static Table* getTable()
+{
+	if ( ! _table ) {
+		_table = (Table*) calloc( 1, sizeof(Table) );
+		assert( _table );
+		pthread_mutex_init( &_table->mutex, NULL );
+		_table->epochStart = now();
+		_table->epochValid = _energy && _energy->read( _table->epochSample );
+		pthread_mutex_lock( &_mutex );
+		_tables.push_back( _table );
+		pthread_mutex_unlock( &_mutex );
+	}
+	return _table;
+}
+
+static Site& findSite( Table* table, int fn, const void* addr )
+{
+	unsigned hash = ( (uintptr_t) addr >> 2 ) ^ ( fn * 0x9e3779b1 );
+	for ( int i = 0; i < MAX_PROBES; i++ ) {
+		Site& site = table->sites[ ( hash + i ) & ( TABLE_SIZE - 1 ) ];
+		if ( site.addr == addr && site.fn == fn ) {
+			return site;
+		}
+		if ( NULL == site.addr ) {
+			site.addr = addr;
+			site.fn = fn;
+			return site;
+		}
+	}
+	table->other[fn].fn = fn;
+	return table->other[fn];
+}
+
+// the energy since the epoch began, with the table locked, counts only if
+// both samples are of the same package, a thread that moved in between 
+// has time but no energy for the epoch
+static void endEpoch( Table* t, uint64_t ns )
+{
+	LocalEnergy::Sample sample;
+	bool valid = _energy->read( sample );
+	double joules = 0;
+	if ( valid && t->epochValid && sample.pkg == t->epochSample.pkg ) {
+		joules = _energy->joules( t->epochSample, sample );
+	}
+
+	uint64_t total = 0;
+	for ( int i = 0; i < t->numTouched; i++ ) {
+		total += t->touched[i]->epochNs;
+	}
+	for ( int i = 0; i < t->numTouched; i++ ) {
+		Site* site = t->touched[i];
+		site->joules += joules * site->epochNs / total;
+		site->epochNs = 0;
+	}
+	t->numTouched = 0;
+	t->epochStart = ns;
+	t->epochValid = valid;
+	t->epochSample = sample;
+}
+
+static inline void charge( Table* t, Site& site, uint64_t start, 
+												uint64_t stop )
+{
+	++site.calls;
+	site.ns += stop - start;
+	if ( ! _energy || stop == start ) {
+		return;
+	}
+	if ( 0 == site.epochNs ) {
+		t->touched[ t->numTouched++ ] = &site;
+	}
+	site.epochNs += stop - start;
+	if ( MAX_TOUCHED == t->numTouched || stop - t->epochStart >= EPOCH_NS ) {
+		endEpoch( t, stop );
+	}
+}
+
+// brackets a wrapped call, the time since the thread's last call is
+// compute
+class Phase {
+  public:
+	Phase( Fn fn, const void* addr ) : m_table( NULL ) {
+		if ( ! _profile ) {
+			return;
+		}
+		m_table = getTable();
+		m_fn = fn;
+		m_addr = addr;
+		m_ns = now();
+	}
+	~Phase() {
+		if ( ! m_table ) {
+			return;
+		}
+		Table* t = m_table;
+		uint64_t ns = now();
+		pthread_mutex_lock( &t->mutex );
+		if ( t->last ) {
+			charge( t, t->compute, t->lastNs, m_ns );
+		}
+		charge( t, findSite( t, m_fn, m_addr ), m_ns, ns );
+		t->lastNs = ns;
+		t->last = true;
+		pthread_mutex_unlock( &t->mutex );
+	}
+
+  private:
+	Table*				m_table;
+	Fn					m_fn;
+	const void*			m_addr;
+	uint64_t			m_ns;
+};
+
+#define PHASE( fn ) Phase phase( fn, __builtin_return_address(0) )
+
+bool profileInit()
+{
+	const char* env = getenv( "POWERRT_PROFILE" );
+	if ( ! env || ! *env || 0 == strcmp( env, "0" ) ) {
+		return false;
+	}
+	_energy = LocalEnergy::get();
+	if ( ! _energy ) {
+		fprintf( stderr, "WARNING: POWERRT_PROFILE no RAPL MSR or powercap,"
+									" the report has time only\n" );
+	}
+	_profile = true;
+	return true;
+}
+
+static std::string symbolize( const void* addr )
+{
+	std::ostringstream ret;
+	Dl_info info;
+	if ( dladdr( addr, &info ) && info.dli_sname ) {
+		int status;
+		char* name = abi::__cxa_demangle( info.dli_sname, NULL, NULL, &status );
+		ret << ( name ? name : info.dli_sname ) << "+0x" << std::hex <<
+				(uintptr_t) addr - (uintptr_t) info.dli_saddr;
+		free( name );
+	} else if ( info.dli_fname ) {
+		const char* file = strrchr( info.dli_fname, '/' );
+		ret << ( file ? file + 1 : info.dli_fname ) << "+0x" << std::hex <<
+				(uintptr_t) addr - (uintptr_t) info.dli_fbase;
+	} else {
+		ret << addr;
+	}
+	return ret.str();
+}
+
+static void serialize( std::ostringstream& out, const Site& site,
+											const std::string& name )
+{
+	if ( 0 == site.calls ) {
+		return;
+	}
+	out << name << "\t" << site.calls << "\t" << site.ns << "\t" <<
+									site.joules << "\n";
+}
+
+// a line per site, function, site, calls, ns and joules
+static std::string serializeTables()
+{
+	std::ostringstream out;
+	out.precision( 17 );
+	pthread_mutex_lock( &_mutex );
+	for ( unsigned i = 0; i < _tables.size(); i++ ) {
+		Table* t = _tables[i];
+		// another thread can still be in a call, the package energy we
+		// read ends its epoch as well as it could
+		pthread_mutex_lock( &t->mutex );
+		if ( _energy && t->numTouched ) {
+			endEpoch( t, now() );
+		}
+		for ( int j = 0; j < TABLE_SIZE; j++ ) {
+			Site& site = t->sites[j];
+			if ( site.addr ) {
+				serialize( out, site, std::string( _fns[site.fn].name ) +
+								"\t" + symbolize( site.addr ) );
+			}
+		}
+		for ( int j = 0; j < NUM_FNS; j++ ) {
+			serialize( out, t->other[j],
+						std::string( _fns[j].name ) + "\t(other)" );
+		}
+		serialize( out, t->compute, "compute\t-" );
+		pthread_mutex_unlock( &t->mutex );
+	}
+	pthread_mutex_unlock( &_mutex );
+	return out.str();
+}
+
+struct Total {
+	Total() : ranks( 0 ), calls( 0 ), ns( 0 ), joules( 0 ) {}
+	int			ranks;
+	uint64_t	calls;
+	uint64_t	ns;
+	double		joules;
+};
+
+static bool byEnergy( const std::pair<std::string,Total>& a,
+						const std::pair<std::string,Total>& b )
+{
+	if ( a.second.joules != b.second.joules ) {
+		return a.second.joules > b.second.joules;
+	}
+	return a.second.ns > b.second.ns;
+}
+
+static Category category( const std::string& fn )
+{
+	for ( int i = 0; i < NUM_FNS; i++ ) {
+		if ( fn == _fns[i].name ) {
+			return _fns[i].category;
+		}
+	}
+	return COMPUTE;
+}
+
+static void report( FILE* fp, int numRanks, const std::vector<char>& data )
+{
+	std::map<std::string,Total> sites;
+	Total categories[NUM_CATEGORIES];
+	Total all;
+
+	std::istringstream in( std::string( data.begin(), data.end() ) );
+	std::string line;
+	while ( std::getline( in, line ) ) {
+		std::istringstream fields( line );
+		std::string fn, site, calls, ns, joules;
+		std::getline( fields, fn, '\t' );
+		std::getline( fields, site, '\t' );
+		std::getline( fields, calls, '\t' );
+		std::getline( fields, ns, '\t' );
+		std::getline( fields, joules, '\t' );
+
+		Total t;
+		t.ranks = 1;
+		t.calls = strtoull( calls.c_str(), NULL, 10 );
+		t.ns = strtoull( ns.c_str(), NULL, 10 );
+		t.joules = strtod( joules.c_str(), NULL );
+
+		Total* totals[] = { &sites[ fn + "\t" + site ],
+									&categories[ category( fn ) ], &all };
+		for ( int i = 0; i < 3; i++ ) {
+			totals[i]->ranks += t.ranks;
+			totals[i]->calls += t.calls;
+			totals[i]->ns += t.ns;
+			totals[i]->joules += t.joules;
+		}
+	}
+
+	fprintf( fp, "# powerrt profile, %d ranks, energy %s\n", numRanks,
+						_energy ? "of the package a rank ran on, ranks"
+						" that share a package each count all of it" :
+						"not available" );
+	fprintf( fp, "%-12s %12s %12s %7s %7s\n", "category", "time(s)",
+									"energy(J)", "%time", "%energy" );
+	for ( int i = 0; i < NUM_CATEGORIES; i++ ) {
+		const Total& t = categories[i];
+		fprintf( fp, "%-12s %12.6f %12.6f %7.2f %7.2f\n", _categoryNames[i],
+				t.ns / 1e9, t.joules, all.ns ? 100.0 * t.ns / all.ns : 0.0,
+				all.joules ? 100.0 * t.joules / all.joules : 0.0 );
+	}
+
+	std::vector< std::pair<std::string,Total> > sorted( sites.begin(),
+															sites.end() );
+	std::sort( sorted.begin(), sorted.end(), byEnergy );
+
+	fprintf( fp, "\n%-14s %6s %10s %12s %12s  %s\n", "function", "ranks",
+						"calls", "time(s)", "energy(J)", "site" );
+	for ( unsigned i = 0; i < sorted.size(); i++ ) {
+		const std::string& key = sorted[i].first;
+		const Total& t = sorted[i].second;
+		size_t tab = key.find( '\t' );
+		fprintf( fp, "%-14s %6d %10lu %12.6f %12.6f  %s\n",
+			key.substr( 0, tab ).c_str(), t.ranks, (unsigned long) t.calls,
+			t.ns / 1e9, t.joules, key.substr( tab + 1 ).c_str() );
+	}
+}
+
+// gathers every rank's tables to rank 0, which writes the report, called
+// before PMPI_Finalize
+void profileFini()
+{
+	if ( ! _profile ) {
+		return;
+	}
+
+	// the time from the last call is compute too
+	Table* t = getTable();
+	pthread_mutex_lock( &t->mutex );
+	if ( t->last ) {
+		charge( t, t->compute, t->lastNs, now() );
+	}
+	pthread_mutex_unlock( &t->mutex );
+	_profile = false;
+
+	int rank, numRanks, rc;
+	rc = PMPI_Comm_rank( MPI_COMM_WORLD, &rank );
+	assert( MPI_SUCCESS == rc );
+	rc = PMPI_Comm_size( MPI_COMM_WORLD, &numRanks );
+	assert( MPI_SUCCESS == rc );
+
+	std::string mine = serializeTables();
+	int len = mine.size();
+
+	std::vector<int> lens( numRanks );
+	rc = PMPI_Gather( &len, 1, MPI_INT, &lens[0], 1, MPI_INT, 0,
+												MPI_COMM_WORLD );
+	assert( MPI_SUCCESS == rc );
+
+	std::vector<int> displs( numRanks );
+	int total = 0;
+	for ( int i = 0; i < numRanks; i++ ) {
+		displs[i] = total;
+		total += lens[i];
+	}
+	std::vector<char> data( total + 1 );
+	rc = PMPI_Gatherv( &mine[0], len, MPI_CHAR, &data[0], &lens[0],
+						&displs[0], MPI_CHAR, 0, MPI_COMM_WORLD );
+	assert( MPI_SUCCESS == rc );
+	data.resize( total );
+
+	if ( 0 == rank ) {
+		const char* file = getenv( "POWERRT_REPORT" );
+		FILE* fp = file && *file ? fopen( file, "w" ) : stdout;
+		if ( ! fp ) {
+			fprintf( stderr, "ERROR: POWERRT_REPORT can't open `%s`\n", file );
+		} else {
+			report( fp, numRanks, data );
+			if ( fp != stdout ) {
+				fclose( fp );
+			} else {
+				fflush( fp );
+			}
+		}
+	}
+}
+
+int MPI_Send( const void *buf, int count, MPI_Datatype datatype, int dest,
+						int tag, MPI_Comm comm )
+{
+	PHASE( SEND );
+	return PMPI_Send( buf, count, datatype, dest, tag, comm );
+}
+
+int MPI_Recv( void *buf, int count, MPI_Datatype datatype, int source,
+						int tag, MPI_Comm comm, MPI_Status *status )
+{
+	PHASE( RECV );
+	return PMPI_Recv( buf, count, datatype, source, tag, comm, status );
+}
+
+int MPI_Sendrecv( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			int dest, int sendtag, void *recvbuf, int recvcount,
+			MPI_Datatype recvtype, int source, int recvtag,
+			MPI_Comm comm, MPI_Status *status )
+{
+	PHASE( SENDRECV );
+	return PMPI_Sendrecv( sendbuf, sendcount, sendtype, dest, sendtag,
+			recvbuf, recvcount, recvtype, source, recvtag, comm, status );
+}
+
+int MPI_Isend( const void *buf, int count, MPI_Datatype datatype, int dest,
+						int tag, MPI_Comm comm, MPI_Request *request )
+{
+	PHASE( ISEND );
+	return PMPI_Isend( buf, count, datatype, dest, tag, comm, request );
+}
+
+int MPI_Irecv( void *buf, int count, MPI_Datatype datatype, int source,
+						int tag, MPI_Comm comm, MPI_Request *request )
+{
+	PHASE( IRECV );
+	return PMPI_Irecv( buf, count, datatype, source, tag, comm, request );
+}
+
+int MPI_Wait( MPI_Request *request, MPI_Status *status )
+{
+	PHASE( WAIT );
+	return PMPI_Wait( request, status );
+}
+
+int MPI_Waitall( int count, MPI_Request requests[], MPI_Status *statuses )
+{
+	PHASE( WAITALL );
+	return PMPI_Waitall( count, requests, statuses );
+}
+
+int MPI_Waitany( int count, MPI_Request requests[], int *index,
+											MPI_Status *status )
+{
+	PHASE( WAITANY );
+	return PMPI_Waitany( count, requests, index, status );
+}
+
+int MPI_Barrier( MPI_Comm comm )
+{
+	PHASE( BARRIER );
+	return PMPI_Barrier( comm );
+}
+
+int MPI_Bcast( void *buffer, int count, MPI_Datatype datatype, int root,
+											MPI_Comm comm )
+{
+	PHASE( BCAST );
+	return PMPI_Bcast( buffer, count, datatype, root, comm );
+}
+
+int MPI_Reduce( const void *sendbuf, void *recvbuf, int count,
+			MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm )
+{
+	PHASE( REDUCE );
+	return PMPI_Reduce( sendbuf, recvbuf, count, datatype, op, root, comm );
+}
+
+int MPI_Allreduce( const void *sendbuf, void *recvbuf, int count,
+			MPI_Datatype datatype, MPI_Op op, MPI_Comm comm )
+{
+	PHASE( ALLREDUCE );
+	return PMPI_Allreduce( sendbuf, recvbuf, count, datatype, op, comm );
+}
+
+int MPI_Gather( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			int root, MPI_Comm comm )
+{
+	PHASE( GATHER );
+	return PMPI_Gather( sendbuf, sendcount, sendtype, recvbuf, recvcount,
+									recvtype, root, comm );
+}
+
+int MPI_Gatherv( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, const int recvcounts[], const int displs[],
+			MPI_Datatype recvtype, int root, MPI_Comm comm )
+{
+	PHASE( GATHERV );
+	return PMPI_Gatherv( sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+									displs, recvtype, root, comm );
+}
+
+int MPI_Scatter( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			int root, MPI_Comm comm )
+{
+	PHASE( SCATTER );
+	return PMPI_Scatter( sendbuf, sendcount, sendtype, recvbuf, recvcount,
+									recvtype, root, comm );
+}
+
+int MPI_Allgather( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			MPI_Comm comm )
+{
+	PHASE( ALLGATHER );
+	return PMPI_Allgather( sendbuf, sendcount, sendtype, recvbuf, recvcount,
+									recvtype, comm );
+}
+
+int MPI_Allgatherv( const void *sendbuf, int sendcount,
+			MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+			const int displs[], MPI_Datatype recvtype, MPI_Comm comm )
+{
+	PHASE( ALLGATHERV );
+	return PMPI_Allgatherv( sendbuf, sendcount, sendtype, recvbuf,
+								recvcounts, displs, recvtype, comm );
+}
+
+int MPI_Alltoall( const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			MPI_Comm comm )
+{
+	PHASE( ALLTOALL );
+	return PMPI_Alltoall( sendbuf, sendcount, sendtype, recvbuf, recvcount,
+									recvtype, comm );
+}
+
+int MPI_Alltoallv( const void *sendbuf, const int sendcounts[],
+			const int sdispls[], MPI_Datatype sendtype, void *recvbuf,
+			const int recvcounts[], const int rdispls[],
+			MPI_Datatype recvtype, MPI_Comm comm )
+{
+	PHASE( ALLTOALLV );
+	return PMPI_Alltoallv( sendbuf, sendcounts, sdispls, sendtype, recvbuf,
+					recvcounts, rdispls, recvtype, comm );
+}
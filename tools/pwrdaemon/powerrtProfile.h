@@ -0,0 +1,23 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _POWERRT_PROFILE_H
+#define _POWERRT_PROFILE_H
+
+// POWERRT_PROFILE turns on the wrappers of the MPI calls, each call site's
+// time and the energy of the package it ran on are added up per rank and
+// reduced to a report at MPI_Finalize, written to POWERRT_REPORT if it is
+// set else to stdout. The energy is read a few times a millisecond at 
+// most and split among the calls by their time.
+bool profileInit();
+void profileFini();
+
+#endif
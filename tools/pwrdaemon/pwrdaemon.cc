@@ -18,9 +18,12 @@
 #include "router.h"
 #include "server.h"
 #include "logger.h"
+#include "config.h"
 #include <sstream>
 #include <utmpx.h>
 #include <sched.h>
+#include <getopt.h>
+#include <fstream>
 
 
 void* startRtrThread( void *);
@@ -32,9 +35,26 @@ struct Args {
 	std::vector<char*> argv;
 };
 
+// getopt and the environment aren't thread safe, the components take 
+// turns with their arguments
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// The router comes up first, the servers connect to it, then the servers
+// together, then the logger that reads through them. Each says when it 
+// is ready to work, or that it failed to start.
+static pthread_mutex_t readyMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t readyCond = PTHREAD_COND_INITIALIZER;
+static unsigned numReady = 0;
+static unsigned numFailed = 0;
+// the servers initialize once they all have their arguments
+static pthread_barrier_t srvrBarrier;
+
+static void ready( bool ok = true );
+static bool waitReady( unsigned );
+
 void findArgs( std::string prefix, int argc, char** argv, Args& args );
+static void setAffinity( Args& args );
+static void setPythonPath( std::deque<Args*>& srvrArgs );
 
 int main( int argc, char* argv[] )
 {
@@ -45,23 +65,22 @@ int main( int argc, char* argv[] )
 	pthread_t lgrThread = 0;
 
 	std::deque<pthread_t> srvrThreads;
+	std::deque<Args*> srvrArgs;
+
+	// the threads we start, and theirs, run where we do
+	struct Args daemonArgs;
+	daemonArgs.argv.push_back( argv[0] );
+	findArgs( "daemon", argc, argv, daemonArgs );
+	setAffinity( daemonArgs );
 	
 	rtrArgs.argv.push_back( argv[0] );
 	findArgs( "rtr", argc, argv, rtrArgs );
-	pthread_mutex_init(&mutex,NULL);
-
-	if ( rtrArgs.argv.size() > 2 ) {
-		rc = pthread_mutex_lock(&mutex);	
-		assert(0==rc);
-		rc = pthread_create( &rtrThread, NULL, startRtrThread, &rtrArgs );  
-		assert(0==rc);
-	}
 
 	int count = -1;
 	while ( 1 ) {
 
-		struct Args& srvrArgs = *new Args;
-		srvrArgs.argv.push_back( argv[0] );
+		struct Args& args = *new Args;
+		args.argv.push_back( argv[0] );
 
 		std::string tmp("srvr");
 		if ( count > -1 ) {
@@ -70,36 +89,52 @@ int main( int argc, char* argv[] )
 			tmp += convert.str(); 
 		}
 
-		findArgs( tmp , argc, argv, srvrArgs );
+		findArgs( tmp , argc, argv, args );
 
-		if ( srvrArgs.argv.size() > 2 ) {
-			
-			srvrThreads.resize( srvrThreads.size() + 1 );
-			rc = pthread_mutex_lock(&mutex);	
-			assert(0==rc);
-			rc = pthread_create( &srvrThreads.back(), NULL, startSrvrThread, &srvrArgs );  
-			assert(0==rc);
+		if ( args.argv.size() > 2 ) {
+			srvrArgs.push_back( &args );
 		} else {
-			delete &srvrArgs;
+			delete &args;
 			break;
 		}
 
 		++count;
 	} 
 
+	setPythonPath( srvrArgs );
+
+	unsigned numComponents = 0;
+	if ( rtrArgs.argv.size() > 2 ) {
+		rc = pthread_create( &rtrThread, NULL, startRtrThread, &rtrArgs );  
+		assert(0==rc);
+		waitReady( ++numComponents );
+	}
+
+	if ( ! srvrArgs.empty() ) {
+		rc = pthread_barrier_init( &srvrBarrier, NULL, srvrArgs.size() );
+		assert(0==rc);
+		srvrThreads.resize( srvrArgs.size() );
+		for ( unsigned i = 0; i < srvrArgs.size(); i++ ) {
+			rc = pthread_create( &srvrThreads[i], NULL, startSrvrThread, 
+														srvrArgs[i] );  
+			assert(0==rc);
+		}
+		numComponents += srvrArgs.size();
+		if ( ! waitReady( numComponents ) ) {
+			printf("ERROR: a server failed to start\n");
+			exit(-1);
+		}
+	}
+
 	lgrArgs.argv.push_back( argv[0] );
 	findArgs( "lgr", argc, argv, lgrArgs );
 
 	if ( lgrArgs.argv.size() > 2 ) {
-		rc = pthread_mutex_lock(&mutex);	
-		assert(0==rc);
 		rc = pthread_create( &lgrThread, NULL, startLgrThread, &lgrArgs );  
 		assert(0==rc);
+		waitReady( ++numComponents );
 	}
 
-	rc = pthread_mutex_lock(&mutex);	
-	assert(0==rc);
-
     if ( getenv( "POWERRT_SIGNAL" ) ) {
 	    kill(getppid(),SIGUSR1);
     }
@@ -128,9 +163,7 @@ void* startRtrThread( void * _args)
 	//printf("start router\n");
 
 	PWR_Router::Router rtr(args.argc, &args.argv[0] );
-
-	int rc = pthread_mutex_unlock(&mutex);	
-	assert(0==rc);
+	ready();
 
 	return (void*) (unsigned long)rtr.work();
 }
@@ -141,11 +174,22 @@ void* startSrvrThread( void * _args)
 
 	//printf("start server\n");
 
+	int rc = pthread_mutex_lock(&mutex);	
+	assert(0==rc);
 	PWR_Server::Server srvr(args.argc, &args.argv[0] );
-
-	int rc = pthread_mutex_unlock(&mutex);	
+	rc = pthread_mutex_unlock(&mutex);	
 	assert(0==rc);
 
+	// no one changes the environment while the contexts read it, the
+	// constructors have set all of it
+	rc = pthread_barrier_wait( &srvrBarrier );
+	assert( 0 == rc || PTHREAD_BARRIER_SERIAL_THREAD == rc );
+	if ( ! srvr.init() ) {
+		ready( false );
+		return (void*) -1;
+	}
+	ready();
+
 	return (void*) (unsigned long)srvr.work();
 }
 
@@ -156,9 +200,7 @@ void* startLgrThread( void * _args)
 	//printf("start logger\n");
 
 	PWR_Logger::Logger logger(args.argc, &args.argv[0] );
-
-	int rc = pthread_mutex_unlock(&mutex);	
-	assert(0==rc);
+	ready();
 
 	return (void*) (unsigned long)logger.work();
 }
@@ -183,3 +225,129 @@ void findArgs( std::string prefix, int argc, char* argv[], Args& args )
 	args.argc = args.argv.size();
 	args.argv.push_back(NULL);
 }
+
+// The servers share one interpreter, see PyConfig, so the directories of
+// all their python configs go on one PYTHONPATH, ahead of what it was.
+// Set before any thread starts, nothing writes it afterwards.
+static void setPythonPath( std::deque<Args*>& srvrArgs )
+{
+	std::string path;
+	for ( unsigned i = 0; i < srvrArgs.size(); i++ ) {
+		Args& args = *srvrArgs[i];
+		std::string dir, module;
+		if ( ! PowerAPI::pyConfigModule( PWR_Server::Server::configFile( 
+						args.argc, &args.argv[0] ), dir, module ) ||
+				dir.empty() || 
+				std::string::npos != ( ":" + path + ":" ).find( 
+												":" + dir + ":" ) ) {
+			continue;
+		}
+		path += ( path.empty() ? "" : ":" ) + dir;
+	}
+	if ( path.empty() ) {
+		return;
+	}
+
+	const char* cur = getenv( "PYTHONPATH" );
+	if ( cur && *cur ) {
+		path = path + ":" + cur;
+	}
+	setenv( "PYTHONPATH", path.c_str(), 1 );
+}
+
+static void ready( bool ok )
+{
+	pthread_mutex_lock( &readyMutex );
+	if ( ok ) {
+		++numReady;
+	} else {
+		++numFailed;
+	}
+	pthread_cond_broadcast( &readyCond );
+	pthread_mutex_unlock( &readyMutex );
+}
+
+// false if any failed
+static bool waitReady( unsigned count )
+{
+	pthread_mutex_lock( &readyMutex );
+	while ( numReady + numFailed < count ) {
+		pthread_cond_wait( &readyCond, &readyMutex );
+	}
+	bool ok = 0 == numFailed;
+	pthread_mutex_unlock( &readyMutex );
+	return ok;
+}
+
+// a list like 0-3,8,10-11
+static bool parseCpus( std::string list, cpu_set_t* set )
+{
+	CPU_ZERO( set );
+	std::istringstream in( list );
+	std::string range;
+	while ( std::getline( in, range, ',' ) ) {
+		int first, last;
+		char dash;
+		std::istringstream r( range );
+		if ( ! ( r >> first ) || first < 0 ) {
+			return false;
+		}
+		last = first;
+		if ( r >> dash && ( '-' != dash || ! ( r >> last ) || last < first ) ) {
+			return false;
+		}
+		for ( int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++ ) {
+			CPU_SET( cpu, set );
+		}
+	}
+	return CPU_COUNT( set ) > 0;
+}
+
+static void setAffinity( Args& args )
+{
+	int opt = 0;
+	int long_index = 0;
+	enum { CPUS, NUMA_NODE };
+	static struct option long_options[] = {
+		{"cpus"         , required_argument, NULL, CPUS },
+		{"numaNode"     , required_argument, NULL, NUMA_NODE },
+		{0,0,0,0}
+	};
+
+	std::string cpus;
+	optind=1;
+	while ( ( opt = getopt_long( args.argc, &args.argv[0], "", 
+							long_options, &long_index ) ) != -1 ) {
+		switch(opt) {
+		  case CPUS:
+			// housekeeping cores, 0-1
+			cpus = optarg;
+			break;
+		  case NUMA_NODE:
+			// all the cores of a node
+			{
+				std::string path = std::string("/sys/devices/system/node/node")
+										+ optarg + "/cpulist";
+				std::ifstream file( path.c_str() );
+				if ( ! std::getline( file, cpus ) ) {
+					printf("ERROR: no NUMA node `%s`\n", optarg );
+					exit(-1);
+				}
+			}
+			break;
+		}
+	}
+	if ( cpus.empty() ) {
+		return;
+	}
+
+	cpu_set_t set;
+	if ( ! parseCpus( cpus, &set ) ) {
+		printf("ERROR: bad cpu list `%s`\n", cpus.c_str() );
+		exit(-1);
+	}
+	if ( 0 != sched_setaffinity( 0, sizeof(set), &set ) ) {
+		perror("sched_setaffinity");
+		exit(-1);
+	}
+}
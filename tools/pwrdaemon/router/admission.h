@@ -0,0 +1,150 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_ADMISSION_H
+#define _RTR_ADMISSION_H
+
+#include <map>
+#include <deque>
+#include <eventQueue.h>
+#include <pwrtypes.h>
+
+namespace PWR_Router {
+
+// rate events per second, up to burst at once 
+class TokenBucket {
+  public:
+	TokenBucket( double rate = 0, double burst = 0 ) : 
+		m_rate( rate ), m_burst( burst ), m_tokens( burst ), m_last( 0 ) {}
+
+	bool take( PWR_Time now ) {
+		refill( now );
+		if ( m_tokens >= 1 ) {
+			m_tokens -= 1;
+			return true;
+		}
+		return false;
+	}
+
+	// when the next token will be available
+	PWR_Time next( PWR_Time now ) {
+		refill( now );
+		if ( m_tokens >= 1 ) {
+			return now;
+		}
+		return now + (PWR_Time) ( ( 1 - m_tokens ) / m_rate * 1000000000 );
+	}
+
+  private:
+	void refill( PWR_Time now ) {
+		if ( m_last ) {
+			m_tokens += ( now - m_last ) * m_rate / 1000000000;
+			if ( m_tokens > m_burst ) {
+				m_tokens = m_burst;
+			}
+		}
+		m_last = now;
+	}
+
+	double		m_rate;
+	double		m_burst;
+	double		m_tokens;
+	PWR_Time	m_last;
+};
+
+// Per client admission control for an I/O thread. A client that is over
+// its rate has its events held, in order, until it has tokens again. 
+// Control events are never held. 
+class Admission {
+  public:
+	Admission() : m_rate( 0 ), m_burst( 0 ) {}
+
+	// a burst of 0 is a second's worth
+	void init( double rate, double burst ) {
+		m_rate = rate;
+		m_burst = burst > 0 ? burst : rate;
+		if ( m_burst < 1 ) {
+			m_burst = 1;
+		}
+	}
+	bool enabled() { return m_rate > 0; }
+
+	// false if the event is being held
+	bool admit( Event* ev, EventChannel* chan, PWR_Time now ) {
+		if ( PriorityControl == ev->priority() ) {
+			return true;
+		}
+		Client& client = getClient( chan );
+		if ( client.held.empty() && client.bucket.take( now ) ) {
+			return true;
+		}
+		client.held.push_back( ev );
+		return false;
+	}
+
+	// move held events that now have tokens to the queue, returns when 
+	// the next held event can go, 0 if nothing is held
+	PWR_Time release( EventQueue& queue, PWR_Time now ) {
+		PWR_Time next = 0;
+		std::map<EventChannel*,Client>::iterator iter;
+		for ( iter = m_clients.begin(); iter != m_clients.end(); ++iter ) {
+			Client& client = iter->second;
+			while ( ! client.held.empty() && client.bucket.take( now ) ) {
+				queue.push( client.held.front(), iter->first );
+				client.held.pop_front();
+			}
+			if ( ! client.held.empty() ) {
+				PWR_Time when = client.bucket.next( now );
+				if ( 0 == next || when < next ) {
+					next = when;
+				}
+			}
+		}
+		return next;
+	}
+
+	// the client has gone away 
+	void drop( EventChannel* chan ) {
+		std::map<EventChannel*,Client>::iterator iter = m_clients.find( chan );
+		if ( iter == m_clients.end() ) {
+			return;
+		}
+		while ( ! iter->second.held.empty() ) {
+			delete iter->second.held.front();
+			iter->second.held.pop_front();
+		}
+		m_clients.erase( iter );
+	}
+
+  private:
+	struct Client {
+		TokenBucket			bucket;
+		std::deque<Event*>	held;
+	};
+
+	Client& getClient( EventChannel* chan ) {
+		std::map<EventChannel*,Client>::iterator iter = m_clients.find( chan );
+		if ( iter == m_clients.end() ) {
+			iter = m_clients.insert( 
+					std::make_pair( chan, Client() ) ).first;
+			iter->second.bucket = TokenBucket( m_rate, m_burst );
+		}
+		return iter->second;
+	}
+
+	double m_rate;
+	double m_burst;
+	std::map<EventChannel*,Client>	m_clients;
+};
+
+}
+
+#endif
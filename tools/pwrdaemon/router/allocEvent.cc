@@ -16,12 +16,16 @@
 
 #include "allocEvent.h"
 #include "commCreateEvent.h"
+#include "commDestroyEvent.h"
 #include "commReqEvent.h"
 #include "commRespEvent.h"
 #include "commLogEvents.h"
 #include "commGetSamplesEvent.h"
+#include "commStatEvent.h"
+#include "subscribeEvents.h"
 #include "serverEvents.h"
 #include "rtrRouterEvent.h"
+#include "routerStatsEvent.h"
 
 using namespace PWR_Router;
 
@@ -40,6 +44,8 @@ Event* PWR_Router::allocRtrEvent( unsigned int type, SerialBuf& buf )
 		assert(0);
 	  case Router2Router:
 		return new RtrRouterEvent( buf );
+	  case RouteUpdate:
+		return new RtrRouteUpdateEvent( buf );
 	}
 	return NULL;
 }
@@ -53,12 +59,20 @@ Event* PWR_Router::allocClientEvent( unsigned int type, SerialBuf& buf )
 		assert(0);	
 	  case CommCreate:
 		return new RtrCommCreateEvent( buf );
+	  case CommDestroy:
+		return new RtrCommDestroyEvent( buf );
 	  case CommReq:
 		return new RtrCommReqEvent( buf );
 	  case CommLogReq:
 		return new RtrCommLogReqEvent( buf );
 	  case CommGetSamplesReq:
 		return new RtrCommGetSamplesReqEvent( buf );
+	  case CommStatReq:
+		return new RtrCommStatReqEvent( buf );
+	  case CommSubscribe:
+		return new RtrCommSubscribeEvent( buf );
+	  case RouterStatsReq:
+		return new RtrRouterStatsReqEvent( buf );
 	}
 	return NULL;
 }
@@ -78,6 +92,10 @@ Event* PWR_Router::allocServerEvent( unsigned int type, SerialBuf& buf )
 		return new RtrCommLogRespEvent( buf );
 	  case CommGetSamplesResp:
 		return new RtrCommGetSamplesRespEvent( buf );
+	  case CommStatResp:
+		return new RtrCommStatRespEvent( buf );
+	  case CommSample:
+		return new RtrCommSampleEvent( buf );
 	  case ServerConnect:
 		return new RtrServerConnectEvent( buf );
 	}
@@ -18,27 +18,76 @@ Router::Client::Client( Router& rtr ) :m_rtr(rtr) {
 }
 Router::Client::~Client() {
 	DBGX("\n");
-    std::map<CommID,CommCreateEvent* >::iterator iter;
-    for ( iter = m_commMap.begin(); iter != m_commMap.end(); ++iter ) {
-
-   		CommCreateEvent* ev = iter->second;
-        for ( unsigned int i = 0; i < ev->members[0].size(); i++ ) {
-            DBGX("%s\n", ev->members[0][i].c_str() );
-            CommDestroyEvent* d_ev = new CommDestroyEvent;
-            d_ev->commID = ev->commID;
-            m_rtr.sendEvent( ev->members[0][i].c_str(), d_ev );
-            delete d_ev;
-        }
-
-        delete ev;
-   }
+	while ( ! m_commMap.empty() ) {
+		destroyComm( m_commMap.begin() );
+	}
 }
 
 void Router::Client::addComm( CommID id, CommCreateEvent* ev ) {
-	assert( m_commMap.find( id ) == m_commMap.end() );
-    m_commMap[id] = ev;
+	CommMap::iterator iter = m_commMap.find( id );
+	if ( iter != m_commMap.end() ) {
+		destroyComm( iter );
+	}
+
+	Comm& comm = m_commMap[id];
+	comm.ev = ev;
+	comm.lru = m_lru.insert( m_lru.begin(), id );
+	comm.bytes = sizeof( *ev );
+	for ( unsigned i = 0; i < ev->members.size(); i++ ) {
+		for ( unsigned j = 0; j < ev->members[i].size(); j++ ) {
+			comm.bytes += sizeof( ObjID ) + ev->members[i][j].size();
+		}
+	}
+
+	RouterStats& stats = m_rtr.stats();
+	__sync_fetch_and_add( &stats.comms, 1 );
+	__sync_fetch_and_add( &stats.commBytes, comm.bytes );
+
+	// the client will create an evicted comm again if it needs it 
+	unsigned max = m_rtr.args().maxComms;
+	while ( max && m_commMap.size() > max ) {
+		DBGX("evict comm %" PRIx64 "\n", m_lru.back() );
+		__sync_fetch_and_add( &stats.commsEvicted, 1 );
+		destroyComm( m_commMap.find( m_lru.back() ) );
+	}
+}
+
+void Router::Client::delComm( CommID id ) {
+	CommMap::iterator iter = m_commMap.find( id );
+	if ( iter != m_commMap.end() ) {
+		destroyComm( iter );
+	}
+}
+
+// tell every server that was told about the comm to forget it
+void Router::Client::destroyComm( CommMap::iterator iter ) {
+	CommCreateEvent* ev = iter->second.ev;
+	DBGX("id=%" PRIx64 "\n", ev->commID );
+
+	for ( unsigned i = 0; i < ev->members.size(); i++ ) {
+		for ( unsigned j = 0; j < ev->members[i].size(); j++ ) {
+			DBGX("%s\n", ev->members[i][j].c_str() );
+			CommDestroyEvent* d_ev = new CommDestroyEvent;
+			d_ev->commID = ev->commID;
+			m_rtr.sendEvent( ev->members[i][j], d_ev );
+			delete d_ev;
+		}
+	}
+
+	RouterStats& stats = m_rtr.stats();
+	__sync_fetch_and_sub( &stats.comms, 1 );
+	__sync_fetch_and_sub( &stats.commBytes, iter->second.bytes );
+
+	m_lru.erase( iter->second.lru );
+	m_commMap.erase( iter );
+	delete ev;
 }
 
-std::vector< std::vector< ObjID > >& Router::Client::getCommList( CommID id ) {
-	return  m_commMap[id]->members;
+std::vector< std::vector< ObjID > >* Router::Client::getCommList( CommID id ) {
+	CommMap::iterator iter = m_commMap.find( id );
+	if ( iter == m_commMap.end() ) {
+		return NULL;
+	}
+	m_lru.splice( m_lru.begin(), m_lru, iter->second.lru );
+	return &iter->second.ev->members;
 }
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <time.h>
+#include <sstream>
+#include <debug.h>
+#include "collapse.h"
+
+using namespace PWR_Router;
+
+CollapseTable::CollapseTable() : m_window( 0 )
+{
+	pthread_mutex_init( &m_lock, NULL );
+}
+
+PWR_Time CollapseTable::now()
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (PWR_Time) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// an owner that waits forever, or past the requester's deadline, may
+// leave the requester waiting too long, one with a deadline may give up
+// on a requester that would wait forever
+static bool inTime( PWR_Time owner, PWR_Time deadline )
+{
+	if ( 0 == owner ) {
+		return 0 == deadline;
+	}
+	return deadline && owner <= deadline;
+}
+
+int CollapseTable::join( const std::string& key, EventChannel* src,
+				EventId id, PWR_Time deadline, CommRespEvent*& resp )
+{
+	int retval = OWNER;
+	pthread_mutex_lock( &m_lock );
+
+	std::map< std::string, Cached >::iterator cached = m_cache.find( key );
+	if ( cached != m_cache.end() ) {
+		if ( now() - cached->second.time <= m_window ) {
+			resp = new CommRespEvent( *cached->second.resp );
+			retval = CACHED;
+		} else {
+			delete cached->second.resp;
+			m_cache.erase( cached );
+		}
+	}
+
+	if ( OWNER == retval ) {
+		std::map< std::string, InFlight >::iterator iter = 
+												m_inFlight.find( key );
+		if ( iter == m_inFlight.end() ) {
+			m_inFlight[ key ].deadline = deadline;
+		} else if ( ! inTime( iter->second.deadline, deadline ) ) {
+			retval = ALONE;
+		} else {
+			Waiter waiter = { src, id };
+			iter->second.waiters.push_back( waiter );
+			retval = ATTACHED;
+		}
+	}
+
+	pthread_mutex_unlock( &m_lock );
+	DBGX("%s\n", retval == OWNER ? "owner" : 
+				retval == ATTACHED ? "attached" : 
+				retval == CACHED ? "cached" : "alone" );
+	return retval;
+}
+
+void CollapseTable::finish( const std::string& key, CommRespEvent* resp,
+								std::vector<Waiter>& waiters )
+{
+	pthread_mutex_lock( &m_lock );
+
+	std::map< std::string, InFlight >::iterator iter = 
+												m_inFlight.find( key );
+	assert( iter != m_inFlight.end() );
+	waiters.swap( iter->second.waiters );
+	m_inFlight.erase( iter );
+
+	// a failed get is not worth remembering
+	if ( m_window > 0 && resp->errValue.empty() ) {
+		PWR_Time time = now();
+		expire( time );
+		Cached& cached = m_cache[key];
+		delete cached.resp;
+		cached.time = time;
+		cached.resp = new CommRespEvent( *resp );
+	}
+
+	pthread_mutex_unlock( &m_lock );
+	DBGX("%zu waiters\n", waiters.size() );
+}
+
+void CollapseTable::dropChannel( EventChannel* ec )
+{
+	pthread_mutex_lock( &m_lock );
+
+	std::map< std::string, InFlight >::iterator iter;
+	for ( iter = m_inFlight.begin(); iter != m_inFlight.end(); ++iter ) {
+		std::vector<Waiter>& waiters = iter->second.waiters;
+		for ( size_t i = 0; i < waiters.size(); ) {
+			if ( waiters[i].src == ec ) {
+				waiters.erase( waiters.begin() + i );
+			} else {
+				++i;
+			}
+		}
+	}
+
+	pthread_mutex_unlock( &m_lock );
+}
+
+void CollapseTable::expire( PWR_Time time )
+{
+	std::map< std::string, Cached >::iterator iter = m_cache.begin();
+	while ( iter != m_cache.end() ) {
+		if ( time - iter->second.time > m_window ) {
+			delete iter->second.resp;
+			m_cache.erase( iter++ );
+		} else {
+			++iter;
+		}
+	}
+}
+
+std::string CollapseTable::key( std::vector< std::vector< ObjID > >& members,
+			std::vector<PWR_AttrName>& attrs, std::vector<ValueOp>& ops )
+{
+	std::ostringstream key;
+
+	for ( size_t i = 0; i < members.size(); i++ ) {
+		for ( size_t j = 0; j < members[i].size(); j++ ) {
+			key << members[i][j] << ',';
+		}
+		key << ';';
+	}
+	for ( size_t i = 0; i < attrs.size(); i++ ) {
+		key << attrs[i] << ':' << ( i < ops.size() ? ops[i] : NO_OP ) << ',';
+	}
+	return key.str();
+}
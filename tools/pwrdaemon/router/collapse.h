@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_COLLAPSE_H
+#define _RTR_COLLAPSE_H
+
+#include <pthread.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <events.h>
+#include <pwrtypes.h>
+
+class EventChannel;
+
+namespace PWR_Router {
+
+// Gets for the same members, attributes and value ops share one fan out
+// to the servers. A get that arrives while an identical one is in flight 
+// waits for its answer, one that arrives within the freshness window of 
+// an answer gets a copy of it. A get with a deadline only waits on one
+// that will be answered by then.
+class CollapseTable {
+  public:
+	struct Waiter {
+		EventChannel*	src;
+		EventId			id;
+	};
+
+	enum { OWNER, ATTACHED, CACHED, ALONE };
+
+	CollapseTable();
+
+	// window in nanoseconds, less than zero turns collapsing off
+	void setWindow( PWR_Time window ) { m_window = window; }
+	bool enabled() { return m_window >= 0; }
+
+	// deadline is when the requester gives up, CLOCK_MONOTONIC, 0 never
+	// OWNER, the caller must do the fan out and call finish()
+	// ATTACHED, the requester will be answered by finish()
+	// CACHED, resp is a copy of the cached answer, owned by the caller
+	// ALONE, the one in flight may not be answered in time, the caller
+	//   must do the fan out and not call finish()
+	int join( const std::string& key, EventChannel* src, EventId id,
+							PWR_Time deadline, CommRespEvent*& resp );
+
+	// hand back the requesters waiting on this answer
+	void finish( const std::string& key, CommRespEvent* resp, 
+										std::vector<Waiter>& waiters ); 
+
+	// the channel has gone away, don't answer anyone on it
+	void dropChannel( EventChannel* );
+
+	static std::string key( std::vector< std::vector< ObjID > >& members,
+			std::vector<PWR_AttrName>& attrs, std::vector<ValueOp>& ops );
+
+  private:
+	struct Cached {
+		PWR_Time		time;
+		CommRespEvent*	resp;
+	};
+	struct InFlight {
+		PWR_Time			deadline;
+		std::vector<Waiter>	waiters;
+	};
+
+	PWR_Time now();
+	void expire( PWR_Time now );
+
+	PWR_Time									m_window;
+	std::map< std::string, InFlight >			m_inFlight;
+	std::map< std::string, Cached >				m_cache;
+	pthread_mutex_t								m_lock;
+};
+
+}
+
+#endif
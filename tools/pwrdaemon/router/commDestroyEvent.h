@@ -0,0 +1,41 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_COMM_DESTROY_EVENT_H
+#define _RTR_COMM_DESTROY_EVENT_H
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h>
+#include "router.h"
+
+namespace PWR_Router {
+
+class RtrCommDestroyEvent: public  CommDestroyEvent {
+  public:
+   	RtrCommDestroyEvent( SerialBuf& buf ) : CommDestroyEvent( buf ) {}  
+
+	bool process( EventGenerator* _rtr, EventChannel* ec ) {
+		Router& rtr = *static_cast<Router*>(_rtr);
+		DBGX("id=%" PRIx64 "\n",commID);
+
+		// the comm may already have been evicted
+		rtr.getClient( ec )->delComm( commID );
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -30,8 +30,17 @@ class RtrCommLogReqEvent: public  CommLogReqEvent {
         Router& rtr = *static_cast<Router*>(_rtr);
 		Router::Client& client = *rtr.getClient( ec );
 
-        std::vector< std::vector< ObjID > >& commList =
-                client.getCommList( commID );
+		std::vector< std::vector< ObjID > >* comm = client.getCommList( commID );
+		if ( ! comm ) {
+			DBGX("unknown commID=%" PRIx64 "\n", commID );
+			CommLogRespEvent* resp = new CommLogRespEvent;
+			resp->id = id;
+			resp->status = UnknownComm;
+			ec->sendEvent( resp );
+			delete resp;
+			return true;
+		}
+		std::vector< std::vector< ObjID > >& commList = *comm;
 
         // don't support more that one object at this time
         assert( 1 == commList.size() );
@@ -44,17 +53,37 @@ class RtrCommLogReqEvent: public  CommLogReqEvent {
 
         info->resp = new CommLogRespEvent; 
         info->resp->id = id;
-        id = (EventId) info;
+        id = rtr.reqTable().newId();
 
-        DBGX("commID=%" PRIu64 " eventId=%" PRIx64 " new eventId=%p\n",
-                                commID, id, info );
+        DBGX("commID=%" PRIu64 " eventId=%" PRIx64 " new eventId=%" PRIx64 "\n",
+                                commID, info->resp->id, id );
+
+		EventId reqId = id;
+		rtr.reqTable().lock( reqId );
+		rtr.reqTable().insert( reqId, info );
+
+		bool sent = true;
 
         for ( unsigned int i=0; i <  commList.size(); i++ ) {
 
             for ( unsigned int j=0; j <  commList[i].size(); j++ ) {
-                rtr.sendEvent( commList[i][j], this );
+                if ( ! rtr.sendEvent( commList[i][j], this ) ) {
+                	sent = false;
+                }
             }
         }
+
+		// there is only one member, if it can't be reached we are done
+		if ( ! sent ) {
+			rtr.reqTable().erase( reqId );
+			info->resp->status = PWR_RET_IPC;
+			info->src->sendEvent( info->resp );
+			delete info->resp;
+			delete info;
+			rtr.reqTable().unlock( reqId );
+			return true;
+		}
+		rtr.reqTable().unlock( reqId );
 		return false;
 	}
 };
@@ -66,15 +95,25 @@ class RtrCommLogRespEvent: public  CommLogRespEvent {
 
 	bool process( EventGenerator* _rtr, EventChannel* ec ) {
 
-      	DBGX("id=%p status=%d \n",(void*)id, status );
+      	DBGX("id=%" PRIx64 " status=%d \n", id, status );
+
+		ReqTable& table = static_cast<Router*>(_rtr)->reqTable();
+		EventId reqId = id;
 
-        CommReqInfo* info = (CommReqInfo*) id;
+		table.lock( reqId );
+        CommReqInfo* info = table.find( reqId );
+		assert( info );
+		table.erase( reqId );
 
         // Why don't we just sent this? Because we want to be consistent
         // CommRespEvent
         *static_cast<CommLogRespEvent*>(info->resp) = *this;
 
-        info->src->sendEvent( info->resp );
+		// under the lock, the requester may be going away
+		if ( info->src ) {
+			info->src->sendEvent( info->resp );
+		}
+		table.unlock( reqId );
         delete info->resp;
         delete info->ev;
         delete info;
@@ -30,23 +30,63 @@ class RtrCommReqEvent: public  CommReqEvent {
 		Router& rtr = *static_cast<Router*>(_rtr);
 		Router::Client& client = *rtr.getClient( ec );
 
-    	std::vector< std::vector< ObjID > >& commList = 
-				client.getCommList( commID );
+    	std::vector< std::vector< ObjID > >* comm = client.getCommList( commID );
+		if ( ! comm ) {
+			DBGX("unknown commID=%" PRIx64 "\n", commID );
+			CommRespEvent* resp = new CommRespEvent;
+			resp->id = id;
+			resp->status = UnknownComm;
+			ec->sendEvent( resp );
+			delete resp;
+			return true;
+		}
+    	std::vector< std::vector< ObjID > >& commList = *comm;
+
+		std::string collapseKey;
+		if ( op == Get && rtr.collapse().enabled() ) {
+			CommRespEvent* resp = NULL;
+			collapseKey = CollapseTable::key( commList, attrName, valueOp );
+
+			PWR_Time when = deadline ? Router::now() + deadline : 0;
+
+			int rc = rtr.collapse().join( collapseKey, ec, id, when, resp );
+
+			switch ( rc ) {
+			  case CollapseTable::ATTACHED:
+				return true;
+			  case CollapseTable::CACHED:
+				resp->id = id;
+				ec->sendEvent( resp );
+				delete resp;
+				return true;
+			  case CollapseTable::ALONE:
+				collapseKey.clear();
+				break;
+			}
+		}
 
     	CommReqInfo* info = new CommReqInfo;
+		ReqTable& table = rtr.reqTable();
+		EventId reqId = table.newId();
+
+		info->collapseKey = collapseKey;
 
-    	DBGX("commID=%" PRIx64 " eventId=%" PRIx64 " new eventId=%p\n", 
-													commID, id, info );
+    	DBGX("commID=%" PRIx64 " eventId=%" PRIx64 " new eventId=%" PRIx64 "\n", 
+													commID, id, reqId );
 
     	info->src = ec;
     	info->ev = this;
 		info->grpInfo.resize( commList.size() );
+		info->grpDone.resize( commList.size(), false );
 		info->respQ.resize( commList.size() );
-		info->pending = commList.size();
+		// one for each group and one for the sender, which holds the
+		// request while it is sent to everyone
+		info->pending = commList.size() + 1;
+		info->start = Router::now();
         info->resp = new CommRespEvent;
         info->resp->id = id;
 
-    	id = (EventId) info;
+    	id = reqId;
 
 		if ( op == Get ) {
 
@@ -62,16 +102,78 @@ class RtrCommReqEvent: public  CommReqEvent {
                             value.resize( commList.size() );
    		}
 
-    	for ( unsigned int i=0; i <  commList.size(); i++ ) {
+		for ( unsigned int i=0; i <  commList.size(); i++ ) {
 			info->grpInfo[i] = commList[i].size();
+		}
+		if ( deadline > 0 ) {
+			info->members = commList;
+		}
+
+		// responses may be reduced by another I/O thread as soon as the 
+		// request is in the table, the sender's reference keeps it there
+		// while the sends, which may block, are made without the lock
+		table.lock( reqId );
+		table.insert( reqId, info );
+		table.unlock( reqId );
+
+		if ( deadline > 0 ) {
+			rtr.addDeadline( Router::now() + deadline, reqId ); 
+		}
 
+    	for ( unsigned int i=0; i <  commList.size(); i++ ) {
 			grpIndex = i;
     		for ( unsigned int j=0; j <  commList[i].size(); j++ ) {
-				rtr.sendEvent( commList[i][j], this );
+				memberIndex = j;
+				if ( ! rtr.sendEvent( commList[i][j], this ) ) {
+					// unless the deadline has already given up on the group
+					table.lock( reqId );
+					if ( ! info->grpDone[i] ) {
+						failMember( info, commList[i][j] );
+					}
+					table.unlock( reqId );
+				}
 			}
     	}
+
+		// everyone we could reach may already have answered 
+		table.lock( reqId );
+    	for ( unsigned int i=0; i <  commList.size(); i++ ) {
+			if ( ! info->grpDone[i] && 
+						info->respQ[i].size() == info->grpInfo[i] ) {
+				info->reduce( i );
+			}
+		}
+		if ( 0 == --info->pending ) {
+			table.erase( reqId );
+			info->respond( rtr );
+			delete info;
+		}
+		table.unlock( reqId );
 		return false;
 	}
+
+  private:
+	// stand in for the response of a member the request could not be
+	// sent to, grpIndex and memberIndex are still set for the member
+	void failMember( CommReqInfo* info, ObjID& obj ) {
+		DBGX("could not send to `%s`\n", obj.c_str() );
+		CommRespEvent* resp = new CommRespEvent;
+		resp->id = id;
+		resp->grpIndex = grpIndex;
+		resp->memberIndex = memberIndex;
+		if ( op == Get ) {
+			resp->value.resize(1);
+			resp->timeStamp.resize(1);
+			resp->value[0].resize( attrName.size(), 0 );
+			resp->timeStamp[0].resize( attrName.size(), 0 );
+		}
+		for ( unsigned i = 0; i < attrName.size(); i++ ) {
+			resp->errObj.push_back( obj );
+			resp->errAttr.push_back( attrName[i] );
+			resp->errValue.push_back( PWR_RET_IPC );
+		}
+		info->respQ[grpIndex].push_back( resp );
+	}
 };
 
 }
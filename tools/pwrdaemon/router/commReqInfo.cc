@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <set>
+
+#include <debug.h>
+#include "router.h"
+
+using namespace PWR_Router;
+
+static inline void fpAdd( void* inout, void* in )
+{
+	*(double*)inout += *(double*)in;
+}
+
+void CommReqInfo::reduce( size_t grpIndex )
+{
+	CommRespEvent* resp = static_cast<CommRespEvent*>(this->resp);
+	std::vector< CommRespEvent* >& queue = respQ[grpIndex];
+
+	if ( CommEvent::Get == ev->op ) {
+		DBGX("index %zu is ready, num attrs %zu\n",
+								grpIndex, valueOp.size() );
+		resp->timeStamp[grpIndex].resize( valueOp.size() );
+		resp->value[grpIndex].resize( valueOp.size() );
+
+		for ( unsigned i = 0; i < valueOp.size(); i++ ) { 
+			resp->value[grpIndex][i] = 0;
+			resp->timeStamp[grpIndex][i] = 0;
+		}
+
+		for ( unsigned j = 0; j < queue.size(); j++ ) {
+			for ( unsigned i = 0; i < valueOp.size(); i++ ) { 
+				DBGX( "op=%d \n", valueOp[i] );			
+				assert( FP_ADD == valueOp[i] );
+
+				fpAdd( &resp->value[grpIndex][i], &queue[j]->value[0][i] );
+
+				// members that could not be reached have no time stamp
+				if ( queue[j]->timeStamp[0][i] ) {
+					resp->timeStamp[grpIndex][i] = queue[j]->timeStamp[0][i];
+				}
+			}
+		} 
+	}
+	for ( unsigned j = 0; j < queue.size(); j++ ) {
+		resp->errValue.insert( resp->errValue.end(), 
+					queue[j]->errValue.begin(), queue[j]->errValue.end() );
+		resp->errAttr.insert( resp->errAttr.end(), 
+					queue[j]->errAttr.begin(), queue[j]->errAttr.end() );
+		resp->errObj.insert( resp->errObj.end(), 
+					queue[j]->errObj.begin(), queue[j]->errObj.end() );
+		delete queue[j];
+	}
+	queue.clear();
+
+	// quiet valgrind
+	resp->grpIndex = 0;
+	resp->commID = 0;
+
+	grpDone[grpIndex] = true;
+	DBGX("pending %zu\n",pending);
+	--pending;
+}
+
+void CommReqInfo::expire()
+{
+	CommRespEvent* resp = static_cast<CommRespEvent*>(this->resp);
+	CommReqEvent* req = static_cast<CommReqEvent*>(ev);
+
+	for ( size_t grp = 0; grp < grpInfo.size(); grp++ ) {
+		if ( grpDone[grp] ) {
+			continue;
+		}
+
+		std::set<uint64_t> answered;
+		for ( size_t j = 0; j < respQ[grp].size(); j++ ) {
+			answered.insert( respQ[grp][j]->memberIndex );
+		}
+
+		for ( size_t j = 0; j < members[grp].size(); j++ ) {
+			if ( answered.find( j ) != answered.end() ) {
+				continue;
+			}
+			DBGX("no answer from `%s`\n", members[grp][j].c_str() );
+			for ( size_t i = 0; i < req->attrName.size(); i++ ) {
+				resp->errObj.push_back( members[grp][j] );
+				resp->errAttr.push_back( req->attrName[i] );
+				resp->errValue.push_back( PWR_RET_TIMEOUT );
+			}
+		}
+		reduce( grp );
+	}
+}
+
+void CommReqInfo::respond( Router& rtr )
+{
+	CommRespEvent* resp = static_cast<CommRespEvent*>(this->resp);
+
+	rtr.stats().requestLatency.add( Router::now() - start );
+
+	if ( src ) {
+		src->sendEvent( resp );
+	}
+
+	if ( ! collapseKey.empty() ) {
+		std::vector<CollapseTable::Waiter> waiters;
+		EventId id = resp->id;
+
+		rtr.collapse().finish( collapseKey, resp, waiters );
+
+		for ( size_t i = 0; i < waiters.size(); i++ ) {
+			DBGX("collapsed requester %" PRIx64 "\n", waiters[i].id );
+			resp->id = waiters[i].id;
+			waiters[i].src->sendEvent( resp );
+		}
+		resp->id = id;
+	}
+
+	delete resp;
+	delete ev;
+}
+
+void ReqTable::dropChannel( EventChannel* ec )
+{
+	for ( unsigned i = 0; i < NUM_SHARDS; i++ ) {
+		pthread_mutex_lock( &m_shards[i].lock );
+		std::map<EventId,CommReqInfo*>::iterator iter;
+		for ( iter = m_shards[i].map.begin(); 
+						iter != m_shards[i].map.end(); ++iter ) {
+			if ( iter->second->src == ec ) {
+				iter->second->src = NULL;
+			}
+		}
+		pthread_mutex_unlock( &m_shards[i].lock );
+	}
+}
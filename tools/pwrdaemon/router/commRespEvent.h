@@ -22,85 +22,48 @@
 
 namespace PWR_Router {
 
-static inline void fpAdd( void* inout, void* in )
-{
-	*(double*)inout += *(double*)in;
-}
-
 class RtrCommRespEvent: public  CommRespEvent {
   public:
    	RtrCommRespEvent( SerialBuf& buf ) : CommRespEvent( buf ){ }  
 
 	bool process( EventGenerator* _rtr, EventChannel* ) {
 
-		DBGX("id=%p status=%" PRIi32 " grpIndex=%" PRIu64 "\n",
-								(void*)id, status, grpIndex );
-
-        CommReqInfo* info = (CommReqInfo*) id;
-
-		info->respQ[grpIndex].push_back( this );
-
-		if ( info->respQ[grpIndex].size() == info->grpInfo[grpIndex] ) {
-
-            CommRespEvent* resp = static_cast<CommRespEvent*>(info->resp);
-			if ( Get == info->ev->op ) {
-				DBGX("index %" PRIu64 " is ready, num attrs %zu\n",
-										grpIndex, info->valueOp.size() );
-				resp->timeStamp[grpIndex].resize( info->valueOp.size() );
-				resp->value[grpIndex].resize( info->valueOp.size() );
-
-				for ( unsigned i = 0; i < info->valueOp.size(); i++ ) { 
-					resp->value[grpIndex][i] = 0;
-				}
-
-				for ( unsigned j = 0; j < info->respQ[grpIndex].size(); j++ ) {
-					for ( unsigned i = 0; i < info->valueOp.size(); i++ ) { 
-						DBGX( "op=%d \n", info->valueOp[i] );			
-						assert( FP_ADD == info->valueOp[i] );
-
-						fpAdd( &resp->value[grpIndex][i], 
-									&info->respQ[grpIndex][j]->value[0][i] );
-
-						resp->timeStamp[grpIndex][i] = 
-									info->respQ[grpIndex][j]->timeStamp[0][i];
-					}
-				} 
-			}
-			for ( unsigned j = 0; j < info->respQ[grpIndex].size(); j++ ) {
-				resp->errValue.insert( resp->errValue.end(), 
-							info->respQ[grpIndex][j]->errValue.begin(), 
-							info->respQ[grpIndex][j]->errValue.end() );
-				resp->errAttr.insert( resp->errAttr.end(), 
-							info->respQ[grpIndex][j]->errAttr.begin(), 
-							info->respQ[grpIndex][j]->errAttr.end() );
-				resp->errObj.insert( resp->errObj.end(), 
-							info->respQ[grpIndex][j]->errObj.begin(), 
-							info->respQ[grpIndex][j]->errObj.end() );
-
-				if ( j < info->respQ[grpIndex].size() - 1 ) {
-					delete info->respQ[grpIndex][ j ];
-				}
-			}
-			// quiet valgrind
-			resp->grpIndex = 0;
-			resp->commID = 0;
-
-			DBGX("pending %zu\n",info->pending);
-			--info->pending;
+		DBGX("id=%" PRIx64 " status=%" PRIi32 " grpIndex=%" PRIu64 "\n",
+								id, status, grpIndex );
+
+		Router& rtr = *static_cast<Router*>(_rtr);
+		ReqTable& table = rtr.reqTable();
+		EventId reqId = id;
+		size_t grp = grpIndex;
+
+		table.lock( reqId );
+        CommReqInfo* info = table.find( reqId );
+
+		if ( ! info || info->grpDone[grp] ) {
+			// the request ran out of time, it has already been answered or
+			// is about to be once it has been sent to everyone
+			DBGX("late response for %" PRIx64 "\n", reqId );
+			table.unlock( reqId );
+			return true;
+		}
+
+		rtr.stats().memberLatency.add( Router::now() - info->start );
+		info->respQ[grp].push_back( this );
+
+		// reduce() frees the queued responses, this one included
+		if ( info->respQ[grp].size() == info->grpInfo[grp] ) {
+			info->reduce( grp );
 
 			if ( 0 == info->pending ) {
 				DBGX("done send the response\n");
-        		info->src->sendEvent( info->resp );
-				delete info->resp;
-				delete info->ev;
+				table.erase( reqId );
+				info->respond( rtr );
 				delete info;
 			} 
+		}
 
-			return true; 
-
-		} else {
-			return false;
-		} 
+		table.unlock( reqId );
+		return false;
 	}
 };
 
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_COMM_STAT_EVENT_H
+#define _RTR_COMM_STAT_EVENT_H
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <algorithm>
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h>
+#include <statOps.h>
+#include "router.h"
+
+namespace PWR_Router {
+
+// Each member of the comm is asked for its statistic by the server it is
+// on. The results are collected here and sent on one per member, or 
+// reduced to the one the client asked for.
+class RtrCommStatReqEvent: public  CommStatReqEvent {
+  public:
+   	RtrCommStatReqEvent( SerialBuf& buf ) : CommStatReqEvent( buf ) {}  
+
+	bool process(EventGenerator* _rtr, EventChannel* ec) {
+		Router& rtr = *static_cast<Router*>(_rtr);
+		Router::Client& client = *rtr.getClient( ec );
+
+		std::vector< std::vector< ObjID > >* comm = client.getCommList( commID );
+		if ( ! comm ) {
+			DBGX("unknown commID=%" PRIx64 "\n", commID );
+			CommStatRespEvent* resp = new CommStatRespEvent;
+			resp->id = id;
+			resp->status = UnknownComm;
+			ec->sendEvent( resp );
+			delete resp;
+			return true;
+		}
+		std::vector< std::vector< ObjID > >& commList = *comm;
+
+    	CommReqInfo* info = new CommReqInfo;
+		ReqTable& table = rtr.reqTable();
+		EventId reqId = table.newId();
+
+    	DBGX("commID=%" PRIx64 " eventId=%" PRIx64 " new eventId=%" PRIx64 "\n",
+                                commID, id, reqId );
+
+    	info->src = ec;
+    	info->ev = this;
+		info->start = Router::now();
+		// set as each member's value arrives 
+		info->grpDone.resize( commList.size(), false );
+		// one for each member and one for the sender, which holds the
+		// request while it is sent to everyone
+		info->pending = commList.size() + 1;
+
+		CommStatRespEvent* resp = new CommStatRespEvent;
+        resp->id = id;
+		resp->value.resize( commList.size(), 0 );
+		resp->startTime.resize( commList.size(), 0 );
+		resp->stopTime.resize( commList.size(), 0 );
+		resp->instant.resize( commList.size(), PWR_TIME_UNINIT );
+		info->resp = resp;
+
+        id = reqId;
+
+		// the sends may block, they are made without the lock
+		table.lock( reqId );
+		table.insert( reqId, info );
+		table.unlock( reqId );
+
+        for ( unsigned int i=0; i <  commList.size(); i++ ) {
+			// the stat of an object with more than one source is not 
+			// something the stats of its sources can give us
+			if ( 1 != commList[i].size() ) {
+				table.lock( reqId );
+				failMember( info, i, commList[i][0], PWR_RET_FAILURE );
+				table.unlock( reqId );
+				continue;
+			}
+			grpIndex = i;
+			if ( ! rtr.sendEvent( commList[i][0], this ) ) {
+				table.lock( reqId );
+				failMember( info, i, commList[i][0], PWR_RET_IPC );
+				table.unlock( reqId );
+			}
+        }
+
+		table.lock( reqId );
+		if ( 0 == --info->pending ) {
+			table.erase( reqId );
+			respond( rtr, info );
+			delete info;
+		}
+		table.unlock( reqId );
+		return false;
+	}
+
+	// fold the members into the one value the client asked for and send
+	// the response, frees the request and response
+	static void respond( Router& rtr, CommReqInfo* info ) {
+		CommStatRespEvent* resp = static_cast<CommStatRespEvent*>(info->resp);
+		CommStatReqEvent* req = static_cast<CommStatReqEvent*>(info->ev);
+		StatOpFuncPtr op = getStatOp( req->reduce );
+
+		if ( op ) {
+			std::vector<double> values;
+			std::vector<size_t> members;
+			for ( size_t i = 0; i < info->grpDone.size(); i++ ) {
+				if ( info->grpDone[i] ) {
+					values.push_back( resp->value[i] );
+					members.push_back( i );
+				}
+			}
+			reduce( resp, op, values, members );
+		}
+
+		rtr.stats().requestLatency.add( Router::now() - info->start );
+		if ( info->src ) {
+			info->src->sendEvent( resp );
+		}
+		delete resp;
+		delete req;
+	}
+
+  private:
+	static void reduce( CommStatRespEvent* resp, StatOpFuncPtr op,
+				std::vector<double>& values, std::vector<size_t>& members ) {
+		std::vector<double> value;
+		std::vector<PWR_Time> start, stop, instant;
+
+		if ( ! values.empty() ) {
+			int pos;
+			value.push_back( op( values, pos ) );
+
+			if ( pos > -1 ) {
+				size_t i = members[pos];
+				resp->index = i;
+				start.push_back( resp->startTime[i] );
+				stop.push_back( resp->stopTime[i] );
+				instant.push_back( resp->instant[i] );
+			} else {
+				// no one member, the window covers them all
+				start.push_back( resp->startTime[ members[0] ] );
+				stop.push_back( resp->stopTime[ members[0] ] );
+				instant.push_back( PWR_TIME_UNINIT );
+				for ( size_t j = 1; j < members.size(); j++ ) {
+					start[0] = std::min( start[0], resp->startTime[members[j]] );
+					stop[0] = std::max( stop[0], resp->stopTime[members[j]] );
+				}
+			}
+		}
+		resp->value.swap( value );
+		resp->startTime.swap( start );
+		resp->stopTime.swap( stop );
+		resp->instant.swap( instant );
+	}
+
+	void failMember( CommReqInfo* info, size_t grp, ObjID& obj, int error ) {
+		DBGX("no stat from `%s`\n", obj.c_str() );
+		CommStatRespEvent* resp = static_cast<CommStatRespEvent*>(info->resp);
+		resp->errObj.push_back( obj );
+		resp->errAttr.push_back( attrName );
+		resp->errValue.push_back( error );
+		--info->pending;
+	}
+};
+
+class RtrCommStatRespEvent: public  CommStatRespEvent {
+  public:
+   	RtrCommStatRespEvent( SerialBuf& buf ) : CommStatRespEvent( buf ) {}  
+
+	bool process(EventGenerator* _rtr, EventChannel* ec) {
+
+        DBGX("id=%" PRIx64 " status=%d grpIndex=%" PRIu64 "\n", 
+												id, status, grpIndex );
+
+		Router& rtr = *static_cast<Router*>(_rtr);
+		ReqTable& table = rtr.reqTable();
+		EventId reqId = id;
+
+		table.lock( reqId );
+        CommReqInfo* info = table.find( reqId );
+		if ( ! info ) {
+			DBGX("late response for %" PRIx64 "\n", reqId );
+			table.unlock( reqId );
+			return true;
+		}
+
+		rtr.stats().memberLatency.add( Router::now() - info->start );
+
+		CommStatRespEvent* resp = static_cast<CommStatRespEvent*>(info->resp);
+		if ( ! value.empty() ) {
+			resp->value[grpIndex] = value[0];
+			resp->startTime[grpIndex] = startTime[0];
+			resp->stopTime[grpIndex] = stopTime[0];
+			resp->instant[grpIndex] = instant[0];
+			info->grpDone[grpIndex] = true;
+		}
+		resp->errObj.insert( resp->errObj.end(), 
+									errObj.begin(), errObj.end() );
+		resp->errAttr.insert( resp->errAttr.end(), 
+									errAttr.begin(), errAttr.end() );
+		resp->errValue.insert( resp->errValue.end(), 
+									errValue.begin(), errValue.end() );
+
+		if ( 0 == --info->pending ) {
+			table.erase( reqId );
+			RtrCommStatReqEvent::respond( rtr, info );
+			delete info;
+		}
+		table.unlock( reqId );
+		return true;
+	}
+};
+
+}
+
+#endif
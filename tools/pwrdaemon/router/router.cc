@@ -14,6 +14,9 @@
 #include <string.h>
 #include <inttypes.h>
 #include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdio.h>
 #include <string>
 #include <fstream>
 #include <debug.h>
@@ -33,8 +36,27 @@ Router::Router( int argc, char* argv[] ) :
     m_client( this, &Router::addClientChan, &Router::delClientChan ),
     m_server( this, &Router::addServerChan, &Router::delServerChan ),
     m_router( this, &Router::addRouterChan, &Router::delRouterChan ),
-    m_chanSelect(NULL)
+    m_chanSelect(NULL),
+	m_nextIoThread(0),
+	m_routerCore(NULL),
+	m_nextServerId(1)
 {
+	pthread_mutex_init( &m_lock, NULL );
+	pthread_rwlock_init( &m_routeLock, NULL );
+
+	// seeded from the clock so a restarted router's updates are newer 
+	// than the ones its peers kept from before
+	struct timespec ts;
+	clock_gettime( CLOCK_REALTIME, &ts );
+	m_routeSeq = (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+	pthread_mutex_init( &m_deadlineLock, NULL );
+
+	pthread_condattr_t attr;
+	pthread_condattr_init( &attr );
+	pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+	pthread_cond_init( &m_deadlineCond, &attr );
+	pthread_condattr_destroy( &attr );
+
     if ( NULL != getenv( "POWERAPI_DEBUG" ) ) {
         _DbgFlags = atoi( getenv( "POWERAPI_DEBUG" ) );
     }
@@ -42,6 +64,17 @@ Router::Router( int argc, char* argv[] ) :
 
 	m_chanSelect = getChannelSelect( "TCP" );
 
+	m_collapse.setWindow( (PWR_Time) m_args.collapseWindow * 1000000 );
+
+	// thread 0 is the thread that calls work(), it also owns the listen
+	// and router link channels
+	m_ioThreads.resize( m_args.numThreads );
+	for ( unsigned i = 0; i < m_ioThreads.size(); i++ ) {
+		m_ioThreads[i].rtr = this;
+		m_ioThreads[i].sel = i ? getChannelSelect( "TCP" ) : m_chanSelect;
+		m_ioThreads[i].admission.init( m_args.clientRate, m_args.clientBurst );
+	}
+
 	Args& args= m_args;
 
     struct utsname buf;
@@ -56,6 +89,7 @@ Router::Router( int argc, char* argv[] ) :
     	EventChannel* clientChan =
                 getEventChannel( "TCP", allocClientEvent, 
 						"listenPort=" + args.clientPort, "client-listen" );
+		clientChan->setStats( &m_stats.chan[RouterStats::ClientChan] );
     	m_chanSelect->addChannel( clientChan,
 				new AcceptData<EventData>(clientChan, &m_client ) );
 	}
@@ -63,6 +97,7 @@ Router::Router( int argc, char* argv[] ) :
     	EventChannel* serverChan =
                 getEventChannel( "TCP", allocServerEvent, 
 						"listenPort=" + args.serverPort, "server-listen" );
+		serverChan->setStats( &m_stats.chan[RouterStats::ServerChan] );
     	m_chanSelect->addChannel( serverChan,
 				new AcceptData<EventData>(serverChan, &m_server ) );
 	}
@@ -76,7 +111,9 @@ Router::Router( int argc, char* argv[] ) :
 		m_routerCore = new TreeCore( m_args.coreArgs, this );
 	}
 
-	initRouteTable( m_args.routeTable );
+	if ( ! m_args.routeTable.empty() ) {
+		initRouteTable( m_args.routeTable );
+	}
 }
 
 void Router::initRouteTable( std::string file )
@@ -100,77 +137,520 @@ void Router::initRouteTable( std::string file )
 		DBGX("%s %d %d\n",tmpStr.substr(0,pos1).c_str(), rtrID, srvrID );
 
 		m_routeTable[ tmpStr.substr( 0, pos1)  ] = APP_ID( rtrID, srvrID );  
+
+		// servers that are not in the file are numbered after these
+		if ( rtrID == m_args.rtrId && (ServerID) -1 != srvrID && 
+									srvrID >= m_nextServerId ) {
+			m_nextServerId = srvrID + 1;
+		}
+	}
+}
+
+void Router::addServer( ServerConnectEvent& ev, EventChannel* ec )
+{
+	std::vector<ObjID> objects = ev.objects;
+	// an older server only sends its root
+	if ( objects.empty() ) {
+		objects.push_back( ev.name );
+	}
+
+	// keep the ID the route file gave one of its roots, if it has one, an
+	// ancestor's ID is that server's and would replace its routes
+	AppID id = -1;
+	pthread_rwlock_rdlock( &m_routeLock );
+	for ( unsigned i = 0; i < objects.size(); i++ ) {
+		std::map< std::string, AppID >::iterator iter = 
+									m_routeTable.find( objects[i] );
+		if ( iter != m_routeTable.end() && 
+				RTR_ID(iter->second) == m_args.rtrId &&
+				(ServerID) -1 != SERVER_ID(iter->second) ) {
+			id = iter->second;
+			break;
+		}
+	}
+	pthread_rwlock_unlock( &m_routeLock );
+
+	pthread_mutex_lock( &m_lock );
+	ServerID srvrID;
+	if ( (AppID) -1 != id && RTR_ID(id) == m_args.rtrId &&
+							(ServerID) -1 != SERVER_ID(id) ) {
+		srvrID = SERVER_ID(id);
+	} else if ( m_serverIds.find( ev.name ) != m_serverIds.end() ) {
+		srvrID = m_serverIds[ ev.name ];
+	} else {
+		srvrID = m_nextServerId++;
+		m_serverIds[ ev.name ] = srvrID;
+	}
+
+	DBGX("rootObj=`%s` rtrId=%d serverId=%d\n",
+			ev.name.c_str(), m_args.rtrId, srvrID );
+
+	m_localMap[ srvrID ] = ec;
+	m_serverMap[ ec ]->init( ev.name, srvrID );
+	pthread_mutex_unlock( &m_lock );
+
+	announce( APP_ID( m_args.rtrId, srvrID ), RouteUpdateEvent::Add, objects );
+
+	pthread_mutex_lock( &m_lock );
+	doPending( srvrID );
+	pthread_mutex_unlock( &m_lock );
+}
+
+void Router::delServer( ServerID id )
+{
+	DBGX("serverId=%d\n",id);
+
+	pthread_mutex_lock( &m_lock );
+	m_localMap.erase( id );
+	pthread_mutex_unlock( &m_lock );
+
+	announce( APP_ID( m_args.rtrId, id ), RouteUpdateEvent::Del, 
+											std::vector<ObjID>() );
+}
+
+void Router::announce( AppID server, int op, const std::vector<ObjID>& objects )
+{
+	RouteUpdateEvent ev;
+	ev.op = op;
+	ev.origin = m_args.rtrId;
+	ev.seq = __sync_add_and_fetch( &m_routeSeq, 1 );
+	ev.server = server;
+	ev.objects = objects;
+
+	if ( applyRoute( ev ) ) {
+		floodRoute( ev );
 	}
 }
 
+// false if we already have this update or a newer one
+bool Router::applyRoute( RouteUpdateEvent& ev )
+{
+	DBGX("op=%d origin=%d seq=%" PRIu64 " server=%" PRIx64 "\n", ev.op,
+						ev.origin, ev.seq, ev.server );
+
+	pthread_rwlock_wrlock( &m_routeLock );
+	Announce& cur = m_announced[ ev.server ];
+	if ( ev.seq <= cur.seq ) {
+		pthread_rwlock_unlock( &m_routeLock );
+		return false;
+	}
+
+	// another server may have claimed the object since
+	for ( unsigned i = 0; cur.live && i < cur.objects.size(); i++ ) {
+		std::map< std::string, AppID >::iterator iter = 
+							m_routeTable.find( cur.objects[i] );
+		if ( iter != m_routeTable.end() && iter->second == ev.server ) {
+			m_routeTable.erase( iter );
+		}
+	}
+
+	cur.seq = ev.seq;
+	cur.live = RouteUpdateEvent::Add == ev.op;
+	cur.objects = ev.objects;
+
+	for ( unsigned i = 0; cur.live && i < cur.objects.size(); i++ ) {
+		m_routeTable[ cur.objects[i] ] = ev.server;
+	}
+	pthread_rwlock_unlock( &m_routeLock );
+
+	// the subscriptions of our clients stop waiting for it
+	if ( RouteUpdateEvent::Del == ev.op ) {
+		m_subs.dropServer( ev.server );
+	}
+	return true;
+}
+
+void Router::floodRoute( RouteUpdateEvent& ev )
+{
+	if ( NULL == m_routerCore ) {
+		return;
+	}
+	std::vector<EventChannel*> links;
+	m_routerCore->getLinks( links );
+	for ( unsigned i = 0; i < links.size(); i++ ) {
+		links[i]->sendEvent( &ev );
+	}
+}
+
+void Router::routeUpdate( RouteUpdateEvent& ev, EventChannel* ec )
+{
+	if ( RouteUpdateEvent::Sync != ev.op ) {
+		if ( applyRoute( ev ) ) {
+			floodRoute( ev );
+		}
+		return;
+	}
+
+	// a router has connected to us, tell it everything we know
+	std::vector<RouteUpdateEvent> updates;
+	pthread_rwlock_rdlock( &m_routeLock );
+	std::map< AppID, Announce >::iterator iter = m_announced.begin();
+	for ( ; iter != m_announced.end(); ++iter ) {
+		if ( ! iter->second.live ) {
+			continue;
+		}
+		updates.resize( updates.size() + 1 );
+		updates.back().op = RouteUpdateEvent::Add;
+		updates.back().origin = RTR_ID( iter->first );
+		updates.back().seq = iter->second.seq;
+		updates.back().server = iter->first;
+		updates.back().objects = iter->second.objects;
+	}
+	pthread_rwlock_unlock( &m_routeLock );
+
+	for ( unsigned i = 0; i < updates.size(); i++ ) {
+		ec->sendEvent( &updates[i] );
+	}
+}
+
+// Connect our links and ask the routers at the other end what they know. 
+// This runs before we service any channel so the replies are seen.
+void Router::syncLinks()
+{
+	RouteUpdateEvent ev;
+	ev.op = RouteUpdateEvent::Sync;
+	ev.origin = m_args.rtrId;
+	floodRoute( ev );
+}
+
 int Router::work()
 {
-	SelectData* data;
+	for ( unsigned i = 1; i < m_ioThreads.size(); i++ ) {
+		DBGX("start I/O thread %d\n",i);
+		int rc = pthread_create( &m_ioThreads[i].thread, NULL, 
+								ioThread, &m_ioThreads[i] );
+		assert( 0 == rc );
+	}
 
-    while ( ( data = static_cast<SelectData*>( m_chanSelect->wait() ) ) ) {
-        if ( data->process( m_chanSelect, this ) ) {
-            delete data;
-        }
-    }
+	syncLinks();
+
+	int rc = pthread_create( &m_deadlineThread, NULL, deadlineThread, this );
+	assert( 0 == rc );
+
+	if ( ! m_args.statsFile.empty() ) {
+		rc = pthread_create( &m_statsThread, NULL, statsThread, this );
+		assert( 0 == rc );
+	}
+
+	return doWork( m_ioThreads[0] );
+}
+
+PWR_Time Router::now()
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (PWR_Time) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void Router::addDeadline( PWR_Time when, EventId reqId )
+{
+	pthread_mutex_lock( &m_deadlineLock );
+	bool first = m_deadlines.empty() || when < m_deadlines.begin()->first;
+	m_deadlines.insert( std::make_pair( when, reqId ) );
+	if ( first ) {
+		pthread_cond_signal( &m_deadlineCond );
+	}
+	pthread_mutex_unlock( &m_deadlineLock );
+}
+
+void* Router::deadlineThread( void* arg )
+{
+	static_cast<Router*>(arg)->expireDeadlines();
+	return NULL;
+}
+
+void Router::expireDeadlines()
+{
+	pthread_mutex_lock( &m_deadlineLock );
+	while ( 1 ) {
+		if ( m_deadlines.empty() ) {
+			pthread_cond_wait( &m_deadlineCond, &m_deadlineLock );
+			continue;
+		}
+
+		PWR_Time when = m_deadlines.begin()->first;
+		if ( when > now() ) {
+			struct timespec ts;
+			ts.tv_sec = when / 1000000000;
+			ts.tv_nsec = when % 1000000000;
+			pthread_cond_timedwait( &m_deadlineCond, &m_deadlineLock, &ts );
+			continue;
+		}
+
+		EventId reqId = m_deadlines.begin()->second;
+		m_deadlines.erase( m_deadlines.begin() );
+		pthread_mutex_unlock( &m_deadlineLock );
+
+		// the request may have completed on time, in which case it
+		// is no longer in the table
+		m_reqTable.lock( reqId );
+		CommReqInfo* info = m_reqTable.find( reqId );
+		if ( info ) {
+			DBGX("request %" PRIx64 " missed its deadline\n", reqId );
+			__sync_fetch_and_add( &m_stats.timeouts, 1 );
+			info->expire();
+			// a request still being sent is answered by its sender
+			if ( 0 == info->pending ) {
+				m_reqTable.erase( reqId );
+				info->respond( *this );
+				delete info;
+			}
+		}
+		m_reqTable.unlock( reqId );
+
+		pthread_mutex_lock( &m_deadlineLock );
+	}
+	return;
+}
+
+void Router::getStats( std::vector<std::string>& name, 
+										std::vector<uint64_t>& value )
+{
+	for ( int i = 0; i < RouterStats::NUM_CHAN_TYPES; i++ ) {
+		std::string prefix = std::string( RouterStats::chanName(i) ) + ".";
+		ChannelStats& chan = m_stats.chan[i];
+
+		name.push_back( prefix + "eventsIn" );
+		value.push_back( chan.eventsIn );
+		name.push_back( prefix + "eventsOut" );
+		value.push_back( chan.eventsOut );
+		name.push_back( prefix + "bytesIn" );
+		value.push_back( chan.bytesIn );
+		name.push_back( prefix + "bytesOut" );
+		value.push_back( chan.bytesOut );
+	}
+
+	uint64_t pending = 0;
+	uint64_t pendingMax = 0;
+	pthread_mutex_lock( &m_lock );
+	std::map< AppID, std::deque< Event*> >::iterator iter;
+	for ( iter = m_pendingEvents.begin(); iter != m_pendingEvents.end(); 
+																++iter ) {
+		pending += iter->second.size();
+		if ( iter->second.size() > pendingMax ) {
+			pendingMax = iter->second.size();
+		}
+	}
+	name.push_back( "clients" );
+	value.push_back( m_clientMap.size() );
+	name.push_back( "servers" );
+	value.push_back( m_localMap.size() );
+	pthread_mutex_unlock( &m_lock );
+
+	pthread_rwlock_rdlock( &m_routeLock );
+	name.push_back( "routes" );
+	value.push_back( m_routeTable.size() );
+	pthread_rwlock_unlock( &m_routeLock );
+
+	name.push_back( "pending.events" );
+	value.push_back( pending );
+	name.push_back( "pending.maxPerServer" );
+	value.push_back( pendingMax );
+
+	name.push_back( "pending.bytes" );
+	value.push_back( m_stats.pendingBytes );
+	name.push_back( "pending.dropped" );
+	value.push_back( m_stats.pendingDropped );
+
+	name.push_back( "comms" );
+	value.push_back( m_stats.comms );
+	name.push_back( "comms.bytes" );
+	value.push_back( m_stats.commBytes );
+	name.push_back( "comms.evicted" );
+	value.push_back( m_stats.commsEvicted );
+
+	name.push_back( "requests.inFlight" );
+	value.push_back( m_reqTable.size() );
+	name.push_back( "requests.timeouts" );
+	value.push_back( m_stats.timeouts );
+	name.push_back( "admission.throttled" );
+	value.push_back( m_stats.throttled );
+
+	m_stats.requestLatency.report( "latency.request", name, value );
+	m_stats.memberLatency.report( "latency.member", name, value );
+}
+
+void* Router::statsThread( void* arg )
+{
+	static_cast<Router*>(arg)->dumpStats();
+	return NULL;
+}
+
+// rewrite the stats file every statsPeriod seconds, the rename keeps 
+// readers from seeing a partial file
+void Router::dumpStats()
+{
+	std::string tmpFile = m_args.statsFile + ".tmp";
+
+	while ( 1 ) {
+		sleep( m_args.statsPeriod );
+
+		std::vector<std::string> name;
+		std::vector<uint64_t> value;
+		getStats( name, value );
+
+		FILE* fp = fopen( tmpFile.c_str(), "w" );
+		if ( NULL == fp ) {
+			printf("can't write stats file `%s`\n", tmpFile.c_str() );
+			continue;
+		}
+		for ( unsigned i = 0; i < name.size(); i++ ) {
+			fprintf( fp, "%s %" PRIu64 "\n", name[i].c_str(), value[i] );
+		}
+		fclose( fp );
+		rename( tmpFile.c_str(), m_args.statsFile.c_str() );
+	}
+}
+
+void* Router::ioThread( void* arg )
+{
+	IoThread* info = (IoThread*) arg;
+	info->rtr->doWork( *info );
+	return NULL;
+}
+
+// Read everything that is ready before processing any of it so the most
+// urgent events go first. Reading is bounded so a busy channel can't keep
+// us from processing. 
+int Router::doWork( IoThread& io )
+{
+	enum { MAX_GATHER = 64 };
+
+	while ( 1 ) {
+		int64_t timeout = -1;
+		PWR_Time next = io.admission.release( io.queue, now() );
+		if ( next ) {
+			PWR_Time cur = now();
+			timeout = next > cur ? next - cur : 0;
+		}
+
+		SelectData* data = static_cast<SelectData*>( io.sel->wait( timeout ) );
+		for ( unsigned i = 0; data && i < MAX_GATHER; i++ ) { 
+			if ( data->process( io ) ) {
+				delete data;
+			}
+			data = static_cast<SelectData*>( io.sel->wait( 0 ) );
+		}
+		if ( data && data->process( io ) ) {
+			delete data;
+		}
+
+		io.admission.release( io.queue, now() );
+		drain( io );
+	}
 	return 0;
 }
 
+void Router::drain( IoThread& io )
+{
+	EventQueue::Item item;
+	while ( io.queue.pop( item ) ) {
+		if ( item.ev->process( static_cast<EventGenerator*>(this), 
+													item.chan ) ) {
+			delete item.ev;
+		}
+	}
+}
+
 
-void Router::sendEvent( ObjID destObj, Event* ev ) {
+bool Router::sendEvent( ObjID destObj, Event* ev ) {
 	AppID destID = findDestApp( destObj );
 	DBGX("dest=`%s` AppID=%" PRIx64 "\n", destObj.c_str(), destID );
-	if ( (unsigned) -1 == destID ) {
+	if ( (AppID) -1 == destID ) {
 		printf("Could not route %s, drop event\n",destObj.c_str());
-		return;
+		return false;
 	}
-	sendEvent( destID, ev ); 	
+	return sendEvent( destID, ev ); 	
 }
 
-void Router::sendEvent( AppID dest, Event* ev ) {
+bool Router::sendEvent( AppID dest, Event* ev ) {
 
 	ServerID srvrID = SERVER_ID( dest );
 	RouterID rtrID  = RTR_ID( dest );
 	EventChannel* ec = NULL; 
-	Event* rev = NULL;
+	RouterEvent* rev = NULL;
 
 	DBGX("rtr=%d srvr=%d\n",rtrID, srvrID );
 	if ( rtrID == m_args.rtrId ) {
 		DBGX("local channel\n");
+		pthread_mutex_lock( &m_lock );
 		ec = findServerChan( srvrID ); 
+		pthread_mutex_unlock( &m_lock );
 	} else {
 		DBGX("router channel\n");
 		ec = findRtrChan( rtrID );
-		assert(ec);
+		if ( ! ec ) {
+			printf("No link toward router %u, drop event\n", rtrID );
+			return false;
+		}
 	}
 
 	if ( ev->type == Router2Router ) {
-		RouterEvent* rev = static_cast<RouterEvent*>(ev);
+		RouterEvent* tmp = static_cast<RouterEvent*>(ev);
 		DBGX("is RouterEvent\n");
 
 		if ( rtrID == m_args.rtrId && (unsigned) -1 == srvrID ) {
-			Event* pev = rev->getPayload( allocServerEvent );
+			Event* pev = tmp->getPayload( allocServerEvent );
 			DBGX("call process\n");
 			if ( pev->process( this ) ) {
 				delete pev;
 			}
-			return;
+			return true;
 		} 
 
+		// the caller owns ev, a queued event must outlive it
+		if ( ! ec ) {
+			rev = new RouterEvent( *tmp );
+		}
 	} else {
 		DBGX("rtrId %d\n",m_args.rtrId);
 		AppID src = APP_ID( m_args.rtrId, -1 );
 		DBGX("create RouterEvent src=%#" PRIx64 " dest=%#" PRIx64 "\n",src,dest);
 		rev = new RouterEvent( src, dest, ev );
-		ev = rev;
 	}
 
+	bool retval = true;
 	if ( ! ec ) {
-		m_pendingEvents[srvrID].push_back( ev );
-		DBGX("add pending %d\n",srvrID);
-	} else {
-		ec->sendEvent( ev );
-		if ( rev ) {
-			delete rev;
+		pthread_mutex_lock( &m_lock );
+		// the server may have connected since we looked
+		ec = findServerChan( srvrID );
+		if ( ! ec ) {
+			std::deque< Event* >& queue = m_pendingEvents[srvrID];
+			if ( m_args.maxPending && queue.size() >= m_args.maxPending ) {
+				DBGX("pending queue for %d is full, drop\n",srvrID);
+				__sync_fetch_and_add( &m_stats.pendingDropped, 1 );
+				delete rev;
+				retval = false;
+			} else {
+				DBGX("add pending %d\n",srvrID);
+				__sync_fetch_and_add( &m_stats.pendingBytes, 
+											rev->payload.buf.size() );
+				queue.push_back( rev );
+			}
+			rev = NULL;
+		}
+		pthread_mutex_unlock( &m_lock );
+	}
+
+	if ( ec ) {
+		ec->sendEvent( rev ? rev : ev );
+		delete rev;
+	}
+	return retval;
+}
+
+void Router::unsubscribe( EventId subId, SubTable::Members& members )
+{
+	DBGX("subId=%" PRIx64 "\n", subId );
+
+	CommSubscribeEvent ev;
+	ev.op = CommEvent::Stop;
+	ev.id = subId;
+	for ( size_t i = 0; i < members.size(); i++ ) {
+		for ( size_t j = 0; j < members[i].size(); j++ ) {
+			ev.grpIndex = i;
+			ev.memberIndex = j;
+			sendEvent( members[i][j], &ev );
 		}
 	}
 }
@@ -187,7 +667,10 @@ void Router::doPending( ServerID id )
 	DBGX("have pending for server %d\n",id);
 	while ( ! m_pendingEvents[id].empty() ) {
 		DBGX("sent pending %d\n",id);
-		ec->sendEvent( m_pendingEvents[id].front() );	
+		RouterEvent* ev = static_cast<RouterEvent*>(m_pendingEvents[id].front());
+		ec->sendEvent( ev );	
+		__sync_fetch_and_sub( &m_stats.pendingBytes, ev->payload.buf.size() );
+		delete ev;
 		m_pendingEvents[id].pop_front();
 	}
 	m_pendingEvents.erase(id);
@@ -223,7 +706,9 @@ static void initArgs( int argc, char* argv[], Args* args )
 {
     int opt = 0;
     int long_index = 0;
-    enum { CLNT_PORT, SRVR_PORT, RTR_TYPE, RTR_INFO, RTR_ID, PWRAPI_CONFIG, RTR_TABLE };
+    enum { CLNT_PORT, SRVR_PORT, RTR_TYPE, RTR_INFO, RTR_ID, PWRAPI_CONFIG, RTR_TABLE,
+			RTR_THREADS, RTR_COLLAPSE, RTR_STATS_FILE, RTR_STATS_PERIOD,
+			RTR_MAX_COMMS, RTR_MAX_PENDING, RTR_CLIENT_RATE, RTR_CLIENT_BURST };
     static struct option long_options[] = {
         {"clientPort"           , required_argument, NULL, CLNT_PORT },
         {"serverPort"           , required_argument, NULL, SRVR_PORT },
@@ -231,6 +716,14 @@ static void initArgs( int argc, char* argv[], Args* args )
         {"routerInfo"           , required_argument, NULL, RTR_INFO },
         {"routerId"             , required_argument, NULL, RTR_ID },
         {"routeTable"           , required_argument, NULL, RTR_TABLE },
+        {"threads"              , required_argument, NULL, RTR_THREADS },
+        {"collapseWindow"       , required_argument, NULL, RTR_COLLAPSE },
+        {"statsFile"            , required_argument, NULL, RTR_STATS_FILE },
+        {"statsPeriod"          , required_argument, NULL, RTR_STATS_PERIOD },
+        {"maxComms"             , required_argument, NULL, RTR_MAX_COMMS },
+        {"maxPending"           , required_argument, NULL, RTR_MAX_PENDING },
+        {"clientRate"           , required_argument, NULL, RTR_CLIENT_RATE },
+        {"clientBurst"          , required_argument, NULL, RTR_CLIENT_BURST },
         {0,0,0,0}
     };
 
@@ -250,6 +743,41 @@ static void initArgs( int argc, char* argv[], Args* args )
           case RTR_TABLE:
             args->routeTable = optarg;
             break;
+          case RTR_THREADS:
+            args->numThreads = atoi(optarg);
+			if ( 0 == args->numThreads ) {
+				args->numThreads = 1;
+			}
+            break;
+          case RTR_COLLAPSE:
+			// milliseconds, negative turns off collapsing 
+            args->collapseWindow = atoi(optarg);
+            break;
+          case RTR_STATS_FILE:
+            args->statsFile = optarg;
+            break;
+          case RTR_STATS_PERIOD:
+			// seconds
+            args->statsPeriod = atoi(optarg);
+			if ( args->statsPeriod <= 0 ) {
+				args->statsPeriod = 1;
+			}
+            break;
+          case RTR_MAX_COMMS:
+			// per client
+            args->maxComms = atoi(optarg);
+            break;
+          case RTR_MAX_PENDING:
+			// per server
+            args->maxPending = atoi(optarg);
+            break;
+          case RTR_CLIENT_RATE:
+			// events per second
+            args->clientRate = atof(optarg);
+            break;
+          case RTR_CLIENT_BURST:
+            args->clientBurst = atof(optarg);
+            break;
           case RTR_TYPE:
 			assert( ! args->coreArgs ); 
 			if ( 0 == strcmp( optarg, "torus" ) ) {
@@ -276,8 +804,7 @@ static void initArgs( int argc, char* argv[], Args* args )
         }
     }
 
-    if ( (RouterID) -1 == args->rtrId 
-		|| args->routeTable.empty() ) {
+    if ( (RouterID) -1 == args->rtrId ) {
         print_usage();
         exit(-1);
     }
@@ -316,19 +843,39 @@ void initTreeInfo( TreeArgs* args, std::string info )
 
 }
 
+// dim:posPort:negSrvr:negSrvrPort[:size[:negPort:posSrvr:posSrvrPort]]
 void initTorusInfo( TorusArgs* args, std::string info )
 {
-    size_t pos = info.find_first_of(':');
-    unsigned int dim = atoi( info.substr( 0, pos ).c_str() );
-	args->dim.resize(dim+1);
-    if ( dim < args->dim.size() ) {
-    	info = info.substr(pos+1);
-        pos = info.find_first_of(':');
-        args->dim[ dim ].posPort = info.substr( 0, pos );
-        info = info.substr(pos+1);
-        pos = info.find_first_of(':');
-        args->dim[ dim ].negSrvr = info.substr( 0,pos );
-        info = info.substr(pos+1);
-        args->dim[ dim ].negSrvrPort = info.substr( 0,pos+1 );
+	std::vector< std::string > field;
+	size_t pos;
+	do {
+		pos = info.find_first_of(':');
+		field.push_back( info.substr( 0, pos ) );
+		info = info.substr( pos + 1 );
+	} while ( pos != std::string::npos );
+
+	if ( field.size() < 4 ) {
+		printf("bad torus routerInfo\n");
+		print_usage();
+		exit(-1);
+	}
+
+    unsigned int dim = atoi( field[0].c_str() );
+	if ( dim >= args->dim.size() ) {
+		args->dim.resize(dim+1);
+	}
+
+	Dim& d = args->dim[ dim ];
+	d.posPort = field[1];
+	d.negSrvr = field[2];
+	d.negSrvrPort = field[3];
+
+	if ( field.size() > 4 ) {
+		d.size = atoi( field[4].c_str() );
+	}
+	if ( field.size() > 7 ) {
+		d.negPort = field[5];
+		d.posSrvr = field[6];
+		d.posSrvrPort = field[7];
 	}
 }
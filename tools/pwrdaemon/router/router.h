@@ -15,9 +15,11 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
+#include <pthread.h>
 #include <map>
 #include <vector>
 #include <set>
+#include <list>
 #include "routerSelect.h"
 #include "debug.h"
 #include "events.h"
@@ -27,6 +29,9 @@
 #include "commCreateEvent.h"
 #include "routerCore.h"
 #include "impTypes.h"
+#include "collapse.h"
+#include "subscriptions.h"
+#include "stats.h"
 
 typedef uint32_t ServerID;
 
@@ -41,8 +46,21 @@ namespace PWR_Router {
 
 
 struct Args {
-    Args( ) : rtrId(-1), coreArgs(NULL) { }
+    Args( ) : rtrId(-1), numThreads(1), collapseWindow(0), statsPeriod(10),
+				maxComms(4096), maxPending(4096), clientRate(0), clientBurst(0),
+				coreArgs(NULL) { }
     RouterID   	rtrId;
+	unsigned	numThreads;
+	int			collapseWindow;
+	int			statsPeriod;
+	// per client and per server, 0 is unlimited
+	unsigned	maxComms;
+	unsigned	maxPending;
+	// events per second per client and how many it can send at once,
+	// a rate of 0 is unlimited
+	double		clientRate;
+	double		clientBurst;
+	std::string statsFile;
 	std::string routeTable;
     std::string	serverPort;
     std::string clientPort;
@@ -50,6 +68,64 @@ struct Args {
 	RouterCoreArgs* coreArgs;
 };
 
+struct CommReqInfo;
+
+// In flight requests, keyed by the request ID that goes out to the
+// servers in place of the client's event ID. Responses to different
+// requests are reduced by different I/O threads so the table is split 
+// into shards, each with its own lock. The lock must be held around 
+// any access to a request's CommReqInfo. 
+class ReqTable {
+	enum { NUM_SHARDS = 64 };
+	struct Shard {
+		Shard() { pthread_mutex_init( &lock, NULL ); }
+		pthread_mutex_t 				lock;
+		std::map<EventId,CommReqInfo*>	map;
+	};
+  public:
+	ReqTable() : m_nextId(1) {}
+
+	EventId newId() {
+		return __sync_fetch_and_add( &m_nextId, 1 );
+	}
+	void lock( EventId id ) {
+		pthread_mutex_lock( &shard(id).lock );
+	}
+	size_t size() {
+		size_t num = 0;
+		for ( unsigned i = 0; i < NUM_SHARDS; i++ ) {
+			pthread_mutex_lock( &m_shards[i].lock );
+			num += m_shards[i].map.size();
+			pthread_mutex_unlock( &m_shards[i].lock );
+		}
+		return num;
+	}
+	void unlock( EventId id ) {
+		pthread_mutex_unlock( &shard(id).lock );
+	}
+	void insert( EventId id, CommReqInfo* info ) {
+		shard(id).map[id] = info;
+	}
+	CommReqInfo* find( EventId id ) {
+		std::map<EventId,CommReqInfo*>& map = shard(id).map;
+		std::map<EventId,CommReqInfo*>::iterator iter = map.find(id);
+		return iter == map.end() ? NULL : iter->second;
+	}
+	void erase( EventId id ) {
+		shard(id).map.erase(id);
+	}
+	// the requester has gone away, its requests are still reduced but
+	// their responses are dropped
+	void dropChannel( EventChannel* );
+
+  private:
+	Shard& shard( EventId id ) {
+		return m_shards[ id % NUM_SHARDS ];
+	}
+	Shard 		m_shards[NUM_SHARDS];
+	EventId		m_nextId;
+};
+
 class Router : public EventGenerator {
 
 	typedef void (Router::*ChanFuncPtr)(EventChannel*);
@@ -78,59 +154,70 @@ class Router : public EventGenerator {
 		Client( Router& rtr );
 		~Client();
 		void addComm( CommID id, CommCreateEvent* ev );
-		std::vector< std::vector< ObjID > >& getCommList( CommID id );
+		void delComm( CommID id );
+		// NULL if the client never created the comm or it was evicted
+		std::vector< std::vector< ObjID > >* getCommList( CommID id );
 
 	  private:	  
-		std::map<CommID,CommCreateEvent* > m_commMap;
+		struct Comm {
+			CommCreateEvent*			ev;
+			std::list<CommID>::iterator lru;
+			size_t						bytes;
+		};
+		typedef std::map<CommID,Comm> CommMap;
+		void destroyComm( CommMap::iterator );
+
+		CommMap					m_commMap;
+		// most recently used first
+		std::list<CommID>		m_lru;
 		Router& 		m_rtr;
 	};
 
 	class Server {
 	  public:
-		Server( Router& rtr ) :m_rtr(rtr) {
+		Server( Router& rtr ) : m_rtr(rtr), m_id( -1 ) {
 			DBGX("\n");
 		}
 		~Server() {
-			m_rtr.delServer(m_name);
+			if ( (ServerID) -1 != m_id ) {
+				m_rtr.delServer( m_id );
+			}
 		}
-		void initName( std::string name ) {
+		void init( std::string name, ServerID id ) {
 			m_name = name;
+			m_id = id;
 		}
 	  private:
 		Router& 		m_rtr;
 		std::string 	m_name;
+		ServerID		m_id;
 	};
 
   public:
 
 	Router( int, char* [] );
 
-	ServerID addServer( std::string name, EventChannel* ec ) {
-		AppID id = findRoute( name );
-
-		DBGX("rootObj=`%s` rtrId=%d serverId=%d\n",
-			name.c_str(), RTR_ID(id), SERVER_ID(id)  );
-
-		assert( (unsigned) -1 != id );
-
-		m_localMap[ SERVER_ID(id) ] = ec;
-		m_serverMap[ ec ]->initName(name);
-		return SERVER_ID(id);
-	}
+	// the server tells us what it answers for, the routes go to every
+	// router
+	void addServer( ServerConnectEvent&, EventChannel* );
+	void delServer( ServerID );
 
-	void delServer( std::string name ) {
-		DBGX("%s\n",name.c_str());
-		//assert( m_localMap.find(name) != m_localMap.end() );
-		m_localMap.erase( 0 );
-	}
+	// from another router
+	void routeUpdate( RouteUpdateEvent&, EventChannel* );
 
 	Client* getClient( EventChannel* ec ) {
+		pthread_mutex_lock( &m_lock );
 		assert ( m_clientMap.find(ec) != m_clientMap.end() );
-		return m_clientMap[ec];
+		Client* client = m_clientMap[ec];
+		pthread_mutex_unlock( &m_lock );
+		return client;
 	}
 
-	void sendEvent( AppID, Event* );
-	void sendEvent( ObjID, Event* );
+	// false if the event was dropped, either there is no route or the
+	// server's pending queue is full
+	bool sendEvent( AppID, Event* );
+	bool sendEvent( ObjID, Event* );
+	const Args& args() { return m_args; }
 
 	AppID findDestApp( ObjID );
 	int work();
@@ -142,42 +229,118 @@ class Router : public EventGenerator {
 
 	ChannelSelect& chanSelect() { return *m_chanSelect; }
 
-	void doPending( ServerID );
+	// where newly accepted channels are serviced, round robin 
+	// across the I/O threads
+	ChannelSelect* ioSelect() {
+		return m_ioThreads[ m_nextIoThread++ % m_ioThreads.size() ].sel;
+	}
+
+	ReqTable& reqTable() { return m_reqTable; }
+	CollapseTable& collapse() { return m_collapse; }
+	SubTable& subs() { return m_subs; }
+
+	// tell the sources of a subscription to stop pushing
+	void unsubscribe( EventId subId, SubTable::Members& );
+	RouterStats& stats() { return m_stats; }
+
+	// snapshot of the counters, queue depths and histograms
+	void getStats( std::vector<std::string>& name, 
+								std::vector<uint64_t>& value );
+
+	// answer the request with what we have if it is still in flight 
+	// at time when, CLOCK_MONOTONIC
+	void addDeadline( PWR_Time when, EventId reqId );
+	static PWR_Time now();
+
+	bool isClientChan( ChanBase* chan ) { return chan == &m_client; } 
+	bool isRouterChan( ChanBase* chan ) { return chan == &m_router; }
+
+	// process the events the I/O thread has read, most urgent first
+	void drain( IoThread& );
 
   private:
+	static void* ioThread( void* );
+	static void* deadlineThread( void* );
+	static void* statsThread( void* );
+	void dumpStats();
+	int doWork( IoThread& );
+	void expireDeadlines();
+	void doPending( ServerID );
 
 	EventChannel* findRtrChan( RouterID );
 	EventChannel* findServerChan( ServerID );
 
-	AppID findRoute( ObjID id ) {
+	// an object is served by whoever announced its nearest ancestor
+	AppID findRoute( ObjID name ) {
 		AppID retval = -1;
-		if ( m_routeTable.find(id) != m_routeTable.end() ) {
-			retval = m_routeTable[id];
+		std::string id = name;
+		pthread_rwlock_rdlock( &m_routeLock );
+		while ( 1 ) {
+			std::map< std::string, AppID >::iterator iter = 
+										m_routeTable.find( id );
+			if ( iter != m_routeTable.end() ) {
+				retval = iter->second;
+				break;
+			}
+			size_t pos = id.find_last_of( '.' );
+			if ( std::string::npos == pos ) {
+				break;
+			}
+			id.erase( pos );
 		}
-		DBGX("name=`%s` AppID=%" PRIx64 "\n", id.c_str(), retval  )
+		pthread_rwlock_unlock( &m_routeLock );
+		DBGX("name=`%s` AppID=%" PRIx64 "\n", name.c_str(), retval  )
     	return retval;
 	}
 
+	void announce( AppID, int op, const std::vector<ObjID>& );
+	bool applyRoute( RouteUpdateEvent& );
+	void floodRoute( RouteUpdateEvent& );
+	void syncLinks();
+
 	void addClientChan( EventChannel* ec) {
 		DBGX("ec=%p\n",ec);
+		pthread_mutex_lock( &m_lock );
 		m_clientMap[ec] = new Client(*this);
+		pthread_mutex_unlock( &m_lock );
 	}			
 
 	void delClientChan( EventChannel* ec ) {
 		DBGX("ec=%p\n",ec);
-		delete m_clientMap[ec];
+		pthread_mutex_lock( &m_lock );
+		Client* client = m_clientMap[ec];
 		m_clientMap.erase(ec);
+		pthread_mutex_unlock( &m_lock );
+		m_collapse.dropChannel( ec );
+		// responses reduced by other I/O threads must not be sent to
+		// the channel once it is deleted
+		m_reqTable.dropChannel( ec );
+
+		std::vector<EventId> subIds;
+		std::vector<SubTable::Members> members;
+		m_subs.dropChannel( ec, subIds, members );
+		for ( size_t i = 0; i < subIds.size(); i++ ) {
+			unsubscribe( subIds[i], members[i] );
+		}
+		// the client tears down its comms through sendEvent() 
+		delete client;
 	}			
 
 	void addServerChan( EventChannel* ec) {
 		DBGX("ec=%p\n",ec);
+		pthread_mutex_lock( &m_lock );
 		m_serverMap[ec] = new Server(*this);
+		pthread_mutex_unlock( &m_lock );
 	}			
 
 	void delServerChan( EventChannel* ec ) {
 		DBGX("ec=%p\n",ec);
-		delete m_serverMap[ec];
+		pthread_mutex_lock( &m_lock );
+		Server* server = m_serverMap[ec];
 		m_serverMap.erase(ec);
+		pthread_mutex_unlock( &m_lock );
+		// withdraws its routes
+		delete server;
 	}			
 
 	void addRouterChan( EventChannel* ec) {
@@ -192,26 +355,82 @@ class Router : public EventGenerator {
 
   private:
 	ChannelSelect* 			 		m_chanSelect;
+	std::vector<IoThread>			m_ioThreads;
+	unsigned						m_nextIoThread;
+	ReqTable						m_reqTable;
+	CollapseTable					m_collapse;
+	SubTable						m_subs;
+	RouterStats						m_stats;
+	pthread_t						m_statsThread;
+
+	// protects the client, server and local maps and the pending
+	// events, these are shared by all of the I/O threads
+	pthread_mutex_t					m_lock;
+
+	std::multimap<PWR_Time,EventId>	m_deadlines;
+	pthread_t						m_deadlineThread;
+	pthread_mutex_t					m_deadlineLock;
+	pthread_cond_t					m_deadlineCond;
 
 	std::map<EventChannel*,Server*>	m_serverMap;
 	std::map<EventChannel*,Client*>	m_clientMap;
 
 	std::map<ServerID,EventChannel*> m_localMap;
 	RouterCore* 					m_routerCore;
+
+	// object to server, from the route file and from the servers that 
+	// have connected here and at other routers
+	pthread_rwlock_t				m_routeLock;
 	std::map< std::string, AppID >  m_routeTable;
+
+	// the newest update applied for each server, replayed to routers
+	// that ask for a sync
+	struct Announce {
+		Announce() : seq( 0 ), live( false ) {}
+		uint64_t				seq;
+		bool					live;
+		std::vector< ObjID >	objects;
+	};
+	std::map< AppID, Announce >		m_announced;
+	uint64_t						m_routeSeq;
+
+	// IDs for servers that are not in the route file, a server that
+	// reconnects gets its old ID back
+	std::map< std::string, ServerID >	m_serverIds;
+	ServerID						m_nextServerId;
 	std::map< AppID, std::deque< Event*> > 	m_pendingEvents;
 };
 
 struct CommReqInfo {
+	// NULL once the requester has gone away
    	EventChannel*   src;
     CommEvent*      ev;
 	std::vector<size_t>	grpInfo;
+	std::vector<bool>	grpDone;
 
+	// groups not yet reduced, and one for the sender until the request
+	// has been sent to everyone
 	size_t			pending;
 
 	std::vector<ValueOp>		valueOp;
 	std::vector< std::vector< CommRespEvent* > > 	respQ; 
 	CommEvent* resp;
+
+	// when the request arrived, CLOCK_MONOTONIC
+	PWR_Time		start;
+
+	// set if other requesters may be sharing this get
+	std::string		collapseKey;
+
+	// who was asked, only kept if the request has a deadline
+	std::vector< std::vector< ObjID > > members;
+
+	// fold the responses for a group into resp, frees the responses
+	void reduce( size_t grpIndex );
+	// out of time, reduce what we have and flag everyone else 
+	void expire();
+	// send resp to the requester(s), frees the request and response
+	void respond( Router& );
 };
 
 }
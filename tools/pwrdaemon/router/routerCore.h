@@ -13,6 +13,8 @@
 #define _ROUTER_CORE_H
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 class EventChannel;
 class ChannelSelect;
@@ -28,7 +30,10 @@ struct RouterCoreArgs {
 
 class RouterCore {
   public:
+	// the link toward the router, NULL if there is none
     virtual EventChannel* getChannel( RouterID ) = 0;
+	// every link we send on, route updates are flooded over these
+	virtual void getLinks( std::vector<EventChannel*>& ) = 0;
 };
 
 }
@@ -25,6 +25,7 @@ struct RouterEvent : public Event {
 	{	
 		ev->serialize_out( payload );
 	    eventType = (EventType) ev->type;
+		prio = ev->priority();
 	}
 
     RouterEvent( SerialBuf& buf ) {
@@ -34,15 +35,20 @@ struct RouterEvent : public Event {
 	void initPayload( Event* ev ) {
 		ev->serialize_out( payload );
 		eventType = (EventType) ev->type;
+		prio = ev->priority();
 	}
 
 	Event* getPayload( AllocFuncPtr alloc ) {
 		return alloc( eventType, payload ); 
 	}
 
+	// queued by the priority of what we carry
+	EventPriority priority() { return (EventPriority) prio; }
+
     AppID 	src;
     AppID 	dest;
 	EventType	eventType;
+	uint32_t	prio;
 	SerialBuf 	payload;
 
     virtual void serialize_out( SerialBuf& buf ) {
@@ -50,11 +56,13 @@ struct RouterEvent : public Event {
         buf << dest;
         buf << src;
 		buf << eventType;
+		buf << prio;
 		buf << payload.buf;
     }
 
     virtual void serialize_in( SerialBuf& buf ) {
 		buf >> payload.buf;
+		buf >> prio;
 		buf >> eventType;
         buf >> src;
         buf >> dest;
@@ -16,32 +16,43 @@
 
 using namespace PWR_Router;
 
-bool EventData::process( ChannelSelect* sel, Router* rtr ) {
+// router links stay on the main thread, everything else is spread
+// across the I/O threads
+ChannelSelect* PWR_Router::ioSelect( Router* rtr, ChanBase* chan ) {
+	if ( rtr->isRouterChan( chan ) ) {
+		return &rtr->chanSelect();
+	}
+	return rtr->ioSelect();
+}
+
+bool EventData::process( IoThread& io ) {
     Event* event = m_chan->getEvent();
     if ( NULL == event ) {
         DBGX("channel closed\n");
-        sel->delChannel( m_chan );
+		// what it sent before it went away is still processed
+		io.rtr->drain( io );
+		io.admission.drop( m_chan );
+        io.sel->delChannel( m_chan );
         m_rtrChan->del( m_chan );
         delete m_chan;
 		return true;
-    } else {
-        if ( event->process( static_cast<EventGenerator*>(rtr), m_chan ) ) {
-			delete event;
-		}
-		return false;
-    }
+    } 
+	if ( io.admission.enabled() && io.rtr->isClientChan( m_rtrChan ) &&
+			! io.admission.admit( event, m_chan, Router::now() ) ) {
+		__sync_fetch_and_add( &io.rtr->stats().throttled, 1 );
+	} else {
+		io.queue.push( event, m_chan );
+	}
+	return false;
 }
 
-bool RouterData::process( ChannelSelect* sel, Router* rtr ) {
+bool RouterData::process( IoThread& io ) {
     Event* event = m_chan->getEvent();
     if ( NULL == event ) {
         DBGX("channel closed\n");
 		m_chan->close();
 		return false;
-    } else {
-        if ( event->process( static_cast<EventGenerator*>(rtr), m_chan ) ) {
-			delete event;
-		}
-		return false;
-    }
+    } 
+	io.queue.push( event, m_chan );
+	return false;
 }
@@ -12,12 +12,25 @@
 #ifndef _ROUTER_SELECT_H
 #define _ROUTER_SELECT_H
 
+#include <pthread.h>
 #include "eventChannel.h"
+#include "eventQueue.h"
+#include "admission.h"
 
 namespace PWR_Router {
 
 class Router;
 
+// an I/O thread's channels, the events it has read but not yet processed
+// and the client events it is holding back
+struct IoThread {
+	Router*			rtr;
+	ChannelSelect*	sel;
+	pthread_t		thread;
+	EventQueue		queue;
+	Admission		admission;
+};
+
 class ChanBase {
   public:
 	virtual ~ChanBase() {}
@@ -25,12 +38,15 @@ class ChanBase {
 	virtual void del( EventChannel* ) = 0;
 };
 
+// where a newly accepted channel is serviced
+ChannelSelect* ioSelect( Router*, ChanBase* );
+
 class SelectData : public ChannelSelect::Data {
   public:
 	SelectData( EventChannel* chan, ChanBase* rtrChan ) :
 		m_chan( chan ), m_rtrChan( rtrChan )
 	{ }
-	virtual bool process( ChannelSelect*, Router* ) = 0;
+	virtual bool process( IoThread& ) = 0;
 
   protected:
 	EventChannel* m_chan;
@@ -44,12 +60,7 @@ class AcceptData : public SelectData {
         SelectData( chan, rtrChan )
     {}
 
-    bool process( ChannelSelect* sel, Router* rtr ) {
-        EventChannel* newChan = m_chan->accept();
-        sel->addChannel( newChan, new T( newChan, m_rtrChan ) );
-		m_rtrChan->add( newChan );
-        return false;
-    }
+    bool process( IoThread& );
 };
 
 class EventData : public SelectData {
@@ -58,7 +69,7 @@ class EventData : public SelectData {
         SelectData( chan, rtrChan )
 	{}
 
-    bool process( ChannelSelect* sel, Router* rtr );
+    bool process( IoThread& );
 };
 
 class RouterData : public SelectData {
@@ -67,9 +78,21 @@ class RouterData : public SelectData {
         SelectData( chan, rtrChan )
 	{}
 
-    bool process( ChannelSelect* sel, Router* rtr );
+    bool process( IoThread& );
 };
 
+// out of line because it needs the Router class
+template <class T>
+bool AcceptData<T>::process( IoThread& io )
+{
+	EventChannel* newChan = m_chan->accept();
+	// register the channel before its I/O thread can see an event on it
+	m_rtrChan->add( newChan );
+	ioSelect( io.rtr, m_rtrChan )->addChannel( newChan, 
+								new T( newChan, m_rtrChan ) );
+	return false;
+}
+
 }
 
 #endif
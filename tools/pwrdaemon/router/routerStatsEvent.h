@@ -0,0 +1,42 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_ROUTER_STATS_EVENT_H
+#define _RTR_ROUTER_STATS_EVENT_H
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h> 
+#include "router.h"
+
+namespace PWR_Router {
+
+class RtrRouterStatsReqEvent: public  RouterStatsReqEvent {
+  public:
+   	RtrRouterStatsReqEvent( SerialBuf& buf ) : RouterStatsReqEvent( buf ) {}  
+
+	bool process( EventGenerator* _rtr, EventChannel* ec ) {
+        Router& rtr = *static_cast<Router*>(_rtr);
+
+		RouterStatsRespEvent* resp = new RouterStatsRespEvent;
+		resp->id = id;
+		rtr.getStats( resp->name, resp->value );
+
+		DBGX("%zu counters\n", resp->name.size() );
+		ec->sendEvent( resp );
+		delete resp;
+		return true;
+	}
+};
+
+}
+
+#endif
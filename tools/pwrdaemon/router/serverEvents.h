@@ -25,11 +25,19 @@ class RtrServerConnectEvent: public  ServerConnectEvent {
 
 	bool process( EventGenerator* _rtr, EventChannel* ec ) {
         Router& rtr = *static_cast<Router*>(_rtr);
-		ServerID id = rtr.addServer( name, ec );
-
-		rtr.doPending( id );
-//        Router::Server& server = *rtr.getServer( ec );
 		DBGX("%s\n",name.c_str());
+		rtr.addServer( *this, ec );
+		return true;
+	}
+};
+
+class RtrRouteUpdateEvent: public  RouteUpdateEvent {
+  public:
+   	RtrRouteUpdateEvent( SerialBuf& buf ) : RouteUpdateEvent( buf ) {}  
+
+	bool process( EventGenerator* _rtr, EventChannel* ec ) {
+        Router& rtr = *static_cast<Router*>(_rtr);
+		rtr.routeUpdate( *this, ec );
 		return true;
 	}
 };
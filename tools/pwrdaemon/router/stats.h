@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_STATS_H
+#define _RTR_STATS_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <eventChannel.h>
+#include <pwrtypes.h>
+
+namespace PWR_Router {
+
+// latencies bucketed by power of two microseconds, bucket i holds
+// samples less than 2^i us, the last bucket holds everything else
+class Histogram {
+  public:
+	enum { NUM_BUCKETS = 24 };
+
+	Histogram() : m_count(0), m_sum(0) {
+		memset( m_bucket, 0, sizeof(m_bucket) );
+	}
+
+	void add( PWR_Time ns ) {
+		uint64_t us = ns / 1000;
+		unsigned i = 0;
+		while ( i < NUM_BUCKETS - 1 && us >= ( 1ULL << i ) ) {
+			++i;
+		}
+		__sync_fetch_and_add( &m_bucket[i], 1 );
+		__sync_fetch_and_add( &m_count, 1 );
+		__sync_fetch_and_add( &m_sum, us );
+	}
+
+	void report( const std::string& prefix, std::vector<std::string>& name,
+										std::vector<uint64_t>& value ) {
+		name.push_back( prefix + ".count" );
+		value.push_back( m_count );
+		name.push_back( prefix + ".sumUs" );
+		value.push_back( m_sum );
+		for ( unsigned i = 0; i < NUM_BUCKETS; i++ ) {
+			if ( 0 == m_bucket[i] ) {
+				continue;
+			}
+			char buf[32];
+			if ( i < NUM_BUCKETS - 1 ) {
+				snprintf( buf, sizeof(buf), ".ltUs.%llu", 1ULL << i );
+			} else {
+				snprintf( buf, sizeof(buf), ".ltUs.inf" );
+			}
+			name.push_back( prefix + buf );
+			value.push_back( m_bucket[i] );
+		}
+	}
+
+  private:
+	uint64_t	m_bucket[NUM_BUCKETS];
+	uint64_t	m_count;
+	uint64_t	m_sum;
+};
+
+struct RouterStats {
+	enum { ClientChan, ServerChan, RouterChan, NUM_CHAN_TYPES };
+
+	ChannelStats	chan[NUM_CHAN_TYPES];
+
+	// from fan out to each member's response arriving
+	Histogram		memberLatency;
+	// from the client's request arriving to the reply going out
+	Histogram		requestLatency;
+	uint64_t		timeouts;
+
+	// memory held on behalf of clients and servers that are not
+	// connected yet, sizes are approximate
+	uint64_t		comms;
+	uint64_t		commBytes;
+	uint64_t		commsEvicted;
+	uint64_t		pendingBytes;
+	uint64_t		pendingDropped;
+
+	// client events held back by admission control
+	uint64_t		throttled;
+
+	RouterStats() : timeouts(0), comms(0), commBytes(0), commsEvicted(0),
+					pendingBytes(0), pendingDropped(0), throttled(0) {}
+
+	static const char* chanName( int type ) {
+		static const char* names[] = { "client", "server", "router" };
+		return names[type];
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_SUBSCRIBE_EVENTS_H
+#define _RTR_SUBSCRIBE_EVENTS_H
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h>
+#include "router.h"
+
+namespace PWR_Router {
+
+// Every source of every member of the comm is asked to push, the pushes 
+// are put back together here, see SubTable
+class RtrCommSubscribeEvent: public  CommSubscribeEvent {
+  public:
+   	RtrCommSubscribeEvent( SerialBuf& buf ) : CommSubscribeEvent( buf ) {}  
+
+	bool process(EventGenerator* _rtr, EventChannel* ec) {
+		Router& rtr = *static_cast<Router*>(_rtr);
+
+		if ( Stop == op ) {
+			return stop( rtr, ec );
+		}
+
+		Router::Client& client = *rtr.getClient( ec );
+		std::vector< std::vector< ObjID > >* comm = client.getCommList( commID );
+		if ( ! comm ) {
+			DBGX("unknown commID=%" PRIx64 "\n", commID );
+			CommSampleEvent resp;
+			resp.id = id;
+			resp.status = UnknownComm;
+			ec->sendEvent( &resp );
+			return true;
+		}
+		std::vector< std::vector< ObjID > >& commList = *comm;
+
+		EventId subId = rtr.subs().add( ec, id, commList, attrName.size(),
+										PWR_TRIGGER_NONE != trigger );
+    	DBGX("commID=%" PRIx64 " eventId=%" PRIx64 " subId=%" PRIx64 "\n",
+                                commID, id, subId );
+		id = subId;
+
+        for ( unsigned int i=0; i < commList.size(); i++ ) {
+			for ( unsigned int j=0; j < commList[i].size(); j++ ) {
+				grpIndex = i;
+				memberIndex = j;
+				AppID dest = rtr.findDestApp( commList[i][j] );
+				if ( (AppID) -1 == dest ) {
+					DBGX("no route to `%s`\n", commList[i][j].c_str() );
+					rtr.subs().noSource( subId, i, j );
+					continue;
+				}
+				rtr.subs().setSource( subId, i, j, dest );
+				if ( ! rtr.sendEvent( dest, this ) ) {
+					rtr.subs().noSource( subId, i, j );
+				}
+			}
+        }
+		return true;
+	}
+
+  private:
+	// the ack goes out after the last push
+	bool stop( Router& rtr, EventChannel* ec ) {
+		EventId subId;
+		SubTable::Members members;
+		if ( rtr.subs().remove( ec, id, subId, members ) ) {
+			rtr.unsubscribe( subId, members );
+		}
+
+		CommSampleEvent resp;
+		resp.id = id;
+		resp.op = Stop;
+		ec->sendEvent( &resp );
+		return true;
+	}
+};
+
+class RtrCommSampleEvent: public  CommSampleEvent {
+  public:
+   	RtrCommSampleEvent( SerialBuf& buf ) : CommSampleEvent( buf ) {}  
+
+	bool process(EventGenerator* _rtr, EventChannel* ) {
+        DBGX("id=%" PRIx64 " grpIndex=%" PRIu64 " memberIndex=%" PRIu64 "\n", 
+									id, grpIndex, memberIndex );
+
+		Router& rtr = *static_cast<Router*>(_rtr);
+		if ( NoSource == status ) {
+			rtr.subs().noSource( id, grpIndex, memberIndex );
+		} else {
+			rtr.subs().push( *this );
+		}
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string.h>
+#include <algorithm>
+#include <debug.h>
+#include <eventChannel.h>
+#include "subscriptions.h"
+
+using namespace PWR_Router;
+
+SubTable::SubTable() : m_nextId( 0 )
+{
+	pthread_mutex_init( &m_lock, NULL );
+	pthread_cond_init( &m_sent, NULL );
+}
+
+EventId SubTable::add( EventChannel* src, EventId id, Members& members,
+									size_t numAttrs, bool trigger )
+{
+	pthread_mutex_lock( &m_lock );
+
+	EventId subId = ++m_nextId;
+	Sub& sub = m_subs[subId];
+	sub.src = src;
+	sub.id = id;
+	sub.trigger = trigger;
+	sub.failed = false;
+	sub.stopping = false;
+	sub.sending = false;
+	sub.members = members;
+	sub.server.resize( members.size() );
+	sub.expected.resize( members.size() );
+	sub.fresh.resize( members.size() );
+	sub.value.resize( members.size() );
+	sub.timeStamp.resize( members.size() );
+	for ( size_t i = 0; i < members.size(); i++ ) {
+		sub.server[i].resize( members[i].size(), (AppID) -1 );
+		sub.expected[i].resize( members[i].size(), true );
+		sub.fresh[i].resize( members[i].size(), false );
+		sub.value[i].resize( members[i].size(), 
+							std::vector<uint64_t>( numAttrs, 0 ) );
+		sub.timeStamp[i].resize( members[i].size(), 
+							std::vector<PWR_Time>( numAttrs, 0 ) );
+	}
+
+	pthread_mutex_unlock( &m_lock );
+	DBGX("subId=%" PRIx64 " members=%zu\n", subId, members.size() );
+	return subId;
+}
+
+bool SubTable::remove( EventChannel* src, EventId id, EventId& subId,
+											Members& members )
+{
+	pthread_mutex_lock( &m_lock );
+
+	std::map< EventId, Sub >::iterator iter = m_subs.begin();
+	for ( ; iter != m_subs.end(); ++iter ) {
+		if ( iter->second.src == src && iter->second.id == id &&
+										! iter->second.stopping ) {
+			break;
+		}
+	}
+	if ( iter == m_subs.end() ) {
+		pthread_mutex_unlock( &m_lock );
+		return false;
+	}
+	subId = iter->first;
+	iter->second.stopping = true;
+
+	// nothing is queued once stopping, wait for what is being sent
+	while ( 1 ) {
+		iter = m_subs.find( subId );
+		if ( iter == m_subs.end() ) {
+			pthread_mutex_unlock( &m_lock );
+			return false;
+		}
+		if ( ! iter->second.sending ) {
+			break;
+		}
+		pthread_cond_wait( &m_sent, &m_lock );
+	}
+
+	std::deque< CommSampleEvent* > outbox;
+	outbox.swap( iter->second.outbox );
+	members.swap( iter->second.members );
+	m_subs.erase( iter );
+	pthread_mutex_unlock( &m_lock );
+
+	for ( size_t i = 0; i < outbox.size(); i++ ) {
+		src->sendEvent( outbox[i] );
+		delete outbox[i];
+	}
+	return true;
+}
+
+void SubTable::setSource( EventId subId, size_t grp, size_t member, 
+												AppID server )
+{
+	pthread_mutex_lock( &m_lock );
+	std::map< EventId, Sub >::iterator iter = m_subs.find( subId );
+	if ( iter != m_subs.end() && grp < iter->second.members.size() &&
+				member < iter->second.members[grp].size() ) {
+		iter->second.server[grp][member] = server;
+	}
+	pthread_mutex_unlock( &m_lock );
+}
+
+void SubTable::noSource( EventId subId, size_t grp, size_t member )
+{
+	pthread_mutex_lock( &m_lock );
+	std::map< EventId, Sub >::iterator iter = m_subs.find( subId );
+	if ( iter != m_subs.end() && grp < iter->second.members.size() &&
+				member < iter->second.members[grp].size() ) {
+		lost( iter->second, grp, member );
+	}
+	pthread_mutex_unlock( &m_lock );
+	flush( subId );
+}
+
+void SubTable::dropServer( AppID server )
+{
+	std::vector<EventId> subIds;
+	pthread_mutex_lock( &m_lock );
+	std::map< EventId, Sub >::iterator iter = m_subs.begin();
+	for ( ; iter != m_subs.end(); ++iter ) {
+		Sub& sub = iter->second;
+		for ( size_t i = 0; i < sub.server.size(); i++ ) {
+			for ( size_t j = 0; j < sub.server[i].size(); j++ ) {
+				if ( sub.server[i][j] == server && sub.expected[i][j] ) {
+					DBGX("subId=%" PRIx64 " lost %zu:%zu\n", iter->first, 
+															i, j );
+					lost( sub, i, j );
+				}
+			}
+		}
+		if ( ! sub.outbox.empty() ) {
+			subIds.push_back( iter->first );
+		}
+	}
+	pthread_mutex_unlock( &m_lock );
+
+	for ( size_t i = 0; i < subIds.size(); i++ ) {
+		flush( subIds[i] );
+	}
+}
+
+// called with the lock held, the rest may now be all we wait for, or 
+// there may be nothing left to wait for
+void SubTable::lost( Sub& sub, size_t grp, size_t member )
+{
+	sub.expected[grp][member] = false;
+	if ( sub.stopping ) {
+		return;
+	}
+
+	bool any = false, ready = true, fresh = false;
+	for ( size_t i = 0; i < sub.expected.size(); i++ ) {
+		for ( size_t j = 0; j < sub.expected[i].size(); j++ ) {
+			if ( sub.expected[i][j] ) {
+				any = true;
+				ready = ready && sub.fresh[i][j];
+				fresh = fresh || sub.fresh[i][j];
+			}
+		}
+	}
+
+	if ( ! any ) {
+		if ( ! sub.failed ) {
+			sub.failed = true;
+			CommSampleEvent* ev = new CommSampleEvent;
+			ev->id = sub.id;
+			ev->status = CommEvent::NoSource;
+			sub.outbox.push_back( ev );
+		}
+	} else if ( ! sub.trigger && ready && fresh ) {
+		send( sub );
+	}
+}
+
+void SubTable::push( CommSampleEvent& ev )
+{
+	pthread_mutex_lock( &m_lock );
+
+	std::map< EventId, Sub >::iterator iter = m_subs.find( ev.id );
+	if ( iter == m_subs.end() || iter->second.stopping || ev.value.empty() ||
+				ev.grpIndex >= iter->second.members.size() || 
+				ev.memberIndex >= iter->second.members[ev.grpIndex].size() ) {
+		DBGX("stale push for %" PRIx64 "\n", ev.id );
+		pthread_mutex_unlock( &m_lock );
+		return;
+	}
+	Sub& sub = iter->second;
+
+	if ( sub.trigger ) {
+		CommSampleEvent* out = new CommSampleEvent;
+		out->id = sub.id;
+		out->value.push_back( ev.value[0] );
+		out->timeStamp.push_back( ev.timeStamp[0] );
+		sub.outbox.push_back( out );
+		pthread_mutex_unlock( &m_lock );
+		flush( ev.id );
+		return;
+	}
+
+	sub.fresh[ev.grpIndex][ev.memberIndex] = true;
+	std::vector<uint64_t>& value = sub.value[ev.grpIndex][ev.memberIndex];
+	std::vector<PWR_Time>& ts = sub.timeStamp[ev.grpIndex][ev.memberIndex];
+	for ( size_t i = 0; i < value.size() && i < ev.value[0].size(); i++ ) {
+		value[i] = ev.value[0][i];
+		ts[i] = ev.timeStamp[0][i];
+	}
+
+	bool ready = true;
+	for ( size_t i = 0; ready && i < sub.fresh.size(); i++ ) {
+		for ( size_t j = 0; j < sub.fresh[i].size(); j++ ) {
+			if ( sub.expected[i][j] && ! sub.fresh[i][j] ) {
+				ready = false;
+				break;
+			}
+		}
+	}
+	if ( ready ) {
+		send( sub );
+	}
+
+	pthread_mutex_unlock( &m_lock );
+	flush( ev.id );
+}
+
+// called with the lock held, queues the push in its order
+void SubTable::send( Sub& sub )
+{
+	CommSampleEvent* out = new CommSampleEvent;
+	CommSampleEvent& ev = *out;
+	ev.id = sub.id;
+	ev.value.resize( sub.members.size() );
+	ev.timeStamp.resize( sub.members.size() );
+
+	for ( size_t i = 0; i < sub.members.size(); i++ ) {
+		if ( 1 == sub.members[i].size() ) {
+			ev.value[i] = sub.value[i][0];
+			ev.timeStamp[i] = sub.timeStamp[i][0];
+		} else {
+			size_t numAttrs = sub.value[i][0].size();
+			std::vector<double> sum( numAttrs, 0 );
+			ev.timeStamp[i].resize( numAttrs, 0 );
+			for ( size_t j = 0; j < sub.members[i].size(); j++ ) {
+				if ( ! sub.expected[i][j] ) {
+					continue;
+				}
+				for ( size_t k = 0; k < numAttrs; k++ ) {
+					double value;
+					memcpy( &value, &sub.value[i][j][k], sizeof(value) );
+					sum[k] += value;
+					ev.timeStamp[i][k] = std::max( ev.timeStamp[i][k], 
+												sub.timeStamp[i][j][k] );
+				}
+			}
+			ev.value[i].resize( numAttrs );
+			memcpy( &ev.value[i][0], &sum[0], numAttrs * sizeof(double) );
+		}
+		std::fill( sub.fresh[i].begin(), sub.fresh[i].end(), false );
+	}
+
+	sub.outbox.push_back( out );
+}
+
+// sends what is queued unless another thread already is, the sub can't
+// be erased while we send so it is safe to use without the lock
+void SubTable::flush( EventId subId )
+{
+	pthread_mutex_lock( &m_lock );
+	std::map< EventId, Sub >::iterator iter = m_subs.find( subId );
+	if ( iter == m_subs.end() || iter->second.sending ) {
+		pthread_mutex_unlock( &m_lock );
+		return;
+	}
+	Sub& sub = iter->second;
+	sub.sending = true;
+	while ( ! sub.outbox.empty() ) {
+		CommSampleEvent* ev = sub.outbox.front();
+		sub.outbox.pop_front();
+		pthread_mutex_unlock( &m_lock );
+		sub.src->sendEvent( ev );
+		delete ev;
+		pthread_mutex_lock( &m_lock );
+	}
+	sub.sending = false;
+	pthread_cond_broadcast( &m_sent );
+	pthread_mutex_unlock( &m_lock );
+}
+
+// what was queued for the client is dropped with it
+void SubTable::dropChannel( EventChannel* ec, std::vector<EventId>& subIds,
+										std::vector<Members>& members )
+{
+	pthread_mutex_lock( &m_lock );
+
+	std::map< EventId, Sub >::iterator iter = m_subs.begin();
+	while ( iter != m_subs.end() ) {
+		if ( iter->second.src != ec ) {
+			++iter;
+		} else if ( iter->second.sending ) {
+			pthread_cond_wait( &m_sent, &m_lock );
+			iter = m_subs.begin();
+		} else {
+			subIds.push_back( iter->first );
+			members.push_back( iter->second.members );
+			for ( size_t i = 0; i < iter->second.outbox.size(); i++ ) {
+				delete iter->second.outbox[i];
+			}
+			m_subs.erase( iter++ );
+		}
+	}
+
+	pthread_mutex_unlock( &m_lock );
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _RTR_SUBSCRIPTIONS_H
+#define _RTR_SUBSCRIPTIONS_H
+
+#include <pthread.h>
+#include <deque>
+#include <map>
+#include <vector>
+#include <events.h>
+#include <pwrtypes.h>
+#include <routerEvent.h>
+
+class EventChannel;
+
+namespace PWR_Router {
+
+// The subscriptions of our clients. Every source of every member pushes
+// on its own, a push goes to the client once all of them have pushed 
+// since the last one, with the sources of a member added together. A 
+// trigger's push goes straight through from its one source.
+// A source that can't publish, or whose server goes away, is no longer 
+// waited for, and the client is told once there are none left.
+//
+// What goes to a client is queued on its subscription under the lock 
+// and sent outside it, by one thread at a time per subscription so the
+// pushes stay in order, and a slow client holds up only its own.
+class SubTable {
+  public:
+	typedef std::vector< std::vector< ObjID > > Members;
+
+	SubTable();
+
+	// returns the id the sources push with
+	EventId add( EventChannel* src, EventId id, Members& members, 
+									size_t numAttrs, bool trigger );
+
+	// false if there is no such subscription, what was queued for it has
+	// been sent when it returns so the stop can be acked behind it
+	bool remove( EventChannel* src, EventId id, EventId& subId, 
+												Members& members );
+
+	// the server a source is on
+	void setSource( EventId subId, size_t grp, size_t member, AppID );
+
+	// a source we could not reach, don't wait for it
+	void noSource( EventId subId, size_t grp, size_t member );
+
+	// the server has gone, don't wait for its sources
+	void dropServer( AppID );
+
+	void push( CommSampleEvent& );
+
+	// the client has gone, hands back what it was subscribed to 
+	void dropChannel( EventChannel*, std::vector<EventId>& subIds, 
+										std::vector<Members>& members );
+
+  private:
+	struct Sub {
+		EventChannel*	src;
+		EventId			id;
+		bool			trigger;
+		Members			members;
+		bool			failed;
+		bool			stopping;
+		// a thread is sending the outbox, the sub stays in the table
+		bool			sending;
+		std::deque< CommSampleEvent* >	outbox;
+		// [member][source] 
+		std::vector< std::vector< AppID > >		server;
+		std::vector< std::vector< bool > >		expected;
+		std::vector< std::vector< bool > >		fresh;
+		// [member][source][attr]
+		std::vector< std::vector< std::vector<uint64_t> > >	value;
+		std::vector< std::vector< std::vector<PWR_Time> > >	timeStamp;
+	};
+
+	void send( Sub& );
+	void lost( Sub&, size_t grp, size_t member );
+	void flush( EventId subId );
+
+	std::map< EventId, Sub >	m_subs;
+	EventId						m_nextId;
+	pthread_mutex_t				m_lock;
+	// signalled when a sub's outbox is no longer being sent
+	pthread_cond_t				m_sent;
+};
+
+}
+
+#endif
@@ -16,41 +16,146 @@
 
 using namespace PWR_Router;
 
-TorusCore::TorusCore( RouterCoreArgs* _args,  Router* router ) {
+TorusCore::TorusCore( RouterCoreArgs* _args,  Router* router ) :
+	m_myId( router->m_args.rtrId )
+{
 	TorusArgs& args = *static_cast<TorusArgs*>(_args);
 
 	int nDims = args.dim.size();
 
     m_rtrLinks.resize( nDims );
+	m_size.resize( nDims );
+	m_stride.resize( nDims );
+	m_lastTie.resize( nDims, NEG_LINK );
 
+	unsigned stride = 1;
     for ( int i = 0; i < nDims; i++ ) {
         EventChannel* ec;
-        m_rtrLinks[i].resize(1);
+        m_rtrLinks[i].resize(2);
 
-        printf("%d: posPort=%s ", i, args.dim[i].posPort.c_str() );
-        printf("negSrvr=%s negSrvrPort=%s\n",
-                args.dim[i].negSrvr.c_str(), args.dim[i].negSrvrPort.c_str() );
+		m_size[i] = args.dim[i].size;
+		m_stride[i] = stride;
+		stride *= m_size[i] ? m_size[i] : 1;
+
+        DBGX("%d: size=%d posPort=%s negPort=%s\n", i, m_size[i],
+				args.dim[i].posPort.c_str(), args.dim[i].negPort.c_str() );
+        DBGX("negSrvr=%s negSrvrPort=%s posSrvr=%s posSrvrPort=%s\n",
+                args.dim[i].negSrvr.c_str(), args.dim[i].negSrvrPort.c_str(),
+                args.dim[i].posSrvr.c_str(), args.dim[i].posSrvrPort.c_str() );
 
         std::string config = "server=" + args.dim[i].negSrvr +
                             " serverPort=" + args.dim[i].negSrvrPort;
 
         ec = getEventChannel( "TCP", allocRtrEvent, config, "router-send" );
 
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
+
         router->chanSelect().addChannel( ec, 
 						new RouterData(ec, &router->m_router ) );
 
         m_rtrLinks[i][NEG_LINK].send = ec;
 
-
         config = "listenPort=" + args.dim[i].posPort;
         ec = getEventChannel( "TCP", allocRtrEvent, config , "router-listen" );
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
         router->chanSelect().addChannel( ec,
         				new AcceptData<EventData>( ec, &router->m_router ) );
         m_rtrLinks[i][NEG_LINK].recv = ec;
+
+		if ( args.dim[i].posSrvr.empty() ) {
+			continue;
+		}
+
+        config = "server=" + args.dim[i].posSrvr +
+                            " serverPort=" + args.dim[i].posSrvrPort;
+
+        ec = getEventChannel( "TCP", allocRtrEvent, config, "router-send" );
+
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
+
+        router->chanSelect().addChannel( ec, 
+						new RouterData(ec, &router->m_router ) );
+
+        m_rtrLinks[i][POS_LINK].send = ec;
+
+        config = "listenPort=" + args.dim[i].negPort;
+        ec = getEventChannel( "TCP", allocRtrEvent, config , "router-listen" );
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
+        router->chanSelect().addChannel( ec,
+        				new AcceptData<EventData>( ec, &router->m_router ) );
+        m_rtrLinks[i][POS_LINK].recv = ec;
     } 
 }
 
-EventChannel* TorusCore::getChannel( RouterID id ) {
-	DBGX("\n");
-	return m_rtrLinks[0][NEG_LINK].send;
+// Dimension ordered routing, correct the lowest dimension that differs
+// first, going whichever way around the ring is shorter. 
+EventChannel* TorusCore::getChannel( RouterID id )
+{
+	DBGX("router ID %d\n",id);
+
+	for ( unsigned dim = 0; dim < m_rtrLinks.size(); dim++ ) {
+
+		// no geometry for this dimension, old style single ring
+		if ( 0 == m_size[dim] ) {
+			return m_rtrLinks[dim][NEG_LINK].send;
+		}
+
+		unsigned size = m_size[dim];
+		unsigned src = coord( m_myId, dim );
+		unsigned dest = coord( id, dim );
+
+		if ( src == dest ) {
+			continue;
+		}
+
+		unsigned posHops = ( dest + size - src ) % size;
+		unsigned negHops = size - posHops;
+		int link;
+
+		if ( ! m_rtrLinks[dim][POS_LINK].send ) {
+			link = NEG_LINK;
+		} else if ( posHops < negHops ) {
+			link = POS_LINK;
+		} else if ( negHops < posHops ) {
+			link = NEG_LINK;
+		} else {
+			link = pickLink( dim );
+		}
+
+		DBGX("dim=%d src=%d dest=%d %s\n", dim, src, dest,
+						link == POS_LINK ? "pos" : "neg" );
+		return m_rtrLinks[dim][link].send;
+	}
+
+	// the id is our own, there is no link to send on
+	assert( 0 );
+	return NULL;
+}
+
+// Both directions are minimal, send on the link with the least data 
+// queued, alternating when they are equal.
+int TorusCore::pickLink( int dim )
+{
+	size_t neg = m_rtrLinks[dim][NEG_LINK].send->sendQueueDepth();
+	size_t pos = m_rtrLinks[dim][POS_LINK].send->sendQueueDepth();
+
+	if ( neg < pos ) {
+		m_lastTie[dim] = NEG_LINK;
+	} else if ( pos < neg ) {
+		m_lastTie[dim] = POS_LINK;
+	} else {
+		m_lastTie[dim] = m_lastTie[dim] == NEG_LINK ? POS_LINK : NEG_LINK;
+	}
+	return m_lastTie[dim];
+}
+
+void TorusCore::getLinks( std::vector<EventChannel*>& links )
+{
+	for ( unsigned dim = 0; dim < m_rtrLinks.size(); dim++ ) {
+		for ( unsigned i = 0; i < m_rtrLinks[dim].size(); i++ ) {
+			if ( m_rtrLinks[dim][i].send ) {
+				links.push_back( m_rtrLinks[dim][i].send );
+			}
+		}
+	}
 }
@@ -22,10 +22,19 @@ namespace PWR_Router {
 
 class Router;
 
+// negSrvr is the router one hop in the negative direction, it connects
+// to our posPort. posSrvr, if present, is the router one hop in the 
+// positive direction, it connects to our negPort. size is the number of
+// routers in this dimension, zero if unknown.
 struct Dim {
+	Dim() : size(0) {}
     std::string posPort;
     std::string negSrvr;
     std::string negSrvrPort;
+	unsigned	size;
+    std::string negPort;
+    std::string posSrvr;
+    std::string posSrvrPort;
 };
 
 struct TorusArgs : public RouterCoreArgs {
@@ -34,6 +43,7 @@ struct TorusArgs : public RouterCoreArgs {
 
 class TorusCore : public RouterCore {
 	struct ABC {
+		ABC() : send(NULL), recv(NULL) {}
 		EventChannel* send;
 		EventChannel* recv;
 	};
@@ -42,7 +52,17 @@ class TorusCore : public RouterCore {
 	TorusCore( RouterCoreArgs*, Router* ); 
 	
 	EventChannel* getChannel( RouterID id );
+	void getLinks( std::vector<EventChannel*>& );
   private:
+	unsigned coord( RouterID id, int dim ) {
+		return ( id / m_stride[dim] ) % m_size[dim];
+	}
+	int pickLink( int dim );
+
+	RouterID						  m_myId;
+	std::vector< unsigned >			  m_size;
+	std::vector< unsigned >			  m_stride;
+	std::vector< int >				  m_lastTie;
     std::vector< std::vector<ABC> >   m_rtrLinks;
 };
 
@@ -47,6 +47,8 @@ TreeCore::TreeCore( RouterCoreArgs* _args,  Router* router )
 
         ec = getEventChannel( "TCP", allocRtrEvent, config, "router" );
 
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
+
         router->chanSelect().addChannel( ec, 
 						new RouterData(ec, &router->m_router ) );
 
@@ -54,6 +56,7 @@ TreeCore::TreeCore( RouterCoreArgs* _args,  Router* router )
 
         config = "listenPort=" + link.myListenPort;
         ec = getEventChannel( "TCP", allocRtrEvent, config , "router" );
+        ec->setStats( &router->stats().chan[RouterStats::RouterChan] );
         router->chanSelect().addChannel( ec,
         				new AcceptData<EventData>( ec, &router->m_router ) );
         m_rtrLinks[i].recv = ec;
@@ -79,3 +82,12 @@ EventChannel* TreeCore::getChannel( RouterID id )
 	}
 	return m_rtrLinks[0].send; 
 }
+
+void TreeCore::getLinks( std::vector<EventChannel*>& links )
+{
+	for ( unsigned i = 0; i < m_rtrLinks.size(); i++ ) {
+		if ( m_rtrLinks[i].send ) {
+			links.push_back( m_rtrLinks[i].send );
+		}
+	}
+}
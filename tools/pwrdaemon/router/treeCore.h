@@ -47,6 +47,7 @@ class TreeCore : public RouterCore {
 	TreeCore( RouterCoreArgs*, Router* ); 
 	
 	EventChannel* getChannel( RouterID id );
+	void getLinks( std::vector<EventChannel*>& );
 
   private:
     std::vector< ABC  >   m_rtrLinks;
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+// fetch the counters from a router's client port 
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <events.h>
+#include <eventChannel.h>
+
+static void usage( const char* exename )
+{
+	fprintf(stderr,"%s: [-s server] [-p serverPort]\n",exename);
+}
+
+static Event* allocEvent( unsigned int type, SerialBuf& buf )
+{
+	switch( (EventType) type ) {
+	  default:
+		assert(0);
+	  case RouterStatsResp:
+		return new RouterStatsRespEvent( buf );
+	}
+	return NULL;
+}
+
+int main( int argc, char* argv[] )
+{
+	std::string server = "localhost";
+	std::string serverPort;
+	int option;
+
+	if ( getenv( "POWERAPI_SERVER" ) ) {
+		server = getenv( "POWERAPI_SERVER" );
+	}
+	if ( getenv( "POWERAPI_SERVER_PORT" ) ) {
+		serverPort = getenv( "POWERAPI_SERVER_PORT" );
+	}
+
+	while( (option=getopt( argc, argv, "s:p:" )) != -1 ) {
+    	switch( option ) {
+	      case 's':
+			server = optarg;
+			break;
+
+	      case 'p':
+			serverPort = optarg;
+			break;
+
+		  default:
+			usage( argv[0] );
+			exit(-1);
+		}
+	}
+
+	if ( serverPort.empty() ) {
+		usage( argv[0] );
+		exit(-1);
+	}
+
+	EventChannel* ec = getEventChannel( "TCP", allocEvent, 
+			"server=" + server + " serverPort=" + serverPort, "rtrstat" );
+	assert( ec );
+
+	RouterStatsReqEvent req;
+	ec->sendEvent( &req );
+
+	Event* ev = ec->getEvent();
+	if ( NULL == ev ) {
+		fprintf(stderr,"no response from %s:%s\n", 
+							server.c_str(), serverPort.c_str() );
+		exit(-1);
+	}
+
+	RouterStatsRespEvent* resp = static_cast<RouterStatsRespEvent*>(ev);
+	for ( unsigned i = 0; i < resp->name.size(); i++ ) {
+		printf( "%s %" PRIu64 "\n", resp->name[i].c_str(), resp->value[i] );
+	}
+
+	delete resp;
+	delete ec;
+	return 0;
+}
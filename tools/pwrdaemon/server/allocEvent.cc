@@ -10,6 +10,8 @@
 #include "commDestroyEvent.h"
 #include "commGetSamplesReqEvent.h"
 #include "commLogEvent.h"
+#include "commStatReqEvent.h"
+#include "commSubscribeEvent.h"
 #include "commReqEvent.h"
 
 using namespace PWR_Server;
@@ -50,6 +52,10 @@ Event* PWR_Server::allocReqEvent( unsigned int type, SerialBuf& buf )
         return new SrvrCommLogReqEvent( buf );
       case CommGetSamplesReq:
         return new SrvrCommGetSamplesReqEvent( buf );
+      case CommStatReq:
+        return new SrvrCommStatReqEvent( buf );
+      case CommSubscribe:
+        return new SrvrCommSubscribeEvent( buf );
     }
     return NULL;
 }
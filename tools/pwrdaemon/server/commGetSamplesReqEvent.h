@@ -42,6 +42,13 @@ class SrvrCommGetSamplesReqEvent: public  CommGetSamplesReqEvent {
     	m_respEvent.id = id;
 		m_respEvent.data.resize( count );
 		m_respEvent.count = count;
+
+		if ( count && m_info->cache() && m_info->cache()->getSamples( obj, 
+				attrName, &m_respEvent.startTime, period, count, 
+				&m_respEvent.data[0] ) ) {
+			m_info->fini( this, &m_respEvent );
+			return false;
+		}
 		
 		PWR_StatusCreate(m_info->m_ctx,&m_status);
     	m_req = PWR_ReqCreateCallback( m_info->m_ctx, m_status, 
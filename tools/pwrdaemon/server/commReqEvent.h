@@ -11,7 +11,10 @@
 
 namespace PWR_Server {
 
+class SrvrCommReqEvent;
 static void requestFini( void* );
+static void batchFini( void* );
+static void submitSet( SrvrCommReqEvent*, PWR_Obj );
 
 class SrvrCommReqEvent: public  CommReqEvent {
   public:
@@ -50,11 +53,31 @@ class SrvrCommReqEvent: public  CommReqEvent {
 		m_respEvent.op = op;
     	m_respEvent.id = id;
 		m_respEvent.grpIndex = grpIndex;
+		m_respEvent.memberIndex = memberIndex;
 		// quiet valgrind
 		m_respEvent.commID = 0;
 
+		if ( op == CommEvent::Get && m_info->cache() && 
+				m_info->cache()->get( obj, attrName.size(), &attrName[0], 
+					&m_respEvent.value[0][0], &m_respEvent.timeStamp[0][0] ) ) {
+			m_info->fini( this, &m_respEvent );
+			return false;
+		}
+
+		// read along with the other gets for this object
+		if ( op == CommEvent::Get ) {
+			m_info->addGet( obj, this );
+			return false;
+		}
+
 		int rc = PWR_StatusCreate(m_info->m_ctx,&m_status);
 		assert( rc == PWR_RET_SUCCESS );
+
+		if ( m_info->workers() ) {
+			submitSet( this, obj );
+			return false;
+		}
+
     	m_req = PWR_ReqCreateCallback( m_info->m_ctx, m_status,
 										requestFini, this );
     	assert( m_req );
@@ -82,6 +105,188 @@ class SrvrCommReqEvent: public  CommReqEvent {
 	PWR_Status		m_status;
 };
 
+// Gets for the same object that arrived together, read once with the
+// union of their attributes. A read stops at the first attribute that 
+// fails, so a batch that fails is read again split by attribute list and
+// each request only sees the errors a read of its own would have.
+struct GetBatch {
+	GetBatch( Server* info, PWR_Obj _obj ) : 
+		server( info ), obj( _obj ), req( NULL ) {}
+	~GetBatch() {
+		if ( req ) {
+			PWR_ReqDestroy( req );
+		}
+	}
+
+	// where each request's attributes are in the merged read
+	void add( SrvrCommReqEvent* ev ) {
+		reqs.push_back( ev );
+		index.resize( reqs.size() );
+		for ( unsigned i = 0; i < ev->attrName.size(); i++ ) {
+			unsigned j = 0;
+			while ( j < attrs.size() && attrs[j] != ev->attrName[i] ) { 
+				++j;
+			}
+			if ( j == attrs.size() ) {
+				attrs.push_back( ev->attrName[i] );
+			}
+			index.back().push_back( j );
+		}
+	}
+
+	void run();
+	bool split();
+
+	Server*			server;
+	PWR_Obj			obj;
+	std::vector< SrvrCommReqEvent* >	reqs;
+	std::vector< std::vector<unsigned> >	index;
+	std::vector< PWR_AttrName >	attrs;
+	std::vector< uint64_t >	value;
+	std::vector< PWR_Time >		timeStamp;
+	PWR_Request		req;
+	PWR_Status		status;
+};
+
+// the device reads for a batch, on a worker thread
+class GetJob : public WorkerPool::Job {
+  public:
+	GetJob( GetBatch* batch ) : Job( batch->obj ), m_batch( batch ) {}
+
+	void run() {
+		PWR_ObjAttrGetValues( m_batch->obj, m_batch->attrs.size(), 
+				&m_batch->attrs[0], &m_batch->value[0], 
+				&m_batch->timeStamp[0], m_batch->status );
+	}
+	void done() {
+		batchFini( m_batch );
+	}
+
+  private:
+	GetBatch*	m_batch;
+};
+
+class SetJob : public WorkerPool::Job {
+  public:
+	SetJob( SrvrCommReqEvent* ev, PWR_Obj obj ) : Job( obj ), m_ev( ev ) {}
+
+	void run() {
+		PWR_ObjAttrSetValues( key(), m_ev->attrName.size(), 
+				&m_ev->attrName[0], &m_ev->setValues[0], m_ev->m_status );
+	}
+	void done() {
+		requestFini( m_ev );
+	}
+
+  private:
+	SrvrCommReqEvent*	m_ev;
+};
+
+inline void GetBatch::run()
+{
+	value.resize( attrs.size() );
+	timeStamp.resize( attrs.size() );
+
+	int rc = PWR_StatusCreate( server->m_ctx, &status );
+	assert( rc == PWR_RET_SUCCESS );
+
+	if ( server->workers() ) {
+		server->workers()->submit( new GetJob( this ) );
+		return;
+	}
+
+    req = PWR_ReqCreateCallback( server->m_ctx, status, batchFini, this );
+    assert( req );
+
+	rc = PWR_ObjAttrGetValues_NB( obj, attrs.size(), &attrs[0], 
+						&value[0], &timeStamp[0], req );
+	if ( rc != PWR_RET_SUCCESS ) {
+		batchFini( this );
+	}
+}
+
+// run the requests again in batches of the same attributes, false if
+// they all have the same ones
+inline bool GetBatch::split()
+{
+	std::map< std::vector<PWR_AttrName>, GetBatch* > batches;
+	for ( unsigned i = 0; i < reqs.size(); i++ ) {
+		GetBatch*& batch = batches[ reqs[i]->attrName ];
+		if ( NULL == batch ) {
+			batch = new GetBatch( server, obj );
+		}
+		batch->add( reqs[i] );
+	}
+
+	if ( 1 == batches.size() ) {
+		delete batches.begin()->second;
+		return false;
+	}
+
+    DBG4("PWR_Server","requests=%lu batches=%lu\n", reqs.size(), 
+											batches.size() );
+	std::map< std::vector<PWR_AttrName>, GetBatch* >::iterator iter;
+	for ( iter = batches.begin(); iter != batches.end(); ++iter ) {
+		iter->second->run();
+	}
+	return true;
+}
+
+static void submitSet( SrvrCommReqEvent* ev, PWR_Obj obj )
+{
+	ev->m_info->workers()->submit( new SetJob( ev, obj ) );
+}
+
+static void batchFini( void* _data )
+{
+	GetBatch* batch = (GetBatch*) _data;
+    DBG4("PWR_Server","requests=%lu attrs=%lu\n", batch->reqs.size(),
+											batch->attrs.size() );
+
+	std::vector< PWR_AttrAccessError > errors;
+	PWR_AttrAccessError error;
+	while ( PWR_RET_EMPTY != PWR_StatusPopError( batch->status, &error ) ) {
+		errors.push_back( error );
+	}
+	PWR_StatusDestroy( batch->status );
+
+	if ( ! errors.empty() && batch->split() ) {
+		delete batch;
+		return;
+	}
+
+	for ( unsigned i = 0; i < batch->reqs.size(); i++ ) {
+		SrvrCommReqEvent* ev = batch->reqs[i];
+		CommRespEvent& resp = ev->m_respEvent;
+		std::vector<unsigned>& index = batch->index[i];
+
+		for ( unsigned j = 0; j < index.size(); j++ ) {
+			resp.value[0][j] = batch->value[ index[j] ];
+			resp.timeStamp[0][j] = batch->timeStamp[ index[j] ];
+		}
+
+		// only the errors for the attributes this request asked for
+		for ( unsigned j = 0; j < errors.size(); j++ ) {
+			unsigned k = 0;
+			while ( k < ev->attrName.size() && 
+							ev->attrName[k] != errors[j].name ) {
+				++k;
+			}
+			if ( k == ev->attrName.size() ) {
+				continue;
+			}
+    		resp.errValue.push_back( errors[j].error ) ;
+    		resp.errAttr.push_back( errors[j].name ) ;
+			char name[100];
+			PWR_ObjGetName( errors[j].obj, name, 100 );	
+    		resp.errObj.push_back( name ); 
+		}
+
+		ev->m_info->fini( ev, &resp );
+	}
+	delete batch;
+}
+
 static void requestFini( void* _data )
 {
 	SrvrCommReqEvent* data = (SrvrCommReqEvent*) _data;
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_COMM_STAT_REQ_EVENT_H
+#define _SRVR_COMM_STAT_REQ_EVENT_H
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string.h>
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h>
+#include <statOps.h>
+#include "server.h"
+
+namespace PWR_Server {
+
+static void statFini( void* );
+
+// Gets the samples in the window the same way a get samples request
+// does and answers with just the reduction
+class SrvrCommStatReqEvent: public  CommStatReqEvent {
+  public:
+   	SrvrCommStatReqEvent( SerialBuf& buf ) :
+		CommStatReqEvent( buf ), m_req(NULL), m_status(NULL) {}
+
+   	~SrvrCommStatReqEvent( ) {
+		DBGX("\n");
+		if ( m_req ) {
+			PWR_ReqDestroy( m_req );
+		}
+	}
+
+	bool process( EventGenerator* gen, EventChannel* ) {
+		m_info = static_cast<Server*>(gen);
+
+    	PWR_Obj obj = m_info->m_commMap[commID].objects[0];
+
+		DBGX("commID=%" PRIx64 " attr=`%s` stat=%d period=%f\n", commID,
+				PWR_AttrGetTypeString( attrName ), stat, period );
+
+    	m_respEvent.id = id;
+		m_respEvent.grpIndex = grpIndex;
+
+		double window = (double) ( stopTime - startTime ) / 1000000000;
+		m_count = period > 0 && window > 0 ? window / period : 0;
+		m_op = getStatOp( stat );
+
+		if ( NULL == m_op || 0 == m_count ) {
+			char name[100];
+			PWR_ObjGetName( obj, name, 100 );
+			m_respEvent.errObj.push_back( name );
+			m_respEvent.errAttr.push_back( attrName );
+			m_respEvent.errValue.push_back( PWR_RET_FAILURE );
+			m_info->fini( this, &m_respEvent );
+			return false;
+		}
+		// the rollups have the min and max of what they averaged
+		double value;
+		PWR_Time instant;
+		if ( m_info->cache() && m_info->cache()->getStat( obj, attrName, 
+				stat, period, m_count, &m_start, &value, &instant ) ) {
+			respond( value, instant );
+			return false;
+		}
+
+		m_samples.resize( m_count );
+
+		if ( m_info->cache() && m_info->cache()->getSamples( obj, attrName,
+							&m_start, period, m_count, &m_samples[0] ) ) {
+			reduce();
+			return false;
+		}
+
+		PWR_StatusCreate(m_info->m_ctx,&m_status);
+    	m_req = PWR_ReqCreateCallback( m_info->m_ctx, m_status,
+											(Callback)statFini, this );
+    	assert( m_req );
+
+    	int ret = PWR_ObjAttrGetSamples_NB( obj, attrName, &m_start, period,
+					&m_count, (void*) &m_samples[0], m_req );
+
+    	if ( ret != PWR_RET_SUCCESS ) {
+        	statFini( this );
+    	}
+
+		return false;
+	}
+
+	void reduce() {
+		std::vector<double> values( m_count );
+		memcpy( &values[0], &m_samples[0], m_count * sizeof(double) );
+
+		int pos;
+		double value = m_op( values, pos );
+		respond( value, pos > -1 ? m_start +
+				(PWR_Time) ( pos * period * 1000000000 ) : PWR_TIME_UNINIT );
+	}
+
+	void respond( double value, PWR_Time instant ) {
+		m_respEvent.value.push_back( value );
+		m_respEvent.startTime.push_back( m_start );
+		m_respEvent.stopTime.push_back( m_start +
+				(PWR_Time) ( m_count * period * 1000000000 ) );
+		m_respEvent.instant.push_back( instant );
+		DBGX("value=%f count=%u\n", value, m_count );
+
+		m_info->fini( this, &m_respEvent );
+	}
+
+	CommStatRespEvent	m_respEvent;
+
+	Server*			m_info;
+	PWR_Request	    m_req;
+	PWR_Status		m_status;
+	StatOpFuncPtr	m_op;
+	unsigned int	m_count;
+	PWR_Time		m_start;
+	std::vector<uint64_t> m_samples;
+};
+
+static void statFini( void* _data )
+{
+	SrvrCommStatReqEvent* data = (SrvrCommStatReqEvent*) _data;
+    DBG4("PWR_Server","\n");
+
+    PWR_Status status = data->m_status;
+    PWR_AttrAccessError error;
+    while ( PWR_RET_EMPTY != PWR_StatusPopError( status, &error ) ) {
+
+        data->m_respEvent.errValue.push_back( error.error ) ;
+        data->m_respEvent.errAttr.push_back( error.name ) ;
+        char name[100];
+        PWR_ObjGetName( error.obj, name, 100 );
+        data->m_respEvent.errObj.push_back( name );
+    }
+
+	PWR_StatusDestroy( data->m_status );
+
+	if ( data->m_respEvent.errValue.empty() && data->m_count ) {
+		data->reduce();
+	} else {
+		data->m_info->fini( data, &data->m_respEvent );
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_COMM_SUBSCRIBE_EVENT_H
+#define _SRVR_COMM_SUBSCRIBE_EVENT_H
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <events.h>
+#include <eventChannel.h>
+#include <debug.h>
+#include "server.h"
+
+namespace PWR_Server {
+
+// nothing is sent back, the pushes are the answer
+class SrvrCommSubscribeEvent: public  CommSubscribeEvent {
+  public:
+   	SrvrCommSubscribeEvent( SerialBuf& buf ) : CommSubscribeEvent( buf ) {}
+
+	bool process( EventGenerator* gen, EventChannel* ) {
+		Server* info = static_cast<Server*>(gen);
+
+		DBGX("commID=%" PRIx64 " op=%d period=%" PRIu64 "\n", commID, op,
+															period );
+		if ( ! info->subscribe( this, *this ) ) {
+			DBGX("can't publish commID=%" PRIx64 "\n", commID );
+		}
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <assert.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include <eventChannel.h>
+#include "../router/routerEvent.h"
+#include "publisher.h"
+#include "sampleCache.h"
+#include "workerPool.h"
+#include "debug.h"
+
+using namespace PWR_Server;
+
+// the subscription may be gone when it is done
+class Publisher::ReadJob : public WorkerPool::Job {
+  public:
+	ReadJob( Publisher* publisher, const Key& key, const Sub& sub ) : 
+		Job( sub.obj ), m_publisher( publisher ), m_key( key ), 
+		m_obj( sub.obj ), m_attrs( sub.attrs ), m_ok( false ) {}
+	void run() {
+		m_ok = read( m_obj, m_attrs, m_value, m_ts );
+	}
+	void done() {
+		if ( m_ok ) {
+			m_publisher->deliver( m_key, m_value, m_ts );
+		}
+	}
+  private:
+	Publisher*	m_publisher;
+	Key		m_key;
+	PWR_Obj	m_obj;
+	std::vector<PWR_AttrName> m_attrs;
+	bool	m_ok;
+	std::vector<uint64_t>	m_value;
+	std::vector<PWR_Time>	m_ts;
+};
+
+Publisher::Publisher( SampleCache* cache, WorkerPool* workers ) : 
+	m_cache( cache ), m_workers( workers )
+{
+	m_timerFd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+	assert( m_timerFd >= 0 );
+}
+
+Publisher::~Publisher()
+{
+	close( m_timerFd );
+}
+
+PWR_Time Publisher::now()
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (PWR_Time) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void Publisher::add( AppID src, AppID dest, EventChannel* chan, PWR_Obj obj,
+										CommSubscribeEvent& ev )
+{
+	DBGX("dest=%" PRIx64 " id=%" PRIx64 " period=%" PRIu64 " trigger=%d\n", 
+								dest, ev.id, ev.period, ev.trigger );
+	Key key = { dest, ev.id, ev.grpIndex, ev.memberIndex };
+	Sub& sub = m_subs[key];
+	sub.src = src;
+	sub.chan = chan;
+	sub.obj = obj;
+	sub.attrs = ev.attrName;
+	sub.period = ev.period;
+	sub.next = now() + ev.period;
+	sub.trigger = ev.trigger;
+	sub.threshold = ev.threshold;
+	sub.holdTime = ev.holdTime;
+	sub.since = 0;
+	sub.fired = false;
+	sub.haveLast = false;
+	sub.last = 0;
+	sub.lastTime = 0;
+	arm();
+}
+
+void Publisher::remove( AppID dest, EventId id, uint64_t grpIndex, 
+											uint64_t memberIndex )
+{
+	DBGX("dest=%" PRIx64 " id=%" PRIx64 "\n", dest, id );
+	Key key = { dest, id, grpIndex, memberIndex };
+	m_subs.erase( key );
+	arm();
+}
+
+void Publisher::run()
+{
+	uint64_t expired;
+	if ( ::read( m_timerFd, &expired, sizeof(expired) ) != sizeof(expired) ) {
+		return;
+	}
+
+	PWR_Time time = now();
+	std::map< Key, Sub >::iterator iter = m_subs.begin();
+	for ( ; iter != m_subs.end(); ++iter ) {
+		Sub& sub = iter->second;
+		if ( sub.next > time ) {
+			continue;
+		}
+		publish( iter->first, sub );
+		// a slow loop skips pushes rather than sending a burst of them
+		sub.next += sub.period;
+		if ( sub.next <= time ) {
+			sub.next = time + sub.period;
+		}
+	}
+	arm();
+}
+
+bool Publisher::read( PWR_Obj obj, std::vector<PWR_AttrName>& attrs,
+			std::vector<uint64_t>& value, std::vector<PWR_Time>& ts )
+{
+	value.resize( attrs.size() );
+	ts.resize( attrs.size() );
+
+	PWR_Status status;
+	PWR_StatusCreate( NULL, &status );
+	int rc = PWR_ObjAttrGetValues( obj, attrs.size(), &attrs[0], 
+									&value[0], &ts[0], status );
+	PWR_StatusDestroy( status );
+	DBG("rc=%d\n", rc );
+	return PWR_RET_SUCCESS == rc;
+}
+
+void Publisher::send( const Key& key, const Sub& sub, 
+			std::vector<uint64_t>& value, std::vector<PWR_Time>& ts )
+{
+	CommSampleEvent ev;
+	ev.id = key.id;
+	ev.grpIndex = key.grpIndex;
+	ev.memberIndex = key.memberIndex;
+	ev.value.push_back( value );
+	ev.timeStamp.push_back( ts );
+
+	RouterEvent rev( sub.src, key.dest, &ev );
+	sub.chan->sendEvent( &rev );
+}
+
+// a failed read isn't pushed, the router waits for the next one
+void Publisher::publish( const Key& key, Sub& sub )
+{
+	std::vector<uint64_t> value( sub.attrs.size() );
+	std::vector<PWR_Time> ts( sub.attrs.size() );
+
+	if ( m_cache && m_cache->get( sub.obj, sub.attrs.size(), 
+								&sub.attrs[0], &value[0], &ts[0] ) ) {
+		deliver( key, value, ts );
+	} else if ( m_workers ) {
+		m_workers->submit( new ReadJob( this, key, sub ) );
+	} else if ( read( sub.obj, sub.attrs, value, ts ) ) {
+		deliver( key, value, ts );
+	}
+}
+
+void Publisher::deliver( const Key& key, std::vector<uint64_t>& value,
+									std::vector<PWR_Time>& ts )
+{
+	std::map< Key, Sub >::iterator iter = m_subs.find( key );
+	if ( iter == m_subs.end() ) {
+		return;
+	}
+	Sub& sub = iter->second;
+
+	if ( PWR_TRIGGER_NONE != sub.trigger ) {
+		double tmp;
+		memcpy( &tmp, &value[0], sizeof(tmp) );
+		if ( ! fires( sub, tmp, now() ) ) {
+			return;
+		}
+	}
+	send( key, sub, value, ts );
+}
+
+// edge triggered, a condition that keeps holding fires once 
+bool Publisher::fires( Sub& sub, double value, PWR_Time time )
+{
+	bool cond = false;
+
+	switch ( sub.trigger ) {
+	  case PWR_TRIGGER_ABOVE:
+		cond = value > sub.threshold;
+		break;
+	  case PWR_TRIGGER_BELOW:
+		cond = value < sub.threshold;
+		break;
+	  case PWR_TRIGGER_RATE_ABOVE:
+		if ( sub.haveLast && time > sub.lastTime ) {
+			double rate = ( value - sub.last ) / 
+						( (double) ( time - sub.lastTime ) / 1000000000 );
+			cond = fabs( rate ) > sub.threshold;
+		}
+		sub.haveLast = true;
+		sub.last = value;
+		sub.lastTime = time;
+		break;
+	  case PWR_TRIGGER_CHANGE:
+		// the first value is the one changes are measured from
+		if ( ! sub.haveLast || fabs( value - sub.last ) > sub.threshold ) {
+			sub.haveLast = true;
+			sub.last = value;
+			return true;
+		}
+		return false;
+	}
+
+	if ( ! cond ) {
+		sub.since = 0;
+		sub.fired = false;
+		return false;
+	}
+	if ( sub.fired ) {
+		return false;
+	}
+	if ( 0 == sub.since ) {
+		sub.since = time;
+	}
+	if ( time - sub.since >= sub.holdTime ) {
+		DBG("fired value=%f threshold=%f\n", value, sub.threshold );
+		sub.fired = true;
+		return true;
+	}
+	return false;
+}
+
+void Publisher::arm()
+{
+	struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+
+	std::map< Key, Sub >::iterator iter = m_subs.begin();
+	if ( iter != m_subs.end() ) {
+		PWR_Time next = iter->second.next;
+		for ( ++iter; iter != m_subs.end(); ++iter ) {
+			next = std::min( next, iter->second.next );
+		}
+		spec.it_value.tv_sec = next / 1000000000;
+		spec.it_value.tv_nsec = next % 1000000000;
+	}
+	timerfd_settime( m_timerFd, TFD_TIMER_ABSTIME, &spec, NULL );
+}
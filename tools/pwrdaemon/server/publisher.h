@@ -0,0 +1,107 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_PUBLISHER_H
+#define _SRVR_PUBLISHER_H
+
+#include <map>
+#include <vector>
+#include <pwr.h>
+#include <events.h>
+#include "../router/routerEvent.h"
+
+class EventChannel;
+
+namespace PWR_Server { 
+
+class SampleCache;
+class WorkerPool;
+
+// Pushes the attributes of the objects the routers have subscribed to, 
+// each at its own period, or for a trigger only when its condition fires.
+// Runs on the server loop, woken through a timerfd set for the earliest 
+// one that is due.
+class Publisher {
+  public:
+	// the values come from the cache if there is one, otherwise they are
+	// read on the workers if there are any
+	Publisher( SampleCache*, WorkerPool* );
+	~Publisher();
+
+	// readable when a push is due
+	int fd() { return m_timerFd; }
+
+	// a push is addressed src to dest, the id, grpIndex and memberIndex
+	// of the request are the router's and identify the subscription
+	void add( AppID src, AppID dest, EventChannel*, PWR_Obj, 
+										CommSubscribeEvent& );
+	void remove( AppID dest, EventId, uint64_t grpIndex, 
+											uint64_t memberIndex );
+
+	// push what is due
+	void run();
+
+  private:
+	struct Key {
+		AppID		dest;
+		EventId		id;
+		uint64_t	grpIndex;
+		uint64_t	memberIndex;
+		bool operator<( const Key& other ) const {
+			if ( dest != other.dest ) return dest < other.dest;
+			if ( id != other.id ) return id < other.id;
+			if ( grpIndex != other.grpIndex ) return grpIndex < other.grpIndex;
+			return memberIndex < other.memberIndex;
+		}
+	};
+
+	struct Sub {
+		AppID			src;
+		EventChannel*	chan;
+		PWR_Obj			obj;
+		std::vector<PWR_AttrName> attrs;
+		PWR_Time		period;
+		PWR_Time		next;
+
+		uint32_t		trigger;
+		double			threshold;
+		PWR_Time		holdTime;
+		// when the condition started to hold, 0 if it doesn't
+		PWR_Time		since;
+		bool			fired;
+		// the value of the last check, or the last push for a change
+		bool			haveLast;
+		double			last;
+		PWR_Time		lastTime;
+	};
+
+	class ReadJob;
+
+	static PWR_Time now();
+	static bool read( PWR_Obj, std::vector<PWR_AttrName>&, 
+				std::vector<uint64_t>& value, std::vector<PWR_Time>& ts );
+	static void send( const Key&, const Sub&, std::vector<uint64_t>& value,
+				std::vector<PWR_Time>& ts );
+	void publish( const Key&, Sub& );
+	void deliver( const Key&, std::vector<uint64_t>& value, 
+										std::vector<PWR_Time>& ts );
+	static bool fires( Sub&, double value, PWR_Time time );
+	void arm();
+
+	SampleCache*			m_cache;
+	WorkerPool*				m_workers;
+	std::map< Key, Sub >	m_subs;
+	int						m_timerFd;
+};
+
+}
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <assert.h>
+#include <errno.h>
+#include <algorithm>
+#include <string.h>
+#include <time.h>
+
+#include "sampleCache.h"
+#include "debug.h"
+
+using namespace PWR_Server;
+
+// a second, a minute and an hour, and how many of each we keep
+static const struct {
+	PWR_Time	resolution;
+	unsigned	length;
+} rollups[] = {
+	{ 1000000000LL, 3600 },
+	{ 60 * 1000000000LL, 1440 },
+	{ 3600 * 1000000000LL, 720 },
+};
+
+SampleCache::SampleCache( PWR_Cntxt ctx, const std::vector<PWR_Obj>& roots,
+		const std::vector<PWR_AttrName>& attrs, PWR_Time period,
+		unsigned history, const std::string& shm, bool start ) :
+	m_ctx( ctx ), m_attrs( attrs ), m_period( period ), m_history( history ? history : 1 ),
+	m_started( start ), m_shm( NULL )
+{
+	pthread_mutex_init( &m_lock, NULL );
+
+	for ( unsigned i = 0; i < roots.size(); i++ ) {
+		addObjs( roots[i] );
+	}
+	DBGX("objects=%lu period=%" PRIu64 " history=%u\n", m_objs.size(), 
+												m_period, m_history );
+
+	if ( ! shm.empty() ) {
+		createShm( shm );
+	}
+
+	if ( ! m_started ) {
+		return;
+	}
+
+	// answer from the start
+	sample();
+
+	int rc = pthread_create( &m_thread, NULL, thread, this );
+	assert( 0 == rc );
+}
+
+SampleCache::~SampleCache()
+{
+	if ( m_started ) {
+		pthread_cancel( m_thread );
+		pthread_join( m_thread, NULL );
+	}
+	pthread_mutex_destroy( &m_lock );
+	delete m_shm;
+}
+
+// an entry per series in the order of the objects
+void SampleCache::createShm( const std::string& name )
+{
+	std::vector<ShmTable::Info> info;
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.begin();
+	for ( ; iter != m_objs.end(); ++iter ) {
+		char objName[PWR_SHM_NAME_LEN * 2];
+		PWR_ObjGetName( iter->first, objName, sizeof(objName) );
+		objName[ sizeof(objName) - 1 ] = 0;
+
+		ObjSamples& samples = iter->second;
+		for ( unsigned i = 0; i < samples.attrs.size(); i++ ) {
+			samples.series[i].shmIndex = info.size();
+			ShmTable::Info entry;
+			entry.obj = objName;
+			entry.attr = samples.attrs[i];
+			info.push_back( entry );
+		}
+	}
+	m_shm = ShmTable::create( name, m_period, info );
+}
+
+void SampleCache::addObjs( PWR_Obj obj )
+{
+	ObjSamples samples;
+	for ( unsigned i = 0; i < m_attrs.size(); i++ ) {
+		if ( PWR_RET_SUCCESS == PWR_ObjAttrIsValid( obj, m_attrs[i] ) ) {
+			samples.attrs.push_back( m_attrs[i] );
+		}
+	}
+	if ( ! samples.attrs.empty() ) {
+		samples.series.resize( samples.attrs.size() );
+		for ( unsigned i = 0; i < samples.series.size(); i++ ) {
+			samples.series[i].ring.resize( m_history );
+
+			// rolling up samples finer than a bucket
+			for ( unsigned j = 0; j < sizeof(rollups)/sizeof(rollups[0]); 
+																	j++ ) {
+				if ( rollups[j].resolution <= m_period ) {
+					continue;
+				}
+				Rollup rollup;
+				rollup.resolution = rollups[j].resolution;
+				rollup.ring.resize( rollups[j].length );
+				samples.series[i].rollups.push_back( rollup );
+			}
+		}
+		m_objs[obj] = samples;
+	}
+
+	PWR_Grp children;
+	PWR_ObjGetChildren( obj, &children );
+	if ( NULL == children ) {
+		return;
+	}
+	for ( int i = 0; i < PWR_GrpGetNumObjs( children ); i++ ) {
+		PWR_Obj child;
+		PWR_GrpGetObjByIndx( children, i, &child );
+		addObjs( child );
+	}
+}
+
+SampleCache::Series* SampleCache::ObjSamples::find( PWR_AttrName attr )
+{
+	for ( unsigned i = 0; i < attrs.size(); i++ ) {
+		if ( attrs[i] == attr ) {
+			return &series[i];
+		}
+	}
+	return NULL;
+}
+
+void SampleCache::Rollup::add( PWR_Time taken, double value )
+{
+	PWR_Time start = taken - taken % resolution;
+	if ( size && newest().start == start ) {
+		Bucket& bucket = newest();
+		bucket.min = std::min( bucket.min, value );
+		bucket.max = std::max( bucket.max, value );
+		bucket.sum += value;
+		++bucket.count;
+		return;
+	}
+
+	Bucket& bucket = ring[ next ];
+	bucket.start = start;
+	bucket.min = bucket.max = bucket.sum = value;
+	bucket.count = 1;
+	next = ( next + 1 ) % ring.size();
+	if ( size < ring.size() ) {
+		++size;
+	}
+}
+
+// the coarsest rollup no coarser than the period that goes back span
+SampleCache::Rollup* SampleCache::findRollup( Series* series, double period,
+														PWR_Time span )
+{
+	PWR_Time end = series->newest().taken;
+	for ( int i = series->rollups.size() - 1; i >= 0; i-- ) {
+		Rollup& rollup = series->rollups[i];
+		if ( (double) rollup.resolution > period * 1000000000 || 
+										0 == rollup.size ) {
+			continue;
+		}
+		if ( span <= end && end - span >= rollup.at( 0 ).start ) {
+			return &rollup;
+		}
+	}
+	return NULL;
+}
+
+bool SampleCache::get( PWR_Obj obj, unsigned count, PWR_AttrName attrs[],
+							uint64_t value[], PWR_Time ts[] )
+{
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.find( obj );
+	if ( iter == m_objs.end() ) {
+		return false;
+	}
+
+	pthread_mutex_lock( &m_lock );
+	for ( unsigned i = 0; i < count; i++ ) {
+		Series* series = iter->second.find( attrs[i] );
+		if ( NULL == series || 0 == series->size ) {
+			pthread_mutex_unlock( &m_lock );
+			return false;
+		}
+		value[i] = series->newest().value;
+		ts[i] = series->newest().ts;
+	}
+	pthread_mutex_unlock( &m_lock );
+	return true;
+}
+
+bool SampleCache::getSamples( PWR_Obj obj, PWR_AttrName attr, 
+			PWR_Time* start, double period, unsigned count, uint64_t buf[] )
+{
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.find( obj );
+	if ( iter == m_objs.end() || 0 == count ) {
+		return false;
+	}
+
+	pthread_mutex_lock( &m_lock );
+	Series* series = iter->second.find( attr );
+	if ( NULL == series || 0 == series->size ) {
+		pthread_mutex_unlock( &m_lock );
+		return false;
+	}
+
+	PWR_Time end = series->newest().taken;
+	PWR_Time span = (PWR_Time) ( ( count - 1 ) * period * 1000000000 );
+	Rollup* rollup = findRollup( series, period, span );
+	if ( rollup ) {
+		*start = end - span;
+
+		// the average of the bucket each time falls in
+		unsigned pos = 0;
+		for ( unsigned i = 0; i < count; i++ ) {
+			PWR_Time when = *start + (PWR_Time) ( i * period * 1000000000 );
+			while ( pos + 1 < rollup->size && 
+								rollup->at( pos + 1 ).start <= when ) {
+				++pos;
+			}
+			const Bucket& bucket = rollup->at( pos );
+			double value = bucket.sum / bucket.count;
+			memcpy( &buf[i], &value, sizeof(value) );
+		}
+		pthread_mutex_unlock( &m_lock );
+		return true;
+	}
+
+	if ( span > end || end - span < series->at( 0 ).taken ) {
+		pthread_mutex_unlock( &m_lock );
+		return false;
+	}
+	*start = end - span;
+
+	// the newest sample taken at or before each time, walking forward
+	unsigned pos = 0;
+	for ( unsigned i = 0; i < count; i++ ) {
+		PWR_Time when = *start + (PWR_Time) ( i * period * 1000000000 );
+		while ( pos + 1 < series->size && series->at( pos + 1 ).taken <= when ) {
+			++pos;
+		}
+		buf[i] = series->at( pos ).value;
+	}
+	pthread_mutex_unlock( &m_lock );
+	return true;
+}
+
+bool SampleCache::getStat( PWR_Obj obj, PWR_AttrName attr, 
+		PWR_AttrStat stat, double period, unsigned count, PWR_Time* start,
+		double* value, PWR_Time* instant )
+{
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.find( obj );
+	if ( iter == m_objs.end() || 0 == count ||
+		( PWR_ATTR_STAT_AVG != stat && PWR_ATTR_STAT_MIN != stat &&
+		  PWR_ATTR_STAT_MAX != stat ) ) {
+		return false;
+	}
+
+	pthread_mutex_lock( &m_lock );
+	Series* series = iter->second.find( attr );
+	if ( NULL == series || 0 == series->size ) {
+		pthread_mutex_unlock( &m_lock );
+		return false;
+	}
+
+	PWR_Time end = series->newest().taken;
+	PWR_Time span = (PWR_Time) ( ( count - 1 ) * period * 1000000000 );
+	Rollup* rollup = findRollup( series, period, span );
+
+	// a window longer than the samples we have can still be answered, 
+	// if not as finely, by the finest rollup that goes back far enough
+	if ( NULL == rollup && ( span > end || 
+							end - span < series->at( 0 ).taken ) ) {
+		for ( unsigned i = 0; i < series->rollups.size(); i++ ) {
+			Rollup& finer = series->rollups[i];
+			if ( finer.size && span <= end && 
+								end - span >= finer.at( 0 ).start ) {
+				rollup = &finer;
+				break;
+			}
+		}
+	}
+	if ( NULL == rollup ) {
+		pthread_mutex_unlock( &m_lock );
+		return false;
+	}
+	*start = end - span;
+
+	// from the bucket the window starts in to the newest
+	unsigned first = 0;
+	while ( first + 1 < rollup->size && 
+						rollup->at( first + 1 ).start <= *start ) {
+		++first;
+	}
+
+	// the instant of a min or max is as close as the bucket it is in
+	double sum = 0;
+	unsigned num = 0;
+	for ( unsigned i = first; i < rollup->size; i++ ) {
+		const Bucket& bucket = rollup->at( i );
+		sum += bucket.sum;
+		num += bucket.count;
+		if ( PWR_ATTR_STAT_MIN == stat && 
+					( i == first || bucket.min < *value ) ) {
+			*value = bucket.min;
+			*instant = std::max( bucket.start, *start );
+		} else if ( PWR_ATTR_STAT_MAX == stat && 
+					( i == first || bucket.max > *value ) ) {
+			*value = bucket.max;
+			*instant = std::max( bucket.start, *start );
+		}
+	}
+	if ( PWR_ATTR_STAT_AVG == stat ) {
+		*value = sum / num;
+		*instant = PWR_TIME_UNINIT;
+	}
+	pthread_mutex_unlock( &m_lock );
+
+	DBGX("stat=%d resolution=%" PRIu64 " buckets=%u value=%f\n", stat,
+			rollup->resolution, rollup->size - first, *value );
+	return true;
+}
+
+bool SampleCache::add( PWR_Obj obj, PWR_AttrName attr, PWR_Time taken,
+										PWR_Time ts, uint64_t value )
+{
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.find( obj );
+	if ( iter == m_objs.end() ) {
+		return false;
+	}
+	Series* series = iter->second.find( attr );
+	if ( NULL == series ) {
+		return false;
+	}
+	pthread_mutex_lock( &m_lock );
+	record( *series, taken, ts, value );
+	pthread_mutex_unlock( &m_lock );
+	return true;
+}
+
+// called with the lock held
+void SampleCache::record( Series& series, PWR_Time taken, PWR_Time ts, 
+														uint64_t value )
+{
+	series.ring[ series.next ].taken = taken;
+	series.ring[ series.next ].ts = ts;
+	series.ring[ series.next ].value = value;
+	series.next = ( series.next + 1 ) % series.ring.size();
+	if ( series.size < series.ring.size() ) {
+		++series.size;
+	}
+
+	if ( m_shm ) {
+		m_shm->write( series.shmIndex, value, ts, taken );
+	}
+
+	double sample;
+	memcpy( &sample, &value, sizeof(sample) );
+	for ( unsigned j = 0; j < series.rollups.size(); j++ ) {
+		series.rollups[j].add( taken, sample );
+	}
+}
+
+void SampleCache::sample()
+{
+	std::map<PWR_Obj,ObjSamples>::iterator iter = m_objs.begin();
+	for ( ; iter != m_objs.end(); ++iter ) {
+		ObjSamples& samples = iter->second;
+		std::vector<uint64_t> value( samples.attrs.size() );
+		std::vector<PWR_Time> ts( samples.attrs.size() );
+
+		PWR_Status status;
+		PWR_StatusCreate( m_ctx, &status );
+		PWR_ObjAttrGetValues( iter->first, samples.attrs.size(), 
+				&samples.attrs[0], &value[0], &ts[0], status );
+		PWR_StatusDestroy( status );
+
+		struct timespec now;
+		clock_gettime( CLOCK_REALTIME, &now );
+		PWR_Time taken = (PWR_Time) now.tv_sec * 1000000000 + now.tv_nsec;
+
+		pthread_mutex_lock( &m_lock );
+		for ( unsigned i = 0; i < samples.series.size(); i++ ) {
+			// a failed read leaves the time at 0, keep what we had 
+			if ( 0 == ts[i] ) {
+				continue;
+			}
+			record( samples.series[i], taken, ts[i], value[i] );
+		}
+		pthread_mutex_unlock( &m_lock );
+	}
+}
+
+void* SampleCache::thread( void* arg )
+{
+	static_cast<SampleCache*>(arg)->work();
+	return NULL;
+}
+
+// on an absolute schedule so the period doesn't drift by the time the 
+// reads take, a sweep that overruns skips the periods it missed
+void SampleCache::work()
+{
+	struct timespec next;
+	clock_gettime( CLOCK_MONOTONIC, &next );
+
+	while ( 1 ) {
+		PWR_Time when = (PWR_Time) next.tv_sec * 1000000000 + next.tv_nsec;
+		when += m_period;
+
+		struct timespec now;
+		clock_gettime( CLOCK_MONOTONIC, &now );
+		PWR_Time cur = (PWR_Time) now.tv_sec * 1000000000 + now.tv_nsec;
+		if ( when < cur ) {
+			when = cur + m_period - ( cur - when ) % m_period;
+		}
+
+		next.tv_sec = when / 1000000000;
+		next.tv_nsec = when % 1000000000;
+		while ( EINTR == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, 
+												&next, NULL ) );
+		sample();
+	}
+}
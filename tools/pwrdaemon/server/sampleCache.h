@@ -0,0 +1,143 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_SAMPLE_CACHE_H
+#define _SRVR_SAMPLE_CACHE_H
+
+#include <pthread.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <pwr.h>
+
+#include "shmTable.h"
+
+namespace PWR_Server { 
+
+// Reads the configured attributes of every object in the server's subtree
+// once a period. Gets are answered with the newest sample and its time, 
+// get samples from the history when it covers the window, so the devices
+// are read at the sampling rate however many clients there are.
+//
+// Each series is also rolled up, as the samples arrive, into buckets of 
+// a second, a minute and an hour that keep the min, max, sum and count.
+// A request with a period at least as coarse as a bucket is answered 
+// from the coarsest such rollup, so a long window costs one step per 
+// period and no device reads. The rings are a fixed size, an hour of 
+// seconds, a day of minutes and a month of hours.
+//
+// Given a shm name the newest sample of every series is also written to 
+// a shared memory table, see pwrshm.h, that processes on the node read 
+// without going through the daemon.
+class SampleCache {
+  public:
+	// without start nothing is sampled but what is given to add()
+	SampleCache( PWR_Cntxt, const std::vector<PWR_Obj>& roots, 
+					const std::vector<PWR_AttrName>&, 
+					PWR_Time period, unsigned history,
+					const std::string& shm = "", bool start = true );
+	~SampleCache();
+
+	// a sample as if read at taken, false if we don't sample it
+	bool add( PWR_Obj, PWR_AttrName, PWR_Time taken, PWR_Time ts, 
+										uint64_t value );
+
+	// false if the object has an attribute we don't sample or hasn't 
+	// been sampled yet
+	bool get( PWR_Obj, unsigned count, PWR_AttrName[], 
+						uint64_t value[], PWR_Time ts[] );
+	// count samples period seconds apart ending at the newest, false if 
+	// the history doesn't go back far enough
+	bool getSamples( PWR_Obj, PWR_AttrName, PWR_Time* start, double period,
+						unsigned count, uint64_t buf[] );
+	// the stat over count periods ending at the newest from the min, max,
+	// or sum and count of the rollups, false if the samples should answer
+	// instead, no rollup is as coarse as the period and the samples go 
+	// back far enough, or nothing does
+	bool getStat( PWR_Obj, PWR_AttrName, PWR_AttrStat, double period, 
+				unsigned count, PWR_Time* start, double* value, 
+				PWR_Time* instant );
+
+  private:
+	struct Sample {
+		Sample() : taken( 0 ), ts( 0 ), value( 0 ) {}
+		PWR_Time	taken;	// our clock, devices keep their own
+		PWR_Time	ts;
+		uint64_t	value;
+	};
+
+	struct Bucket {
+		Bucket() : start( 0 ), min( 0 ), max( 0 ), sum( 0 ), count( 0 ) {}
+		PWR_Time	start;
+		double		min;
+		double		max;
+		double		sum;
+		unsigned	count;
+	};
+
+	// a ring, like the samples', of buckets resolution nanoseconds long
+	struct Rollup {
+		Rollup() : resolution( 0 ), next( 0 ), size( 0 ) {}
+		PWR_Time	resolution;
+		std::vector<Bucket>	ring;
+		unsigned	next;
+		unsigned	size;
+		void add( PWR_Time taken, double value );
+		Bucket& newest() { return at( size - 1 ); }
+		Bucket& at( unsigned i ) { 
+			return ring[ ( next + ring.size() - size + i ) % ring.size() ];
+		}
+	};
+
+	// oldest to newest starting at next once the ring has wrapped
+	struct Series {
+		Series() : next( 0 ), size( 0 ), shmIndex( -1 ) {}
+		std::vector<Sample>	ring;
+		unsigned	next;
+		unsigned	size;
+		int			shmIndex;
+		// finest first
+		std::vector<Rollup>	rollups;
+		const Sample& newest() { return at( size - 1 ); }
+		const Sample& at( unsigned i ) { 
+			return ring[ ( next + ring.size() - size + i ) % ring.size() ];
+		}
+	};
+
+	struct ObjSamples {
+		std::vector<PWR_AttrName>	attrs;
+		std::vector<Series>			series;
+		Series* find( PWR_AttrName );
+	};
+
+	void addObjs( PWR_Obj );
+	void createShm( const std::string& );
+	Rollup* findRollup( Series*, double period, PWR_Time span );
+	void record( Series&, PWR_Time taken, PWR_Time ts, uint64_t value );
+	void sample();
+	static void* thread( void* );
+	void work();
+
+	PWR_Cntxt						m_ctx;
+	std::vector<PWR_AttrName>		m_attrs;
+	PWR_Time						m_period;
+	unsigned						m_history;
+	// the objects are found once, only the samples change
+	std::map<PWR_Obj,ObjSamples>	m_objs;
+	pthread_mutex_t					m_lock;
+	pthread_t						m_thread;
+	bool							m_started;
+	ShmTable*						m_shm;
+};
+
+}
+
+#endif
@@ -1,19 +1,27 @@
 #include <stdlib.h>
+#include <strings.h>
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
 #include "server.h"
+#include <tcpEventChannel.h>
 
 #include "../router/routerEvent.h"
 #include "allocEvent.h"
+#include "commReqEvent.h"
 #include "debug.h"
 
 using namespace PWR_Server;
 
 static void initArgs( int argc, char* argv[], Args* args );
 
-Server::Server( int argc, char* argv[] ) 
+Server::Server( int argc, char* argv[] ) :
+	m_ctx( NULL ),
+	m_workers( NULL ),
+	m_cache( NULL ),
+	m_publisher( NULL ),
+	m_numGets( 0 )
 {
 	initArgs( argc, argv, &m_args );
 
@@ -34,9 +42,32 @@ Server::Server( int argc, char* argv[] )
 		setenv( (m_args.name + "POWERAPI_SERVER_PORT").c_str(),
 				m_args.pwrApiServerPort.c_str(), 0 );  
 	}
+}
+
+std::string Server::configFile( int argc, char* argv[] )
+{
+	Args args;
+	initArgs( argc, argv, &args );
+	if ( ! args.pwrApiConfig.empty() ) {
+		return args.pwrApiConfig;
+	}
+	const char* env = getenv( ( args.name + "POWERAPI_CONFIG" ).c_str() );
+	if ( NULL == env ) {
+		env = getenv( "POWERAPI_CONFIG" );
+	}
+	return env ? env : "";
+}
 
-	PWR_CntxtInit( PWR_CNTXT_DEFAULT, PWR_ROLE_ADMIN , m_args.name.c_str(), &m_ctx );
-	assert(m_ctx);
+// what takes the time, the context and its devices, is done here so the 
+// servers of a daemon can start together once they have their arguments
+bool Server::init()
+{
+	if ( PWR_RET_SUCCESS != PWR_CntxtInit( PWR_CNTXT_DEFAULT, PWR_ROLE_ADMIN,
+									m_args.name.c_str(), &m_ctx ) ) {
+		printf("ERROR: server `%s` has no context\n", m_args.name.c_str() );
+		m_ctx = NULL;
+		return false;
+	}
 
 	EventChannel* ctxChan = PWR_CntxtGetEventChannel( m_ctx );
     EventChannel* rtrChan = getEventChannel( "TCP", allocRtrEvent, 
@@ -48,14 +79,64 @@ Server::Server( int argc, char* argv[] )
     	m_chanSelect->addChannel( ctxChan, new CntxtData( ctxChan ) ); 
 	}
     m_chanSelect->addChannel( rtrChan, new RouterData( rtrChan ) );
+
+	// With a context channel our objects can be remote and the blocking 
+	// calls a worker makes would read the channel the loop is reading.
+	if ( m_args.numWorkers && NULL == ctxChan ) {
+		m_workers = new WorkerPool( m_args.numWorkers );
+		EventChannel* workChan = new TcpEventChannel( NULL, 
+									m_workers->fd(), "workers" );
+		m_chanSelect->addChannel( workChan, 
+							new WorkerData( workChan, m_workers ) );
+	}
+
+	// the sampler makes blocking calls too
+	if ( m_args.samplePeriod && ! m_args.sampleAttrs.empty() && 
+														NULL == ctxChan ) {
+		std::vector<PWR_Obj> roots;
+		for ( unsigned i = 0; i < m_args.roots.size(); i++ ) {
+			PWR_Obj root = NULL;
+			PWR_CntxtGetObjByName( m_ctx, m_args.roots[i].c_str(), &root );
+			if ( NULL == root ) {
+				printf("ERROR: server `%s` has no object `%s`\n", 
+						m_args.name.c_str(), m_args.roots[i].c_str() );
+				return false;
+			}
+			roots.push_back( root );
+		}
+		m_cache = new SampleCache( m_ctx, roots, m_args.sampleAttrs, 
+				(PWR_Time) m_args.samplePeriod * 1000000, m_args.sampleHistory,
+				m_args.shm );
+	} else if ( ! m_args.shm.empty() ) {
+		printf("WARNING: shm `%s` needs local objects, samplePeriod and "
+						"sampleAttrs, ignored\n", m_args.shm.c_str() );
+	}
+
+	// and so do the pushes if they aren't from the cache
+	if ( NULL == ctxChan ) {
+		m_publisher = new Publisher( m_cache, m_workers );
+		EventChannel* pubChan = new TcpEventChannel( NULL, 
+									m_publisher->fd(), "publisher" );
+		m_chanSelect->addChannel( pubChan, 
+							new PublisherData( pubChan, m_publisher ) );
+	}
     
+	// one connection for all of our roots, the router sends us what is 
+	// for any of them and the context finds it whichever it is under
 	ServerConnectEvent* ev = new ServerConnectEvent;	
-	ev->name = m_args.pwrApiRoot;
+	ev->name = m_args.roots[0];
+	ev->objects = m_args.roots;
 	rtrChan->sendEvent(ev);
+	return true;
 }
 
 Server::~Server() {
-    PWR_CntxtDestroy( m_ctx );
+	delete m_publisher;
+	delete m_cache;
+	delete m_workers;
+	if ( m_ctx ) {
+    	PWR_CntxtDestroy( m_ctx );
+	}
 }
 
 int Server::work()
@@ -74,6 +155,69 @@ int Server::work()
 	return 0;
 }
 
+// read what the router has sent so far, bounded so we get to work on it 
+bool Server::readEvents( EventChannel* chan )
+{
+	enum { MAX_READ = 64 };
+	unsigned count = 0;
+
+	do {
+		Event* event = chan->getEvent();
+		if ( NULL == event ) {
+			return false;
+		}
+		m_queue.push( event, chan );
+	} while ( ++count < MAX_READ && chan->ready( 0 ) );
+
+	return true;
+}
+
+// most urgent first, a control event that arrives while we are busy 
+// goes ahead of the bulk work that is already queued
+bool Server::processEvents( EventChannel* chan )
+{
+	EventQueue::Item item;
+	while ( m_queue.pop( item ) ) {
+		if ( item.ev->process( this, item.chan ) ) {
+			delete item.ev;
+		}
+		if ( chan->ready( 0 ) && ! readEvents( chan ) ) {
+			return false;
+		}
+	}
+	runGets();
+	return true;
+}
+
+void Server::addGet( PWR_Obj obj, SrvrCommReqEvent* ev )
+{
+	enum { MAX_BATCH = 256 };
+
+	GetBatch*& batch = m_gets[ obj ];
+	if ( NULL == batch ) {
+		batch = new GetBatch( this, obj );
+	}
+	batch->add( ev );
+
+	// don't hold the first ones back forever when they keep coming
+	if ( ++m_numGets == MAX_BATCH ) {
+		runGets();
+	}
+}
+
+void Server::runGets()
+{
+	// the batches can finish, and free themselves, as they are run
+	std::map< PWR_Obj, GetBatch* > gets;
+	gets.swap( m_gets );
+	m_numGets = 0;
+
+	std::map< PWR_Obj, GetBatch* >::iterator iter = gets.begin();
+	for ( ; iter != gets.end(); ++iter ) {
+		iter->second->run();
+	}
+}
+
 void Server::initFini( Event* key, Event* x, EventChannel* y )
 {
 	DBGX("\n");
@@ -104,19 +248,84 @@ void Server::fini( Event* key, Event* payload )
 	m_finiMap.erase(key);
 }
 
+bool Server::subscribe( Event* key, CommSubscribeEvent& sub )
+{
+	assert( m_finiMap.find(key) != m_finiMap.end() );
+	RouterEvent* re = static_cast<RouterEvent*>(m_finiMap[key].first);
+	EventChannel* ec = static_cast<EventChannel*>(m_finiMap[key].second);
+
+	DBGX("op=%d src=%" PRIx64 " id=%" PRIx64 "\n", sub.op, re->src, sub.id );
+	if ( CommEvent::Stop == sub.op ) {
+		if ( m_publisher ) {
+			m_publisher->remove( re->src, sub.id, sub.grpIndex, 
+											sub.memberIndex );
+		}
+		return true;
+	}
+
+	// the router would wait for our pushes forever
+	std::map< CommID, CommInfo >::iterator iter = m_commMap.find( sub.commID );
+	if ( ! m_publisher || iter == m_commMap.end() || 0 == sub.period ) {
+		CommSampleEvent ev;
+		ev.id = sub.id;
+		ev.commID = sub.commID;
+		ev.grpIndex = sub.grpIndex;
+		ev.memberIndex = sub.memberIndex;
+		ev.status = CommEvent::NoSource;
+		RouterEvent rev( re->dest, re->src, &ev );
+		ec->sendEvent( &rev );
+		return false;
+	}
+
+	m_publisher->add( re->dest, re->src, ec, iter->second.objects[0], sub );
+	return true;
+}
 
 #include <getopt.h>
 static void print_usage() {
     printf("Server::%s()\n",__func__);
 }
 
+static void initSampleAttrs( Args* args, std::string list )
+{
+	while ( ! list.empty() ) {
+		size_t pos = list.find_first_of( ',' );
+		std::string name = list.substr( 0, pos );
+		list = std::string::npos == pos ? "" : list.substr( pos + 1 );
+
+		int attr;
+		for ( attr = 0; attr < PWR_NUM_ATTR_NAMES; attr++ ) {
+			if ( 0 == strcasecmp( name.c_str(), 
+					PWR_AttrGetTypeString( (PWR_AttrName) attr ) ) ) {
+				break;
+			}
+		}
+		if ( PWR_NUM_ATTR_NAMES == attr ) {
+			printf("unknown attribute `%s`\n", name.c_str() );
+			exit(-1);
+		}
+		args->sampleAttrs.push_back( (PWR_AttrName) attr );
+	}
+}
+
+static void initRoots( Args* args, std::string list )
+{
+	args->roots.clear();
+	while ( ! list.empty() ) {
+		size_t pos = list.find_first_of( ',' );
+		args->roots.push_back( list.substr( 0, pos ) );
+		list = std::string::npos == pos ? "" : list.substr( pos + 1 );
+	}
+}
+
 static void initArgs( int argc, char* argv[], Args* args )
 {
     int opt = 0;
     int long_index = 0;
     enum { RTR_PORT, RTR_HOST, TOP_OBJ, 
 			PWRAPI_CONFIG, PWRAPI_ROOT,
-			PWRAPI_SERVER, PWRAPI_SERVER_PORT, NAME  };
+			PWRAPI_SERVER, PWRAPI_SERVER_PORT, NAME, WORKERS,
+			SAMPLE_ATTRS, SAMPLE_PERIOD, SAMPLE_HISTORY, SHM };
     static struct option long_options[] = {
         {"name"    			, required_argument, NULL, NAME },
         {"rtrPort"    		, required_argument, NULL, RTR_PORT },
@@ -125,6 +334,11 @@ static void initArgs( int argc, char* argv[], Args* args )
         {"pwrApiRoot"   	, required_argument, NULL, PWRAPI_ROOT },
         {"pwrApiServer" 	, required_argument, NULL, PWRAPI_SERVER },
         {"pwrApiServerPort" , required_argument, NULL, PWRAPI_SERVER_PORT },
+        {"workers"          , required_argument, NULL, WORKERS },
+        {"sampleAttrs"      , required_argument, NULL, SAMPLE_ATTRS },
+        {"samplePeriod"     , required_argument, NULL, SAMPLE_PERIOD },
+        {"sampleHistory"    , required_argument, NULL, SAMPLE_HISTORY },
+        {"shm"              , required_argument, NULL, SHM },
         {0,0,0,0}
     };
 
@@ -145,7 +359,9 @@ static void initArgs( int argc, char* argv[], Args* args )
 			args->pwrApiConfig = optarg;
             break;
           case PWRAPI_ROOT:
+			// one or more, comma separated
 			args->pwrApiRoot = optarg;
+			initRoots( args, optarg );
             break;
           case PWRAPI_SERVER:
 			args->pwrApiServer = optarg;
@@ -153,12 +369,29 @@ static void initArgs( int argc, char* argv[], Args* args )
           case PWRAPI_SERVER_PORT:
 			args->pwrApiServerPort = optarg;
             break;
+          case WORKERS:
+			args->numWorkers = atoi( optarg );
+            break;
+          case SAMPLE_ATTRS:
+			// comma separated, Energy,Power
+			initSampleAttrs( args, optarg );
+            break;
+          case SAMPLE_PERIOD:
+			args->samplePeriod = atoi( optarg );
+            break;
+          case SAMPLE_HISTORY:
+			args->sampleHistory = atoi( optarg );
+            break;
+          case SHM:
+			// a POSIX shm name, /pwrapi.node0, one per server
+			args->shm = optarg;
+            break;
           default: 
 			print_usage();
         }
     }
 
-    if ( args->port.empty() || args->host.empty() ) { 
+    if ( args->port.empty() || args->host.empty() || args->roots.empty() ) { 
         print_usage();
         exit(-1);
     }
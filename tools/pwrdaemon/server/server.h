@@ -7,32 +7,55 @@
 #include <pwr.h>
 #include <eventChannel.h>
 #include <events.h>
+#include <eventQueue.h>
+#include "workerPool.h"
+#include "sampleCache.h"
+#include "publisher.h"
 #include "debug.h"
 
 class EventChannel;
 
 namespace PWR_Server { 
 
+class SrvrCommReqEvent;
+struct GetBatch;
+
 struct CommInfo {
 	std::vector<PWR_Obj> objects;
 };
 
 struct Args {
+	Args() : numWorkers( 4 ), samplePeriod( 0 ), sampleHistory( 600 ) {}
     std::string port;
     std::string host;
 
 	std::string pwrApiConfig;
 	std::string pwrApiRoot;
+	// the objects in pwrApiRoot, a server can host more than one
+	std::vector<std::string> roots;
 	std::string pwrApiServer;
 	std::string pwrApiServerPort;
 	std::string name;
+	// device threads, 0 runs device operations on the server loop
+	unsigned	numWorkers;
+	// milliseconds, 0 reads the devices for every get
+	unsigned	samplePeriod;
+	unsigned	sampleHistory;
+	std::vector<PWR_AttrName> sampleAttrs;
+	// the shared memory table of the newest samples, see pwrshm.h
+	std::string	shm;
 };
 
 class Server : public EventGenerator {
   public:
 
+	// only takes the arguments, init() does the rest
 	Server( int, char* [] );
 	~Server();
+	// the config the arguments, or the environment, give a server
+	static std::string configFile( int, char* [] );
+	// false if the server can't run
+	bool init();
 	int work();
 
 	std::map< CommID, CommInfo > 	m_commMap;
@@ -41,7 +64,30 @@ class Server : public EventGenerator {
 	void initFini( Event* key, Event*, EventChannel* );
 	void freeFini( Event* key );
 
+	// false if the router hung up
+	bool readEvents( EventChannel* );
+	bool processEvents( EventChannel* );
+
+	// gets are held until the events that arrived with them have been
+	// processed, then each object is read once for all of them
+	void addGet( PWR_Obj, SrvrCommReqEvent* );
+	void runGets();
+
+	// NULL if device operations run inline
+	WorkerPool* workers() { return m_workers; }
+	// NULL if we aren't sampling
+	SampleCache* cache() { return m_cache; }
+
+	// start or stop pushing to the router that sent the event key came in
+	bool subscribe( Event* key, CommSubscribeEvent& );
+
   private:
+	WorkerPool*		m_workers;
+	SampleCache*	m_cache;
+	Publisher*		m_publisher;
+	std::map< PWR_Obj, GetBatch* >	m_gets;
+	unsigned		m_numGets;
+	EventQueue		m_queue;
 	ChannelSelect*  m_chanSelect;
 	Args			m_args;
 	std::map<Event*, std::pair<Event*,EventChannel*> > m_finiMap;
@@ -64,18 +110,41 @@ class RouterData : public SelectData {
         SelectData( chan )
     { }
     bool process( Server* gen ) {
-        Event* event = m_chan->getEvent();
-		if ( NULL == event ) {
+		if ( ! gen->readEvents( m_chan ) || ! gen->processEvents( m_chan ) ) {
 			return true;
-		} else { 
-        	if ( event->process( gen, m_chan ) ) { 
-				delete event;	
-			}	
-			return false;
 		}
+		return false;
     }
 };
 
+class WorkerData : public SelectData {
+  public:
+    WorkerData(  EventChannel* chan, WorkerPool* workers ) :
+        SelectData( chan ), m_workers( workers )
+    { }
+
+    bool process( Server* gen ) {
+		m_workers->complete();
+		return false;
+    }
+  private:
+	WorkerPool*	m_workers;
+};
+
+class PublisherData : public SelectData {
+  public:
+    PublisherData(  EventChannel* chan, Publisher* publisher ) :
+        SelectData( chan ), m_publisher( publisher )
+    { }
+
+    bool process( Server* gen ) {
+		m_publisher->run();
+		return false;
+    }
+  private:
+	Publisher*	m_publisher;
+};
+
 class CntxtData : public SelectData {
   public:
     CntxtData(  EventChannel* chan ) :
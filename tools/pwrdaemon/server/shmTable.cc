@@ -0,0 +1,152 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shmTable.h"
+#include "debug.h"
+
+using namespace PWR_Server;
+
+static bool alive( pid_t pid )
+{
+	return pid > 0 && ( 0 == kill( pid, 0 ) || EPERM == errno );
+}
+
+// A table left by a server that died is taken over in place, never
+// unlinked, so a running server's table can't be replaced under it. Of
+// two servers taking over the same table the swap of the pid picks one.
+// A table without a pid is still being created and counts as in use.
+static bool takeOver( int fd, const std::string& name )
+{
+	PWR_ShmHeader header;
+	if ( sizeof(header) != pread( fd, &header, sizeof(header), 0 ) ) {
+		header.pid = 0;
+	}
+	if ( header.pid <= 0 ) {
+		printf("ERROR: shm `%s` is in use\n", name.c_str() );
+		return false;
+	}
+	if ( alive( header.pid ) ) {
+		printf("ERROR: shm `%s` is in use by pid %d\n", name.c_str(), 
+															header.pid );
+		return false;
+	}
+	void* base = mmap( NULL, sizeof(header), PROT_READ | PROT_WRITE, 
+											MAP_SHARED, fd, 0 );
+	if ( MAP_FAILED == base ) {
+		printf("ERROR: shm `%s` %s\n", name.c_str(), strerror(errno) );
+		return false;
+	}
+	PWR_ShmHeader* shared = (PWR_ShmHeader*) base;
+	bool won = __sync_bool_compare_and_swap( &shared->pid, header.pid, 
+															getpid() );
+	if ( won ) {
+		shared->magic = 0;
+	} else {
+		printf("ERROR: shm `%s` is in use by pid %d\n", name.c_str(), 
+															shared->pid );
+	}
+	munmap( base, sizeof(header) );
+	return won;
+}
+
+ShmTable* ShmTable::create( const std::string& name, PWR_Time period,
+										const std::vector<Info>& info )
+{
+	bool created = true;
+	int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+	if ( fd < 0 && EEXIST == errno ) {
+		created = false;
+		fd = shm_open( name.c_str(), O_RDWR, 0 );
+	}
+	if ( fd < 0 ) {
+		printf("ERROR: shm_open `%s` %s\n", name.c_str(), strerror(errno) );
+		return NULL;
+	}
+	if ( ! created && ! takeOver( fd, name ) ) {
+		close( fd );
+		return NULL;
+	}
+
+	// a taken over table isn't shrunk under readers that still map it
+	size_t len = sizeof(PWR_ShmHeader) + info.size() * sizeof(PWR_ShmEntry);
+	struct stat st;
+	if ( ! created && 0 == fstat( fd, &st ) && (size_t) st.st_size > len ) {
+		len = st.st_size;
+	}
+	void* base = MAP_FAILED;
+	if ( 0 == ftruncate( fd, len ) ) {
+		base = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	}
+	close( fd );
+	if ( MAP_FAILED == base ) {
+		printf("ERROR: shm `%s` %s\n", name.c_str(), strerror(errno) );
+		if ( created ) {
+			shm_unlink( name.c_str() );
+		}
+		return NULL;
+	}
+
+	ShmTable* table = new ShmTable( name, base, len );
+	PWR_ShmHeader* header = (PWR_ShmHeader*) base;
+	header->version = PWR_SHM_VERSION;
+	header->numEntries = info.size();
+	header->entrySize = sizeof(PWR_ShmEntry);
+	header->period = period;
+	header->pid = getpid();
+	memset( table->m_entries, 0, info.size() * sizeof(PWR_ShmEntry) );
+	for ( unsigned i = 0; i < info.size(); i++ ) {
+		PWR_ShmEntry& entry = table->m_entries[i];
+		entry.attr = info[i].attr;
+		strncpy( entry.obj, info[i].obj.c_str(), PWR_SHM_NAME_LEN - 1 );
+		if ( info[i].obj.size() >= PWR_SHM_NAME_LEN ) {
+			printf("WARNING: shm `%s` name truncated\n", info[i].obj.c_str());
+		}
+	}
+	__sync_synchronize();
+	header->magic = PWR_SHM_MAGIC;
+
+	DBG("%s entries=%zu\n", name.c_str(), info.size() );
+	return table;
+}
+
+ShmTable::ShmTable( const std::string& name, void* base, size_t len ) :
+	m_name( name ), m_base( base ), m_len( len ), 
+	m_entries( (PWR_ShmEntry*) ( (PWR_ShmHeader*) base + 1 ) ) 
+{
+}
+
+// readers that have it mapped keep the last values
+ShmTable::~ShmTable()
+{
+	munmap( m_base, m_len );
+	shm_unlink( m_name.c_str() );
+}
+
+void ShmTable::write( int index, uint64_t value, PWR_Time ts, PWR_Time taken )
+{
+	PWR_ShmEntry& entry = m_entries[index];
+	entry.seq = entry.seq + 1;
+	__sync_synchronize();
+	entry.value = value;
+	entry.ts = ts;
+	entry.taken = taken;
+	__sync_synchronize();
+	entry.seq = entry.seq + 1;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_SHM_TABLE_H
+#define _SRVR_SHM_TABLE_H
+
+#include <string>
+#include <vector>
+#include <pwrshm.h>
+
+namespace PWR_Server { 
+
+// The writer of a pwrshm.h table, the sampler is the only one, so an
+// entry's sequence count needs no atomic increment.
+class ShmTable {
+  public:
+	struct Info {
+		std::string		obj;
+		PWR_AttrName	attr;
+	};
+
+	// NULL if the segment can't be created
+	static ShmTable* create( const std::string& name, PWR_Time period, 
+										const std::vector<Info>& );
+	~ShmTable();
+
+	void write( int index, uint64_t value, PWR_Time ts, PWR_Time taken );
+
+  private:
+	ShmTable( const std::string& name, void* base, size_t len );
+
+	std::string		m_name;
+	void*			m_base;
+	size_t			m_len;
+	PWR_ShmEntry*	m_entries;
+};
+
+}
+
+#endif
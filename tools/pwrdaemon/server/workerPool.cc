@@ -0,0 +1,126 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "workerPool.h"
+#include "debug.h"
+
+using namespace PWR_Server;
+
+WorkerPool::WorkerPool( unsigned numThreads ) : m_exit( false )
+{
+	pthread_mutex_init( &m_lock, NULL );
+	pthread_cond_init( &m_cond, NULL );
+
+	m_eventFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+	assert( m_eventFd >= 0 );
+
+	m_threads.resize( numThreads );
+	for ( unsigned i = 0; i < m_threads.size(); i++ ) {
+		int rc = pthread_create( &m_threads[i], NULL, worker, this );
+		assert( 0 == rc );
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	pthread_mutex_lock( &m_lock );
+	m_exit = true;
+	pthread_cond_broadcast( &m_cond );
+	pthread_mutex_unlock( &m_lock );
+
+	for ( unsigned i = 0; i < m_threads.size(); i++ ) {
+		pthread_join( m_threads[i], NULL );
+	}
+	pthread_cond_destroy( &m_cond );
+	pthread_mutex_destroy( &m_lock );
+}
+
+void WorkerPool::submit( Job* job )
+{
+	pthread_mutex_lock( &m_lock );
+	std::map< void*, std::deque<Job*> >::iterator iter = 
+										m_busy.find( job->key() );
+	if ( iter != m_busy.end() ) {
+		iter->second.push_back( job );
+	} else {
+		m_busy[ job->key() ];
+		m_ready.push_back( job );
+		pthread_cond_signal( &m_cond );
+	}
+	pthread_mutex_unlock( &m_lock );
+}
+
+void WorkerPool::complete()
+{
+	uint64_t count;
+	ssize_t rc = read( m_eventFd, &count, sizeof(count) );
+	(void) rc;
+
+	std::deque<Job*> done;
+	pthread_mutex_lock( &m_lock );
+	done.swap( m_done );
+	pthread_mutex_unlock( &m_lock );
+
+	DBGX("%lu jobs done\n", done.size() );
+	while ( ! done.empty() ) {
+		done.front()->done();
+		delete done.front();
+		done.pop_front();
+	}
+}
+
+void* WorkerPool::worker( void* arg )
+{
+	static_cast<WorkerPool*>(arg)->work();
+	return NULL;
+}
+
+void WorkerPool::work()
+{
+	pthread_mutex_lock( &m_lock );
+	while ( 1 ) {
+		while ( m_ready.empty() && ! m_exit ) {
+			pthread_cond_wait( &m_cond, &m_lock );
+		}
+		if ( m_exit ) {
+			break;
+		}
+		Job* job = m_ready.front();
+		m_ready.pop_front();
+		pthread_mutex_unlock( &m_lock );
+
+		job->run();
+
+		pthread_mutex_lock( &m_lock );
+		m_done.push_back( job );
+
+		// the next job for this key can go now
+		std::map< void*, std::deque<Job*> >::iterator iter = 
+										m_busy.find( job->key() );
+		if ( iter->second.empty() ) {
+			m_busy.erase( iter );
+		} else {
+			m_ready.push_back( iter->second.front() );
+			iter->second.pop_front();
+			pthread_cond_signal( &m_cond );
+		}
+
+		uint64_t one = 1;
+		ssize_t rc = write( m_eventFd, &one, sizeof(one) );
+		(void) rc;
+	}
+	pthread_mutex_unlock( &m_lock );
+}
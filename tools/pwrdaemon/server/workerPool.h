@@ -0,0 +1,68 @@
+/*
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+#ifndef _SRVR_WORKER_POOL_H
+#define _SRVR_WORKER_POOL_H
+
+#include <pthread.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace PWR_Server { 
+
+// Runs device operations off the server loop so a slow device doesn't
+// hold up the others. Jobs with the same key, the object, run one at a
+// time in the order they were submitted. Finished jobs are handed back
+// to the server loop, which is woken through an eventfd.
+class WorkerPool {
+  public:
+	class Job {
+	  public:
+		Job( void* key ) : m_key( key ) {}
+		virtual ~Job() {}
+		// on a worker thread
+		virtual void run() = 0;
+		// back on the server loop, the job is deleted after
+		virtual void done() = 0;
+		void* key() { return m_key; }
+	  private:
+		void*	m_key;
+	};
+
+	WorkerPool( unsigned numThreads );
+	~WorkerPool();
+
+	// readable when there are finished jobs
+	int fd() { return m_eventFd; }
+	void submit( Job* );
+	// call done() for the finished jobs
+	void complete();
+
+  private:
+	static void* worker( void* );
+	void work();
+
+	pthread_mutex_t		m_lock;
+	pthread_cond_t		m_cond;
+	std::deque<Job*>	m_ready;
+	// keys with a job running, and what is queued behind it
+	std::map< void*, std::deque<Job*> >	m_busy;
+	std::deque<Job*>	m_done;
+	std::vector<pthread_t>	m_threads;
+	int					m_eventFd;
+	bool				m_exit;
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/* 
+ * Copyright 2014-2016 Sandia Corporation. Under the terms of Contract
+ * DE-AC04-94AL85000, there is a non-exclusive license for use of this work 
+ * by or on behalf of the U.S. Government. Export of this program may require
+ * a license from the United States Government.
+ *
+ * This file is part of the Power API Prototype software package. For license
+ * information, see the LICENSE file in the top level directory of the
+ * distribution.
+*/
+
+/* Converts a time series file written by the logger to CSV, optionally
+ * only the samples between two times, in seconds.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <pwr.h>
+#include <tsFile.h>
+
+using namespace PowerAPI;
+
+static void usage( const char* exename )
+{
+	fprintf(stderr,"%s: [-s startSeconds] [-e endSeconds] file\n",exename);
+}
+
+int main( int argc, char* argv[] )
+{
+	PWR_Time start = 0;
+	PWR_Time end = INT64_MAX;
+	int opt;
+
+	while ( ( opt = getopt( argc, argv, "s:e:" ) ) != -1 ) {
+		switch ( opt ) {
+		  case 's':
+			start = (PWR_Time) ( atof( optarg ) * 1000000000 );
+			break;
+		  case 'e':
+			end = (PWR_Time) ( atof( optarg ) * 1000000000 );
+			break;
+		  default:
+			usage( argv[0] );
+			return -1;
+		}
+	}
+	if ( optind != argc - 1 ) {
+		usage( argv[0] );
+		return -1;
+	}
+
+	TsReader reader;
+	if ( ! reader.open( argv[optind] ) ) {
+		fprintf(stderr,"%s: `%s` is not a time series file\n", argv[0],
+											argv[optind] );
+		return -1;
+	}
+
+	printf("time,object,attribute,value\n");
+
+	std::vector<PWR_Time> time;
+	std::vector<double> value;
+	while ( reader.nextBlock() ) {
+		if ( reader.lastTime() < start || reader.firstTime() > end ) {
+			continue;
+		}
+		for ( size_t i = 0; i < reader.numSeries(); i++ ) {
+			reader.read( i, time, value );
+			const char* attr = PWR_AttrGetTypeString( reader.attr( i ) );
+			for ( size_t j = 0; j < time.size(); j++ ) {
+				if ( time[j] < start || time[j] > end ) {
+					continue;
+				}
+				// a gap has no value
+				printf("%" PRId64 ".%09" PRId64 ",%s,%s,", 
+						time[j] / 1000000000, time[j] % 1000000000,
+						reader.object( i ).c_str(), attr );
+				if ( value[j] == value[j] ) {
+					printf("%.17g", value[j] );
+				}
+				printf("\n");
+			}
+		}
+	}
+	return 0;
+}